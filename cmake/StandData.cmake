@@ -0,0 +1,58 @@
+# Turns the stand database into StandData.h, the constexpr tables read through src/core/StandTables.h.
+# Rows: ICAO,stand,latitude,longitude,radius,code,use,schengen (latitude/longitude/radius may be
+# empty, schengen is 0 or 1); other lines are ignored. Commas, quotes and backslashes are not allowed
+# in fields. Rows are sorted so the stands of an airport are contiguous. Re-runs when the CSV changes.
+function(generate_stand_data csv template output)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${csv}")
+    file(STRINGS "${csv}" rows REGEX "^[A-Za-z0-9][A-Za-z0-9][A-Za-z0-9][A-Za-z0-9],")
+    list(SORT rows)
+
+    set(number "^-?[0-9]+(\\.[0-9]+)?$")
+    set(entries "")
+    set(airports "")
+    set(count 0)
+    foreach(row IN LISTS rows)
+        # The quote check comes first, MATCHES sets CMAKE_MATCH_<n>
+        if(row MATCHES "[\"\\\\]" OR NOT row MATCHES "^([^,]*),([^,]*),([^,]*),([^,]*),([^,]*),([^,]*),([^,]*),([^,]*)$")
+            message(FATAL_ERROR "${csv}: malformed stand row '${row}'")
+        endif()
+        set(icao "${CMAKE_MATCH_1}")
+        set(name "${CMAKE_MATCH_2}")
+        set(latitude "${CMAKE_MATCH_3}")
+        set(longitude "${CMAKE_MATCH_4}")
+        set(radius "${CMAKE_MATCH_5}")
+        set(code "${CMAKE_MATCH_6}")
+        set(use "${CMAKE_MATCH_7}")
+        set(schengen "${CMAKE_MATCH_8}")
+        string(TOUPPER "${icao}" icao)
+        string(STRIP "${name}" name)
+
+        set(located false)
+        if(latitude MATCHES "${number}" AND longitude MATCHES "${number}")
+            set(located true)
+        else()
+            set(latitude 0)
+            set(longitude 0)
+        endif()
+        if(NOT radius MATCHES "${number}")
+            set(radius 0)
+        endif()
+        if(schengen STREQUAL "1")
+            set(schengen true)
+        else()
+            set(schengen false)
+        endif()
+
+        string(APPEND entries "\t\t{ packIcao(\"${icao}\"), \"${name}\", ${located}, ${latitude}, ${longitude}, ${radius}, \"${code}\", \"${use}\", ${schengen} },\n")
+        list(APPEND airports "${icao}")
+        math(EXPR count "${count} + 1")
+    endforeach()
+    list(REMOVE_DUPLICATES airports)
+    list(LENGTH airports airportCount)
+
+    set(STAND_DATA_COUNT ${count})
+    set(STAND_DATA_AIRPORTS ${airportCount})
+    set(STAND_DATA_ENTRIES "${entries}")
+    configure_file("${template}" "${output}" @ONLY)
+    message(STATUS "Built-in stands: ${count} at ${airportCount} airports")
+endfunction()
@@ -9,6 +9,7 @@
 
 #include "RampAgent.h"
 #include "version.h"
+#include "core/Trace.h"
 #include "core/TagItem.h"
 #include "core/CompileCommands.h"
 #include "core/TagFunctions.h"
@@ -44,6 +45,11 @@ void __declspec (dllexport) EuroScopePlugInExit()
 
 void RampAgent::Initialize()
 {
+	EventLog::instance().start(getPluginDirectory() + DIR_SEPARATOR + LOG_FILE);
+	EventLog::instance().event("plugin start", RAMPAGENT_VERSION);
+	dns_.setUiThread(std::this_thread::get_id()); // first lookups here leave resolution to the transport
+	api_->setDnsCache(&dns_);
+
 #ifndef DEV
 	std::pair<bool, std::string> updateAvailable = newVersionAvailable();
 	if (updateAvailable.first) {
@@ -54,6 +60,9 @@ void RampAgent::Initialize()
 	try
 	{
 		initialized_ = true;
+		trace::Tracer::instance().setThreadName("EuroScope UI");
+		loadStandCatalogueCache();
+		loadTagSnapshot();
 		RegisterTagItems();
 		RegisterTagActions();
 	}
@@ -71,10 +80,13 @@ std::pair<bool, std::string> rampAgent::RampAgent::newVersionAvailable()
 	cli.set_read_timeout(1, 0);            // 1s
 	cli.set_write_timeout(1, 0);           // 1s
 	cli.set_keep_alive(false);             // don't hold sockets open
+	if (const std::string address = dns_.lookup("api.github.com"); !address.empty()) cli.set_hostname_addr_map({ { "api.github.com", address } });
 	httplib::Headers headers = { {"User-Agent", "EuroscopeRampAgentVersionChecker"} };
 	std::string apiEndpoint = "/repos/AlexisBalzano/EuroscopeRampAgent/releases/latest";
 
+	const auto start = EventLog::now();
 	auto res = cli.Get(apiEndpoint.c_str(), headers);
+	EventLog::instance().record("version check", start, res ? res->status : 0, res ? res->body.size() : 0);
 	if (res && res->status == 200) {
 		try
 		{
@@ -107,166 +119,397 @@ void RampAgent::Shutdown()
 		initialized_ = false;
 	}
 	m_stop = true;
+	network_.cancel(); // in-flight calls fail now instead of at their timeouts, the joins below return promptly
 	if (m_thread.joinable())
 		m_thread.join();
+	if (catalogueThread_.joinable())
+		catalogueThread_.join();
+	sharedOccupancy_.disable(); // another instance takes the lead on its next poll
+	saveTagSnapshot();
 
 	DisplayMessage("Ramp Agent shutdown complete", "Status");
+	EventLog::instance().event("plugin shutdown");
+	EventLog::instance().stop();
 }
 
 void RampAgent::Reset()
 {
 }
 
+std::string RampAgent::getPluginDirectory() const
+{
+	char path[MAX_PATH] = { 0 };
+	GetModuleFileNameA(reinterpret_cast<HINSTANCE>(&__ImageBase), path, MAX_PATH);
+	return std::filesystem::path(path).parent_path().string();
+}
+
+std::string RampAgent::standCataloguePath() const
+{
+	return getPluginDirectory() + DIR_SEPARATOR + STAND_CATALOGUE_CACHE_FILE;
+}
+
+void RampAgent::loadStandCatalogueCache()
+{
+	TRACE_SPAN("load stand cache");
+	CatalogueCache::Catalogues loaded;
+	if (CatalogueCache::read(standCataloguePath(), standNames_, airports_, loaded) == 0) return;
+	std::lock_guard<std::mutex> lock(standCataloguesMutex_);
+	for (auto& [airport, catalogue] : loaded) standCatalogues_.emplace(airport, std::move(catalogue));
+}
+
+void RampAgent::saveStandCatalogueCache()
+{
+	TRACE_SPAN("save stand cache");
+	CatalogueCache::Catalogues snapshot;
+	{
+		std::lock_guard<std::mutex> lock(standCataloguesMutex_);
+		snapshot = standCatalogues_;
+	}
+	std::lock_guard<std::mutex> lock(catalogueCacheFileMutex_);
+	CatalogueCache::write(standCataloguePath(), snapshot, standNames_, airports_);
+}
+
+void RampAgent::loadTagSnapshot()
+{
+	TRACE_SPAN("load tag snapshot");
+	std::chrono::system_clock::time_point saved;
+	auto occupancy = std::make_shared<OccupancyState>();
+	if (!TagSnapshot::read(getPluginDirectory() + DIR_SEPARATOR + TAG_SNAPSHOT_FILE, TAG_SNAPSHOT_MAX_AGE, callsigns_, standNames_, remarks_, tagSnapshot_, *occupancy, saved)) return;
+
+	// The stand menu and local proposals know the unavailable stands before the first poll
+	if (occupancy->received) {
+		occupancy_.publish(occupancy);
+		lastReceived_ = occupancy;
+		savedOccupancy_ = occupancy;
+	}
+
+	// Shown as they were, the first poll then only confirms them
+	{
+		std::lock_guard<std::mutex> lock(tagItemValueMapMutex_);
+		for (const TagSnapshot::Entry& entry : tagSnapshot_) {
+			tagItemValueMap_.put(entry.callsign, { entry.stand, entry.remark, static_cast<COLORREF>(entry.color) }, [&](CallsignId evicted) { capacityEvicted_.push_back(evicted); });
+			annotations_.set(entry.callsign, entry.stand, entry.remark);
+		}
+	}
+	for (const TagSnapshot::Entry& entry : tagSnapshot_) {
+		if (entry.stand != EMPTY_ID) lastStandTagMap_[entry.callsign] = entry.stand;
+	}
+	const auto age = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - saved).count();
+	DisplayMessage("Restored " + std::to_string(tagSnapshot_.size()) + " stand tags from " + std::to_string(age) + "s ago.", "");
+}
+
+void RampAgent::saveTagSnapshot()
+{
+	std::vector<TagSnapshot::Entry> entries;
+	{
+		std::lock_guard<std::mutex> lock(tagItemValueMapMutex_);
+		entries.reserve(tagItemValueMap_.size());
+		tagItemValueMap_.forEach([&](CallsignId callsign, const TagItemInfo& info) {
+			if (info.color == PROPOSAL) return; // local proposals are recomputed, not restored
+			entries.push_back({ callsign, info.stand, info.remark, static_cast<std::uint32_t>(info.color) });
+		});
+	}
+	const auto same = [](const TagSnapshot::Entry& a, const TagSnapshot::Entry& b) {
+		return a.callsign == b.callsign && a.stand == b.stand && a.remark == b.remark && a.color == b.color;
+	};
+	const std::shared_ptr<const OccupancyState> occupancy = lastReceived_ ? lastReceived_ : std::make_shared<const OccupancyState>();
+	const bool sameOccupancy = savedOccupancy_ && occupancy->sameStands(*savedOccupancy_);
+	if (sameOccupancy && std::equal(entries.begin(), entries.end(), tagSnapshot_.begin(), tagSnapshot_.end(), same)) return; // unchanged since last save
+
+	TRACE_SPAN("save tag snapshot");
+	if (TagSnapshot::write(getPluginDirectory() + DIR_SEPARATOR + TAG_SNAPSHOT_FILE, entries, *occupancy, callsigns_, standNames_, remarks_)) {
+		tagSnapshot_ = std::move(entries);
+		savedOccupancy_ = occupancy;
+	}
+}
+
 void RampAgent::DisplayMessage(const std::string& message, const std::string& sender) {
+	EventLog::instance().event("chat", message);
 	DisplayUserMessage("Ramp Agent", sender.c_str(), message.c_str(), true, true, false, false, false);
 }
 
-void rampAgent::RampAgent::queueMessage(const std::string& message)
+void rampAgent::RampAgent::queueMessage(const std::string& message, MessageKey key, MessageSeverity severity)
 {
-	std::lock_guard<std::mutex> lock(messageQueueMutex_);
-	messageQueue_.push_back(message);
+	EventLog::instance().event("message queued", message);
+	messages_.push(severity, key, message);
 }
 
 void RampAgent::runUpdate() {
-	if (!isConnected_) {
+	if (!session_.current()->connected) {
 		return;
 	}
 
+	TRACE_SPAN("runUpdate");
 
 	if (m_thread.joinable()) {
+		TRACE_SPAN("thread join");
+		Watchdog::OpScope op(BlockingOp::Join);
 		m_thread.join();
 	}
+	if (sharedOccupancy_.enabled()) sharedOccupancy_.tryLead(); // UI thread, the Win32 lock is thread-affine
 	m_thread = std::thread(&RampAgent::getAllAssignedStands, this);
+	const bool polled = pollStarted_;
+	pollStarted_ = true;
 
-	{
-		std::lock_guard<std::mutex> lock(messageQueueMutex_);
-		for (const auto& msg : messageQueue_) {
-			DisplayMessage(msg, "");
+	// Latest published server state, pinned for this cycle without copying
+	const std::shared_ptr<const OccupancyState> occupancy = occupancy_.pin();
+	if (occupancy->received) localOccupancy_.reconcile(occupancy->fetched);
+
+	if (!occupancy->received) {
+		if (!polled) return; // no poll result yet, keep the tags restored from the snapshot
+
+		if (printError.exchange(false) && !firstTime.exchange(false)) { // avoid spamming logs
+			DisplayMessage("No assigned stands data received, inbound traffic gets local stand proposals until the server is back.", "");
 		}
-		messageQueue_.clear();
+		// Server stands stay as last received, unassigned inbound traffic gets a local proposal
+		proposeLocalStands();
+		return;
 	}
+	lastReceived_ = occupancy;
 
-	// AssignedStands_ is updated we can use it
-	nlohmann::ordered_json assignedStandsCopy;
-	{
-		std::lock_guard<std::mutex> lock(assignedStandsMutex_);
-		assignedStandsCopy = assignedStands_;
-	}
+	IdMap<StandId>& standTagMap = nextStandTagMap_;
+	standTagMap.clear();
 
-	std::unordered_map<std::string, std::string> lastStandTagMapCopy;
+	// One pass over radar targets instead of a lookup per stand entry
 	{
-		std::lock_guard<std::mutex> lock(lastStandTagMapMutex_);
-		lastStandTagMapCopy = lastStandTagMap_;
+		TRACE_SPAN("radar targets");
+		presentTargets_.clear();
+		for (CRadarTarget target = RadarTargetSelectFirst(); target.IsValid(); target = RadarTargetSelectNext(target)) {
+			const CallsignId callsign = callsigns_.find(Callsign(target.GetCallsign()));
+			if (callsign != NO_ID) presentTargets_[callsign] = 1;
+		}
 	}
 
-	if (assignedStandsCopy.empty()) {
-		if (printError) {
-			printError = false; // avoid spamming logs
-			if (firstTime) {
-				firstTime = false;
-			}
-			else {
-				DisplayMessage("No assigned stands data received to update tags.", "");
-			}
+	// Assigned and occupied stands, display tag item on occupied stands as well
+	TRACE_SPAN("diff");
+	for (const OccupancyState::Assignment& assignment : occupancy->assignments) {
+		if (!presentTargets_.contains(assignment.callsign)) {
+			continue; // Aircraft not found, skip
 		}
-		// Clear All Tag Items
-		for (const auto& [callsign, standName] : lastStandTagMapCopy) {
-			UpdateTagItems(callsign, WHITE, "");
+		const CallsignId callsign = assignment.callsign;
+		standTagMap[callsign] = assignment.stand;
+
+		// Update only if changed or new, applied by the scheduler within the tick budget. A manual
+		// assignment is already displayed.
+		const StandId* last = lastStandTagMap_.find(callsign);
+		const COLORREF color = (assignment.manual || (last != nullptr && *last == assignment.stand)) ? WHITE : YELLOW;
+		if (color == WHITE && !tagUpdates_.queued(callsign)) {
+			auto lock = Watchdog::acquire(tagItemValueMapMutex_);
+			const TagItemInfo* shown = tagItemValueMap_.find(callsign);
+			if (shown != nullptr && shown->stand == assignment.stand && shown->remark == assignment.remark && shown->color == WHITE) continue; // already displayed
 		}
-		std::lock_guard<std::mutex> lock2(lastStandTagMapMutex_);
-		lastStandTagMap_.clear();
-		return;
+		const UpdatePriority priority = groundState_.isOnGround(callsign) ? UpdatePriority::High : UpdatePriority::Low;
+		tagUpdates_.push({ callsign, color, assignment.stand, assignment.remark }, priority);
 	}
 
-	std::unordered_map<std::string, std::string> standTagMap;
+	// Clear tags for aircraft that are no longer assigned
+	lastStandTagMap_.forEach([&](CallsignId callsign, StandId) {
+		if (!standTagMap.contains(callsign)) {
+			tagUpdates_.push({ callsign, WHITE, EMPTY_ID, EMPTY_ID }, UpdatePriority::Low);
+		}
+	});
+
+	if (!proposals_.empty()) reconcileProposals(standTagMap);
 
-	auto& assigned = assignedStandsCopy["assignedStands"];
-	assignedStandsCopy["assignedStands"].insert(
-		assignedStandsCopy["assignedStands"].end(),
-		assignedStandsCopy["occupiedStands"].begin(),
-		assignedStandsCopy["occupiedStands"].end()
-	); // display tag item on occupied stands as well
+	{
+		std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
+		manualAssignedCallsigns_.clear();
 
-	try {
-		for (auto& stand : assigned) {
-			if (!stand.is_object()) continue;
+	}
 
-			// callsign
-			const auto csIt = stand.find("callsign");
-			if (csIt == stand.end() || !csIt->is_string()) continue;
-			const std::string callsign = csIt->get<std::string>();
+	// Swap instead of copy: the previous table becomes next cycle's scratch storage
+	std::swap(lastStandTagMap_, nextStandTagMap_);
+}
 
-			if (aircraftExists(callsign).first == false) {
-				continue; // Aircraft not found, skip
-			}
+void RampAgent::proposeLocalStands()
+{
+	TRACE_SPAN("local proposals");
+	const auto start = EventLog::now();
+
+	// Unassigned inbound traffic by destination, with what the constraints need
+	for (auto& [airport, flights] : inbound_) flights.clear();
+	for (CRadarTarget target = RadarTargetSelectFirst(); target.IsValid(); target = RadarTargetSelectNext(target)) {
+		const CallsignId callsign = callsigns_.find(Callsign(target.GetCallsign()));
+		if (callsign == NO_ID || lastStandTagMap_.contains(callsign) || localOccupancy_.isParked(callsign)) continue;
+		const CFlightPlan flightPlan = target.GetCorrelatedFlightPlan();
+		if (!flightPlan.IsValid()) continue;
+		const double distance = flightPlan.GetDistanceToDestination();
+		if (distance > PROPOSAL_RANGE_NM || (groundState_.isOnGround(callsign) && distance > PROPOSAL_GROUND_RANGE_NM)) continue;
+		const CFlightPlanData data = flightPlan.GetFlightPlanData();
+		const std::string icao = toUpper(data.GetDestination());
+		if (!isFrenchAirport(packIcao(icao))) continue;
+		inbound_[airports_.intern(icao)].push_back({ callsign, aircraftSizeCode(data.GetAircraftFPType(), data.GetAircraftWtc()),
+			airlineOf(target.GetCallsign()), isSchengenAirport(toUpper(data.GetOrigin())), distance });
+	}
 
-			// stand name
-			const auto nameIt = stand.find("name");
-			if (nameIt == stand.end() || !nameIt->is_string()) continue;
-			std::string standName = nameIt->get<std::string>();
-			standTagMap[callsign] = standName;
-
-			{
-				std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
-				if (manualAssignedCallsigns_.find(callsign) != manualAssignedCallsigns_.end()) {
-					standName = manualAssignedCallsigns_[callsign];
-				}
+	proposalScratch_.clear();
+	for (auto& [airport, flights] : inbound_) {
+		if (flights.empty()) continue;
+		std::shared_ptr<const StandCatalogue> catalogue;
+		{
+			auto lock = Watchdog::acquire(standCataloguesMutex_);
+			auto it = standCatalogues_.find(airport);
+			if (it != standCatalogues_.end()) catalogue = it->second;
+		}
+		if (!catalogue) catalogue = builtinStandCatalogue(airports_.str(airport)); // never fetched, no network
+		if (!catalogue) continue;
+
+		// Taken: last server state unless radar saw the occupant leave, and stands radar sees parked on
+		proposalTaken_.clear();
+		if (lastReceived_) {
+			for (const OccupancyState::Unavailable& unavailable : lastReceived_->unavailable) {
+				if (unavailable.occupied && localOccupancy_.hasVacated(unavailable.callsign, airport, unavailable.stand)) continue;
+				proposalTaken_[unavailable.stand] = 1;
 			}
+		}
+		localOccupancy_.forEachOccupied(airport, [&](StandId stand, CallsignId) { proposalTaken_[stand] = 1; });
+		standAllocator_.allocate(catalogue, flights, [&](StandId stand) { return proposalTaken_.contains(stand); }, proposals_, proposalScratch_);
+	}
 
-			standTagMap[callsign] = standName;
+	// Only changes are pushed; proposals never reach the strip annotations (see UpdateTagItems)
+	const StringId remark = remarks_.intern(LOCAL_PROPOSAL_REMARK);
+	nextProposals_.clear();
+	for (const StandAllocator::Proposal& proposal : proposalScratch_) {
+		nextProposals_[proposal.callsign] = proposal.stand;
+		const StandId* shown = proposals_.find(proposal.callsign);
+		if (shown != nullptr && *shown == proposal.stand) continue;
+		const UpdatePriority priority = groundState_.isOnGround(proposal.callsign) ? UpdatePriority::High : UpdatePriority::Low;
+		tagUpdates_.push({ proposal.callsign, PROPOSAL, proposal.stand, remark }, priority);
+	}
+	proposals_.forEach([&](CallsignId callsign, StandId) {
+		if (!nextProposals_.contains(callsign)) tagUpdates_.push({ callsign, WHITE, EMPTY_ID, EMPTY_ID }, UpdatePriority::Low);
+	});
+	std::swap(proposals_, nextProposals_);
+	EventLog::instance().record("local proposals", start, 0, proposals_.size(), "");
+}
 
-			// remark: accept string only; treat null/other as empty
-			std::string remark;
-			if (auto rIt = stand.find("remark"); rIt != stand.end() && rIt->is_string()) {
-				remark = rIt->get<std::string>();
-			}
-			else {
-				remark.clear();
-			}
+void RampAgent::reconcileProposals(const IdMap<StandId>& serverTags)
+{
+	// Server stands were pushed as new assignments already, proposals it didn't confirm are withdrawn
+	std::size_t confirmed = 0, changed = 0, withdrawn = 0;
+	proposals_.forEach([&](CallsignId callsign, StandId stand) {
+		const StandId* server = serverTags.find(callsign);
+		if (server == nullptr) {
+			tagUpdates_.push({ callsign, WHITE, EMPTY_ID, EMPTY_ID }, UpdatePriority::Low);
+			++withdrawn;
+		}
+		else if (*server == stand) ++confirmed;
+		else ++changed;
+	});
+	proposals_.clear();
+	DisplayMessage("Ramp Agent server data received again, local stand proposals: " + std::to_string(confirmed) + " confirmed, " + std::to_string(changed)
+		+ " changed, " + std::to_string(withdrawn) + " withdrawn.", "");
+}
 
-			// Update only if changed or new
-			if (auto it = lastStandTagMap_.find(callsign);
-				it != lastStandTagMap_.end() && it->second == standName) {
-				UpdateTagItems(callsign, WHITE, standName, remark);
-			}
-			else {
-				UpdateTagItems(callsign, YELLOW, standName, remark);
+void RampAgent::applyTagUpdates()
+{
+	if (tagUpdates_.backlog() == 0) return;
+	TRACE_SPAN("tag updates");
+
+	tagUpdates_.run(UPDATE_SLICE_BUDGET, [&](const TagUpdate& update) {
+		// A manual assignment made after the update was queued wins over the queued server value
+		{
+			std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
+			if (const StandId* manual = manualAssignedCallsigns_.find(update.callsign)) {
+				UpdateTagItems(update.callsign, WHITE, *manual, *manual == EMPTY_ID ? EMPTY_ID : update.remark);
+				return;
 			}
 		}
+		UpdateTagItems(update.callsign, update.color, update.stand, update.remark);
+	});
+}
+
+void RampAgent::OnTimer(int Counter) {
+	Watchdog::CallbackScope watch(watchdog_, "OnTimer");
+	if (Counter % SESSION_REFRESH_INTERVAL == 0) refreshSession();
+	if (Counter % 15 == 0) this->runUpdate();
+	messages_.drain([&](const Message& message) {
+		DisplayMessage(message.text, message.severity == MessageSeverity::Error ? "Error" : "");
+	});
+	applyTagUpdates();
+	flushAnnotations();
+	if (Counter % TAG_SNAPSHOT_INTERVAL == 0) saveTagSnapshot();
+	if (Counter % TAG_CACHE_SWEEP_INTERVAL == 0) sweepTagCache();
+}
+
+void rampAgent::RampAgent::OnControllerPositionUpdate(CController Controller)
+{
+	Watchdog::CallbackScope watch(watchdog_, "OnControllerPositionUpdate");
+	// Fires for every controller of the network, only our own position matters
+	if (session_.isOwnCallsign(Controller.GetCallsign())) refreshSession();
+}
+
+void rampAgent::RampAgent::OnRadarTargetPositionUpdate(CRadarTarget RadarTarget)
+{
+	Watchdog::CallbackScope watch(watchdog_, "OnRadarTargetPositionUpdate");
+	const Callsign name(RadarTarget.GetCallsign());
+	const int groundSpeed = RadarTarget.GetGS();
+	CallsignId callsign = callsigns_.find(name);
+	if (callsign == NO_ID) {
+		// Only new targets the plugin has a use for are interned: slow enough to be on the ground
+		// (local occupancy) or inbound to a supported airport (proposals). Overflights are skipped,
+		// the table doesn't grow with them.
+		if (groundSpeed > GROUND_SPEED_THRESHOLD && !isFrenchAirport(packIcao(toUpper(RadarTarget.GetCorrelatedFlightPlan().GetFlightPlanData().GetDestination())))) return;
+		callsign = callsigns_.intern(name);
 	}
-	catch (const std::exception& e) {
-		DisplayMessage("runScopeUpdate: failed to process assigned stands: " + std::string(e.what()), "Error");
-		return;
+	{
+		auto lock = Watchdog::acquire(tagItemValueMapMutex_);
+		tagItemValueMap_.touch(callsign); // still on radar, keep its tag
 	}
+	const GroundTransition transition = groundState_.update(callsign, groundSpeed);
 
-	// Clear tags for aircraft that are no longer assigned
-	for (const auto& [callsign, standName] : lastStandTagMapCopy) {
-		if (standTagMap.find(callsign) == standTagMap.end()) {
-			UpdateTagItems(callsign, WHITE, "");
-		}
+	// Parked or leaving a stand, only slow ground targets need a stand lookup
+	if (groundState_.isOnGround(callsign) || transition == GroundTransition::Airborne) {
+		const CPosition position = RadarTarget.GetPosition().GetPosition();
+		auto lock = Watchdog::acquire(standCataloguesMutex_);
+		localOccupancy_.update(callsign, position.m_Latitude, position.m_Longitude, groundSpeed, groundState_.isOnGround(callsign), standCatalogues_);
 	}
 
-	{
-		std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
-		manualAssignedCallsigns_.clear();
+	if (transition != GroundTransition::Landed) return;
 
-	}
+	// Just reached the ground: apply its pending stand annotation now rather than on the next poll
+	if (!annotations_.isPending(callsign)) return;
+	CFlightPlan flightPlan = RadarTarget.GetCorrelatedFlightPlan();
+	annotations_.flush([&](CallsignId, StandId stand, StringId remark, bool writeStand, bool writeRemark) -> int {
+		return writeAnnotations(flightPlan, stand, remark, writeStand, writeRemark);
+	}, callsign);
+}
 
-	std::lock_guard<std::mutex> lock2(lastStandTagMapMutex_);
-	lastStandTagMap_ = standTagMap;
+void rampAgent::RampAgent::OnFlightPlanDisconnect(CFlightPlan FlightPlan)
+{
+	Watchdog::CallbackScope watch(watchdog_, "OnFlightPlanDisconnect");
+	const CallsignId callsign = callsigns_.find(Callsign(FlightPlan.GetCallsign()));
+	if (callsign == NO_ID) return;
+	{
+		auto lock = Watchdog::acquire(tagItemValueMapMutex_);
+		tagItemValueMap_.erase(callsign);
+	}
+	forgetAircraft(callsign);
 }
 
-void RampAgent::OnTimer(int Counter) {
-	if (Counter % 15 == 0) this->runUpdate();
+void RampAgent::sweepTagCache()
+{
+	TRACE_SPAN("tag cache sweep");
+	std::vector<CallsignId> evicted;
+	{
+		auto lock = Watchdog::acquire(tagItemValueMapMutex_);
+		// Pushed out by a full cache since the last sweep, unless tagged again since
+		evicted.swap(capacityEvicted_);
+		std::erase_if(evicted, [&](CallsignId callsign) { return tagItemValueMap_.find(callsign) != nullptr; });
+		tagItemValueMap_.sweep([&](CallsignId callsign) { evicted.push_back(callsign); });
+	}
+	// Idle for TagCache::IDLE_SWEEPS generations: no radar update, the target is gone
+	for (CallsignId callsign : evicted) forgetAircraft(callsign);
 }
 
-void rampAgent::RampAgent::OnControllerPositionUpdate(CController Controller)
+void RampAgent::forgetAircraft(CallsignId callsign)
 {
-	isConnected_ = isConnected();
-	isController_ = isController();
-#ifdef DEV
-	isController_ = true;
-#endif // DEV
+	annotations_.forget(callsign);
+	groundState_.forget(callsign);
+	localOccupancy_.forget(callsign);
+	proposals_.erase(callsign);
+	std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
+	manualAssignedCallsigns_.erase(callsign);
 }
 
 std::string RampAgent::toUpper(std::string str)
@@ -276,11 +519,11 @@ std::string RampAgent::toUpper(std::string str)
 	return result;
 }
 
-std::pair<bool, CRadarTarget> rampAgent::RampAgent::aircraftExists(const std::string& callsign)
+std::pair<bool, CRadarTarget> rampAgent::RampAgent::aircraftExists(const Callsign& callsign)
 {
 	CRadarTarget target = RadarTargetSelectFirst();
 	while (target.IsValid()) {
-		if (toUpper(target.GetCallsign()) == toUpper(callsign)) {
+		if (Callsign(target.GetCallsign()) == callsign) {
 			return { true, target };
 		}
 		target = RadarTargetSelectNext(target);
@@ -304,55 +547,95 @@ std::vector<std::pair<CRadarTarget, CFlightPlan>> RampAgent::getAllAircraftsAndF
 
 void RampAgent::getAllAssignedStands()
 {
-	nlohmann::ordered_json response;
+	TRACE_SPAN("getAllAssignedStands");
+	if (sharedOccupancy_.enabled() && !sharedOccupancy_.leading() && followSharedOccupancy()) return;
 
-	httplib::SSLClient cli(apiUrl_, 443);
-	cli.set_connection_timeout(0, 700000); // 700ms
-	cli.set_read_timeout(1, 0);            // 1s
-	cli.set_write_timeout(1, 0);           // 1s
-	httplib::Headers headers = { {"User-Agent", "EuroscopeRampAgent"} };
+	nlohmann::ordered_json response;
+	const std::shared_ptr<const Session> session = session_.current();
+	const CancelToken cancel = network_.token();
 
-	auto res = cli.Get("/api/occupancy/?callsign=" + callsign_ , headers);
+	ApiResponse res;
+	{
+		TRACE_SPAN("network request");
+		const auto start = EventLog::now();
+		res = endpoints_.get(*api_, "/api/occupancy/?callsign=" + session->callsign, cancel);
+		EventLog::instance().record("occupancy poll", start, res.status, res.body.size(), session->callsign);
+	}
+	if (cancel.cancelled()) return; // shutdown, disconnect or URL change: keep the last state, no error
 
-	if (res && res->status >= 200 && res->status < 300) {
-		if (!printError) {
-			printError = true; // reset error printing flag on success
-			queueMessage("Successfully reconnected to Ramp Agent server.");
+	if (res.ok()) {
+		if (!printError.exchange(true)) { // reset error printing flag on success
+			queueMessage("Successfully reconnected to Ramp Agent server.", MessageKey::Server);
 		}
 		try {
-			if (!res->body.empty()) response = nlohmann::ordered_json::parse(res->body);
-			std::lock_guard<std::mutex> lock(assignedStandsMutex_);
-			assignedStands_ = response;
+			TRACE_SPAN("parse");
+			const auto start = EventLog::now();
+			if (!res.body.empty()) response = decodePayload(res.contentType, res.body);
+			std::shared_ptr<OccupancyState> next = OccupancyState::fromJson(response, callsigns_, standNames_, remarks_);
+			EventLog::instance().record("occupancy parse", start, 0, res.body.size(), res.contentType);
+			occupancy_.publish(std::move(next));
+			if (sharedOccupancy_.leading() && !sharedOccupancy_.publish(response)) {
+				EventLog::instance().event("shared occupancy", "publish failed", 1);
+			}
 			return;
 		}
 		catch (const std::exception& e) {
-			queueMessage("Failed to parse occupied stands data from Ramp Agent server: " + std::string(e.what()));
-			std::lock_guard<std::mutex> lock(assignedStandsMutex_);
-			assignedStands_ = nlohmann::ordered_json::object();
+			queueMessage("Failed to parse occupied stands data from Ramp Agent server: " + std::string(e.what()), MessageKey::Occupancy, MessageSeverity::Error);
+			occupancy_.publish(std::make_shared<OccupancyState>());
 			return;
 		}
 	}
 	else {
-		if (printError) {
-			printError = false; // avoid spamming logs
-			if (firstTime == false) {
-				queueMessage("Failed to retrieve occupied stands data from Ramp Agent server. HTTP status: " + std::to_string(res ? res->status : 0));
-			}
-			else {
-				firstTime = false;
-			}
+		if (printError.exchange(false) && !firstTime.exchange(false)) { // avoid spamming logs
+			queueMessage("Failed to retrieve occupied stands data from Ramp Agent server. HTTP status: " + std::to_string(res.status), MessageKey::Server, MessageSeverity::Error);
 		}
 	}
 
-	std::lock_guard<std::mutex> lock(assignedStandsMutex_);
-	assignedStands_ = nlohmann::ordered_json::object();
+	occupancy_.publish(std::make_shared<OccupancyState>());
+}
+
+void RampAgent::changeApiUrl(const std::string& newUrl)
+{
+	// Calls to the old endpoints are aborted, so the threads using them finish at once
+	network_.cancel();
+	if (m_thread.joinable()) m_thread.join();
+	if (catalogueThread_.joinable()) catalogueThread_.join();
+	endpoints_.set(newUrl);
+}
+
+bool RampAgent::followSharedOccupancy()
+{
+	TRACE_SPAN("shared occupancy");
+	const auto start = EventLog::now();
+	auto next = std::make_shared<OccupancyState>();
+	bool received = false;
+	std::chrono::system_clock::time_point published;
+	const SharedOccupancy::ReadResult result = sharedOccupancy_.read(sharedVersionSeen_, received, published,
+		[&](StandList list, std::string_view callsign, std::string_view name, std::string_view remark) {
+			next->add(list, callsign, name, remark, callsigns_, standNames_, remarks_);
+		});
+
+	switch (result) {
+	case SharedOccupancy::ReadResult::Read:
+		// Age of the leader's data, so local radar occupancy is reconciled against the right time
+		next->received = received;
+		next->fetched = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>((std::max)(std::chrono::system_clock::now() - published, std::chrono::system_clock::duration::zero()));
+		EventLog::instance().record("shared occupancy", start, 0, next->unavailable.size(), "read");
+		occupancy_.publish(std::move(next));
+		return true;
+	case SharedOccupancy::ReadResult::Unchanged:
+		return true;
+	default:
+		EventLog::instance().event("shared occupancy", result == SharedOccupancy::ReadResult::Stale ? "leader stale, polling" : "no leader data, polling");
+		return false;
+	}
 }
 
-CFlightPlanControllerAssignedData rampAgent::RampAgent::getControllerAssignedData(const std::string callsign)
+CFlightPlanControllerAssignedData rampAgent::RampAgent::getControllerAssignedData(const Callsign& callsign)
 {
 	CFlightPlan fp = FlightPlanSelectFirst();
 	while (fp.IsValid()) {
-		if (toUpper(fp.GetCallsign()) == toUpper(callsign)) {
+		if (Callsign(fp.GetCallsign()) == callsign) {
 			return fp.GetControllerAssignedData();
 		}
 		fp = FlightPlanSelectNext(fp);
@@ -360,83 +643,33 @@ CFlightPlanControllerAssignedData rampAgent::RampAgent::getControllerAssignedDat
 	return CFlightPlanControllerAssignedData();
 }
 
-bool rampAgent::RampAgent::isConnected()
+void rampAgent::RampAgent::refreshSession()
 {
-	bool userIsConnected = this->GetConnectionType() != EuroScopePlugIn::CONNECTION_TYPE_NO;
-	if (!userIsConnected) DisplayMessage("Not connected to network.", "Status");
-	return userIsConnected;
-}
-
-bool rampAgent::RampAgent::isController()
-{
-	bool userIsObserver = std::string_view(this->ControllerMyself().GetCallsign()).ends_with("_OBS") == true || this->ControllerMyself().GetFacility() == 0;
-	callsign_ = std::string(this->ControllerMyself().GetCallsign());
-	return !userIsObserver;
-}
-
-void rampAgent::RampAgent::sortStandList(std::vector<std::string>& standList)
-{
-	std::sort(standList.begin(), standList.end(), [](const std::string& a, const std::string& b) {
-		auto key = [](const std::string& s) {
-			size_t i = 0, n = s.size();
-
-			// Trim leading spaces
-			while (i < n && std::isspace(static_cast<unsigned char>(s[i]))) ++i;
-
-			// Leading number
-			int num = 0;
-			bool hasNum = false;
-			while (i < n && std::isdigit(static_cast<unsigned char>(s[i]))) {
-				hasNum = true;
-				int digit = s[i] - '0';
-				if (num > ((std::numeric_limits<int>::max)() - digit) / 10)
-					num = (std::numeric_limits<int>::max)(); // clamp overflow
-				else
-					num = num * 10 + digit;
-				++i;
-			}
-
-			// Immediate letter suffix (A, B, AB, ...)
-			std::string letters;
-			while (i < n && std::isalpha(static_cast<unsigned char>(s[i]))) {
-				letters.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(s[i]))));
-				++i;
-			}
-
-			// Remainder (case-insensitive)
-			std::string tailUpper;
-			tailUpper.reserve(n - i);
-			for (; i < n; ++i) {
-				unsigned char c = static_cast<unsigned char>(s[i]);
-				tailUpper.push_back(static_cast<char>(std::toupper(c)));
-			}
-
-			// Bare names (no numeric prefix) go to the end
-			return std::tuple<int, std::string, std::string, std::string>(
-				hasNum ? num : (std::numeric_limits<int>::max)(), letters, tailUpper, s
-			);
-			};
-
-		const auto [an, al, ar, as] = key(a);
-		const auto [bn, bl, br, bs] = key(b);
-
-		if (an != bn) return an < bn;
+	const bool connected = this->GetConnectionType() != EuroScopePlugIn::CONNECTION_TYPE_NO;
+	CController myself = this->ControllerMyself();
+	const std::string_view callsign = connected ? std::string_view(myself.GetCallsign()) : std::string_view();
+	const int facility = connected ? myself.GetFacility() : 0;
+	const bool userIsObserver = callsign.ends_with("_OBS") || facility == 0;
+#ifdef DEV
+	const bool controller = connected;
+#else
+	const bool controller = connected && !userIsObserver;
+#endif // DEV
 
-		// If numbers equal, empty suffix (e.g., "2") comes before "2A"
-		if (al != bl) {
-			if (al.empty() != bl.empty()) return al.empty();
-			return al < bl;
-		}
+	std::shared_ptr<const Session> previous = session_.publish(connected, controller, facility, callsign, [&](const std::string& cs) { return generateToken(cs); });
+	if (previous == nullptr) return;
 
-		// Fallback: remainder, then original
-		if (ar != br) return ar < br;
-		return as < bs;
-		});
+	// Reported once per transition
+	if (previous->connected && !connected) {
+		network_.cancel();
+		sharedOccupancy_.resign(); // nothing to poll for others while offline
+		DisplayMessage("Not connected to network.", "Status");
+	}
 }
 
 inline std::string rampAgent::RampAgent::generateToken(const std::string& callsign)
 {
-	std::string s = AUTH_SECRET + callsign_;
+	std::string s = AUTH_SECRET + callsign;
 	unsigned char hash[SHA256_DIGEST_LENGTH];
 	SHA256(reinterpret_cast<const unsigned char*>(s.data()), s.size(), hash);
 	std::ostringstream oss;
@@ -1,10 +1,34 @@
 #pragma once
 #include <Windows.h>
 #include <EuroScopePlugIn.h>
+#include <atomic>
 #include <thread>
 #include <string>
 #include <nlohmann/json.hpp>
 #include <mutex>
+#include "core/Watchdog.h"
+#include "core/StringTable.h"
+#include "core/Callsign.h"
+#include "core/Annotations.h"
+#include "core/GroundState.h"
+#include "core/UpdateScheduler.h"
+#include "core/StandCatalogue.h"
+#include "core/TagCache.h"
+#include "core/LocalOccupancy.h"
+#include "core/StandAllocator.h"
+#include "core/OccupancyState.h"
+#include "core/SharedOccupancy.h"
+#include "core/CatalogueCache.h"
+#include "core/TagSnapshot.h"
+#include "core/WireFormat.h"
+#include "core/SessionState.h"
+#include "core/MessageChannel.h"
+#include "core/EventLog.h"
+#include "core/Cancellation.h"
+#include "core/ApiClient.h"
+#include "core/Http2Client.h"
+#include "core/Endpoints.h"
+#include "StandData.h"
 
 using namespace EuroScopePlugIn;
 
@@ -19,6 +43,24 @@ namespace rampAgent {
 
 	COLORREF WHITE = RGB(255, 255, 255);
 	COLORREF YELLOW = RGB(255, 220, 3);
+	COLORREF PROPOSAL = RGB(130, 200, 255); // local stand proposal, the server is unreachable
+
+	constexpr int GROUND_SPEED_THRESHOLD = 60; // kt, below this the aircraft is considered on ground
+	constexpr std::chrono::microseconds UPDATE_SLICE_BUDGET{ 2000 }; // UI-thread time per OnTimer tick for tag updates
+	constexpr std::chrono::minutes STAND_CATALOGUE_TTL{ 30 }; // stand layouts are static, refetch rarely
+	constexpr const char* STAND_CATALOGUE_CACHE_FILE = "RampAgent_stands.bin"; // in the plugin directory
+	constexpr const char* TAG_SNAPSHOT_FILE = "RampAgent_tags.bin"; // in the plugin directory
+	constexpr const char* LOG_FILE = "RampAgent.log"; // in the plugin directory, rotated to .1 and .2
+	constexpr std::chrono::minutes TAG_SNAPSHOT_MAX_AGE{ 10 }; // older snapshots are not restored
+	constexpr int TAG_SNAPSHOT_INTERVAL = 60; // OnTimer ticks (s) between periodic snapshots
+	constexpr std::size_t MENU_NEAREST_STANDS = 5; // closest free stands listed first in the stand menu
+	constexpr double MENU_ANCHOR_MARGIN_M = 2000.0; // on ground further from the airport's stands: not anchored on its position
+	constexpr int SESSION_REFRESH_INTERVAL = 5; // OnTimer ticks (s) between session checks besides own position updates
+	constexpr std::uint32_t TAG_CACHE_CAPACITY = 4096; // aircraft with a stand/remark tag at once
+	constexpr double PROPOSAL_RANGE_NM = 250.0; // inbound traffic further out gets no local proposal
+	constexpr double PROPOSAL_GROUND_RANGE_NM = 5.0; // on ground further from the destination: departing
+	constexpr const char* LOCAL_PROPOSAL_REMARK = "LOCAL PROPOSAL"; // remark tag of local proposals
+	constexpr int TAG_CACHE_SWEEP_INTERVAL = 30; // OnTimer ticks (s) per tag cache generation, idle entries go after TagCache::IDLE_SWEEPS
 
 	struct Stand {
 		std::string name;
@@ -26,10 +68,17 @@ namespace rampAgent {
 		bool occupied;
 	};
 
+	struct TagUpdate {
+		CallsignId callsign = EMPTY_ID;
+		COLORREF color = WHITE;
+		StandId stand = EMPTY_ID;
+		StringId remark = EMPTY_ID;
+	};
+
 	struct TagItemInfo {
-		std::string standName;
-		std::string remark;
-		COLORREF color;
+		StandId stand = EMPTY_ID;
+		StringId remark = EMPTY_ID;
+		COLORREF color = WHITE;
 	};
 
 
@@ -45,23 +94,26 @@ namespace rampAgent {
 		std::pair<bool, std::string> newVersionAvailable();
 		void Shutdown();
 		void Reset();
+		std::string getPluginDirectory() const;
 
 		// Radar commands
 		void DisplayMessage(const std::string& message, const std::string& sender = "");
-		void queueMessage(const std::string& message);
+		void queueMessage(const std::string& message, MessageKey key = MessageKey::None, MessageSeverity severity = MessageSeverity::Info); // any thread
 
 		// Scope events
 		void OnTimer(int Counter) override;
 		void OnControllerPositionUpdate(CController Controller) override;
+		void OnRadarTargetPositionUpdate(CRadarTarget RadarTarget) override;
+		void OnFlightPlanDisconnect(CFlightPlan FlightPlan) override;
 
 		std::string toUpper(std::string str);
-		std::pair<bool, CRadarTarget> aircraftExists(const std::string& callsign);
+		std::pair<bool, CRadarTarget> aircraftExists(const Callsign& callsign);
 		std::vector<std::pair<CRadarTarget,CFlightPlan>> getAllAircraftsAndFP();
 		void getAllAssignedStands();
-		CFlightPlanControllerAssignedData getControllerAssignedData(const std::string callsign);
-		void changeApiUrl(const std::string& newUrl) { apiUrl_ = newUrl; }
+		CFlightPlanControllerAssignedData getControllerAssignedData(const Callsign& callsign);
+		void changeApiUrl(const std::string& newUrl); // UI thread, comma-separated mirrors allowed, aborts calls to the previous URLs
 		std::string generateToken(const std::string& callsign);
-		void assignStandToAircraft(const std::string& callsign, const std::string& standName, std::string menuIcao);
+		void assignStandToAircraft(CallsignId callsign, StandId stand, AirportId airport);
 
 	public:
 		// Command IDs
@@ -69,43 +121,91 @@ namespace rampAgent {
 
 	private:
 		void runUpdate();
-		bool isConnected();
-		bool isController();
-		void sortStandList(std::vector<std::string>& standList);
+		void applyTagUpdates(); // Apply queued tag updates within UPDATE_SLICE_BUDGET, UI thread only
+		void refreshSession(); // re-evaluate connection/role/callsign, UI thread only
+		std::string standCataloguePath() const;
+		void loadStandCatalogueCache();
+		void saveStandCatalogueCache();
+		std::shared_ptr<const StandCatalogue> fetchStandCatalogue(const std::string& icao, bool background);
+		std::shared_ptr<const StandCatalogue> builtinStandCatalogue(const std::string& icao); // compiled-in layout (data/stands.csv), nullptr if none
+		void loadTagSnapshot();
+		void saveTagSnapshot();
+		void sweepTagCache(); // evict tags of aircraft gone from radar, UI thread only
+		void forgetAircraft(CallsignId callsign); // drop per-aircraft state of a disconnected/lost aircraft, UI thread only
+		bool followSharedOccupancy(); // poll thread, false if this instance must poll the server itself
+		void proposeLocalStands(); // server unreachable: local stand proposals for inbound traffic, UI thread only
+		void reconcileProposals(const IdMap<StandId>& serverTags); // server back: withdraw the proposals it didn't confirm, UI thread only
 
 	private:
 		// Plugin state
 		bool initialized_ = false;
 		bool m_stop;
 		std::thread m_thread;
-		bool isController_ = false;
-		bool isConnected_ = false;
-		bool printError = true;
-		bool firstTime = true;
-		std::unordered_map<std::string, std::string> lastStandTagMap_; // used to determine if new value
-		std::mutex lastStandTagMapMutex_;
-		std::unordered_map<std::string, TagItemInfo> tagItemValueMap_; // maps callsign to stand tag ID
+		SessionState session_;
+		CancelSource network_; // in-flight API calls, cancelled on shutdown, disconnect and URL change
+		std::atomic<bool> printError{ true }; // last server exchange succeeded, errors are reported on the transition
+		std::atomic<bool> firstTime{ true };
+		bool pollStarted_ = false; // an occupancy poll was launched, the next runUpdate sees its result
+		CallsignTable callsigns_;
+		StringTable standNames_;
+		StaticStandIds<BuiltinStandTable> builtinStandIds_{ BUILTIN_STANDS, standNames_ }; // names of the compiled stands, interned once
+		StringTable airports_{ true };
+		StringTable remarks_;
+		IdMap<StandId> lastStandTagMap_; // used to determine if new value, UI thread only
+		IdMap<StandId> nextStandTagMap_; // UI thread scratch tables, reused every cycle
+		IdMap<std::uint8_t> presentTargets_;
+		UpdateScheduler<TagUpdate> tagUpdates_;
+		TagCache<TagItemInfo> tagItemValueMap_{ TAG_CACHE_CAPACITY }; // maps callsign to stand tag info, blank tags are not stored
 		std::mutex tagItemValueMapMutex_;
-		std::string apiUrl_ = RAMPAGENT_API;
-		std::string callsign_;
-		std::vector<std::string> messageQueue_;
-		std::mutex messageQueueMutex_;
-		nlohmann::ordered_json assignedStands_;
-		std::mutex assignedStandsMutex_;
+		std::vector<CallsignId> capacityEvicted_; // LRU victims of tagItemValueMap_, forgotten by the next sweep; under its mutex
+		std::vector<TagSnapshot::Entry> tagSnapshot_; // last saved, UI thread only
+		std::shared_ptr<const OccupancyState> savedOccupancy_; // last saved, UI thread only
+		EndpointSet endpoints_{ RAMPAGENT_API }; // API host and mirrors, calls hedged across them
+		DnsCache dns_; // shared by every API client, outlives api_
+#ifdef RAMPAGENT_HTTP2
+		std::unique_ptr<ApiClient> api_ = std::make_unique<Http2Client>(); // one multiplexed connection for all API calls
+#else
+		std::unique_ptr<ApiClient> api_ = std::make_unique<HttplibClient>();
+#endif
+		MessageChannel messages_; // drained to the chat on every OnTimer tick
+		OccupancyStore occupancy_; // published by the poll thread, pinned by runUpdate and the stand menu
+		SharedOccupancy sharedOccupancy_; // opt-in, one instance per machine polls for all
+		std::uint64_t sharedVersionSeen_ = 0; // last shared snapshot read, poll thread only
 		std::vector<std::string> menuButtons_;
-		std::unordered_map<std::string, std::string> manualAssignedCallsigns_;
+		IdMap<std::uint8_t> unavailableStands_; // updateStandMenuButtons scratch
+		std::unordered_map<AirportId, std::shared_ptr<const StandCatalogue>> standCatalogues_;
+		std::mutex standCataloguesMutex_;
+		std::thread catalogueThread_; // background refresh of a stale stand catalogue
+		std::atomic<bool> catalogueRefreshing_{ false };
+		std::mutex catalogueCacheFileMutex_;
+		LocalOccupancy localOccupancy_; // radar-derived stand occupancy, UI thread only
+		std::shared_ptr<const OccupancyState> lastReceived_; // last server occupancy with data, UI thread only
+		StandAllocator standAllocator_; // offline proposals, UI thread only
+		IdMap<StandId> proposals_; // local proposals shown, UI thread only
+		IdMap<StandId> nextProposals_; // proposeLocalStands scratch
+		IdMap<std::uint8_t> proposalTaken_;
+		std::unordered_map<AirportId, std::vector<InboundFlight>> inbound_;
+		std::vector<StandAllocator::Proposal> proposalScratch_;
+		IdMap<StandId> manualAssignedCallsigns_;
 		std::mutex manualAssignedCallsignsMutex_;
+		Watchdog watchdog_; // UI-thread stall detection
+		AnnotationSync annotations_;
+		GroundStateTracker groundState_{ GROUND_SPEED_THRESHOLD };
 
 
 		// Tag Items
 		void RegisterTagItems();
 		void RegisterTagActions();
 		bool OnCompileCommand(const char* sCommandLine);
-		void UpdateTagItems(std::string Callsign, COLORREF color = WHITE, std::string standName = "", std::string remark = ""); // Update tag items map
+		void flushAnnotations(); // Write pending flight strip annotations, UI thread only
+		int writeAnnotations(CFlightPlan flightPlan, StandId stand, StringId remark, bool writeStand, bool writeRemark);
+		void UpdateTagItems(CallsignId callsign, COLORREF color = WHITE, StandId stand = EMPTY_ID, StringId remark = EMPTY_ID); // Update tag items map
 		void OnGetTagItem(EuroScopePlugIn::CFlightPlan FlightPlan, EuroScopePlugIn::CRadarTarget RadarTarget, int ItemCode,
 			int TagData, char sItemString[16], int* pColorCode, COLORREF* pRGB, double* pFontSize) override; // Update euroscope Tag items
 		void OnFunctionCall(int functionId, const char* itemString, POINT pt, RECT area) override;
-		void updateStandMenuButtons(const std::string& icao);
+		std::shared_ptr<const StandCatalogue> getStandCatalogue(const std::string& icao);
+		bool getMenuAnchor(const CFlightPlan& flightPlan, const StandCatalogue& catalogue, double& latitude, double& longitude);
+		void updateStandMenuButtons(const std::string& icao, const CFlightPlan& flightPlan);
 
 		// TAG Items IDs
 		enum class TagItemID {
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "core/StringTable.h"
+
+// Flight strip annotation sync.
+// EuroScope propagates every SetFlightStripAnnotation() to the other controllers, so the plugin
+// only records the desired stand/remark per callsign here and writes them once per tick, and
+// only when they differ from what was last written. Writes that can't be applied yet (aircraft
+// still airborne) stay pending until the ground-state tracker reports the landing.
+
+namespace rampAgent {
+
+	class AnnotationSync {
+	public:
+		static constexpr int STAND_SLOT = 3;
+		static constexpr int REMARK_SLOT = 4;
+
+		struct Entry {
+			StandId stand = EMPTY_ID;
+			StringId remark = EMPTY_ID;
+			StandId writtenStand = NO_ID; // NO_ID: never written
+			StringId writtenRemark = NO_ID;
+			bool pending = false;
+		};
+
+		// Records the desired annotations, queueing a write only when they differ from the last written ones
+		void set(CallsignId callsign, StandId stand, StringId remark) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			Entry& entry = entries_[callsign];
+			entry.stand = stand;
+			entry.remark = remark;
+			if (entry.writtenStand == stand && entry.writtenRemark == remark) {
+				++unchanged_;
+				return;
+			}
+			if (!entry.pending) {
+				entry.pending = true;
+				pending_.push_back(callsign);
+			}
+		}
+
+		bool hasPending() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return !pending_.empty();
+		}
+
+		bool isPending(CallsignId callsign) const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			const Entry* entry = entries_.find(callsign);
+			return entry != nullptr && entry->pending;
+		}
+
+		// Applies pending writes in one batch (only the given callsign if set). write(callsign, stand, remark,
+		// writeStand, writeRemark) returns the number of annotations actually set, or a negative value if
+		// the aircraft is not eligible yet, in which case the entry stays pending for the next flush.
+		template <typename WriteFn>
+		std::size_t flush(WriteFn&& write, CallsignId only = NO_ID) {
+			batch_.clear();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				std::size_t kept = 0;
+				for (CallsignId callsign : pending_) {
+					if (only != NO_ID && callsign != only) {
+						pending_[kept++] = callsign;
+						continue;
+					}
+					Entry& entry = entries_[callsign];
+					const bool writeStand = entry.stand != entry.writtenStand;
+					const bool writeRemark = entry.remark != entry.writtenRemark;
+					if (!writeStand && !writeRemark) {
+						entry.pending = false;
+						continue;
+					}
+					batch_.push_back({ callsign, entry.stand, entry.remark, writeStand, writeRemark, -1 });
+				}
+				pending_.resize(kept);
+			}
+			if (batch_.empty()) return 0;
+
+			// EuroScope calls happen outside the lock
+			std::size_t written = 0;
+			for (Work& work : batch_) {
+				work.result = write(work.callsign, work.stand, work.remark, work.writeStand, work.writeRemark);
+				if (work.result > 0) written += static_cast<std::size_t>(work.result);
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (const Work& work : batch_) {
+				Entry& entry = entries_[work.callsign];
+				if (work.result >= 0) {
+					if (work.writeStand) entry.writtenStand = work.stand;
+					if (work.writeRemark) entry.writtenRemark = work.remark;
+				}
+				// Not eligible yet, or changed again while writing
+				if (entry.stand != entry.writtenStand || entry.remark != entry.writtenRemark) {
+					pending_.push_back(work.callsign);
+				}
+				else {
+					entry.pending = false;
+				}
+			}
+			writes_ += written;
+			return written;
+		}
+
+		// Drops all state for a callsign (disconnected), the next set() will write again
+		void forget(CallsignId callsign) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			Entry* entry = entries_.find(callsign);
+			if (entry == nullptr) return;
+			if (entry->pending) {
+				pending_.erase(std::remove(pending_.begin(), pending_.end(), callsign), pending_.end());
+			}
+			entries_.erase(callsign);
+		}
+
+		std::uint64_t writes() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return writes_;
+		}
+
+		std::uint64_t unchanged() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return unchanged_;
+		}
+
+		std::size_t pendingCount() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return pending_.size();
+		}
+
+		double writesPerHour() const {
+			const double hours = std::chrono::duration<double, std::ratio<3600>>(std::chrono::steady_clock::now() - start_).count();
+			return hours > 0.0 ? static_cast<double>(writes()) / hours : 0.0;
+		}
+
+	private:
+		struct Work {
+			CallsignId callsign;
+			StandId stand;
+			StringId remark;
+			bool writeStand;
+			bool writeRemark;
+			int result;
+		};
+
+		mutable std::mutex mutex_;
+		IdMap<Entry> entries_;
+		std::vector<CallsignId> pending_;
+		std::vector<Work> batch_; // flush() runs on the UI thread only
+		std::uint64_t writes_ = 0;
+		std::uint64_t unchanged_ = 0;
+		std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,248 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <httplib.h>
+
+#include "core/Cancellation.h"
+#include "core/DnsCache.h"
+#include "core/WireFormat.h"
+
+// Transport for the RampAgent API.
+// Call sites only see ApiClient::get(), so the HTTP/1.1 client below and the optional multiplexed
+// HTTP/2 client (RAMPAGENT_HTTP2, see Http2Client.h) are interchangeable. Both abort a call as soon
+// as its CancelToken is cancelled.
+
+namespace rampAgent {
+
+	struct ApiResponse {
+		int status = 0; // 0: no response (connection/timeout error)
+		std::string body;
+		std::string contentType;
+
+		bool ok() const { return status >= 200 && status < 300; }
+	};
+
+	class ApiClient {
+	public:
+		virtual ~ApiClient() = default;
+
+		// GET https://host/path, thread-safe. A cancelled call returns status 0.
+		virtual ApiResponse get(const std::string& host, const std::string& path, const CancelToken& cancel = {}) = 0;
+
+		virtual const char* name() const = 0;
+
+		// Resolve hosts through the cache instead of per connection, set before the first request
+		void setDnsCache(DnsCache* dns) { dns_ = dns; }
+
+		std::uint64_t requests() const { return requests_.load(std::memory_order_relaxed); }
+		std::uint64_t connections() const { return connections_.load(std::memory_order_relaxed); } // TCP+TLS connections opened
+		std::uint64_t cancelled() const { return cancelled_.load(std::memory_order_relaxed); } // calls aborted by their token
+
+	protected:
+		static constexpr const char* USER_AGENT = "EuroscopeRampAgent";
+		static constexpr int HTTPS_PORT = 443;
+
+		// "host[:port]" -> (host, port)
+		static std::pair<std::string, int> splitHost(const std::string& host) {
+			const std::size_t colon = host.rfind(':');
+			if (colon == std::string::npos) return { host, HTTPS_PORT };
+			return { host.substr(0, colon), std::atoi(host.c_str() + colon + 1) };
+		}
+
+		// Cached address for host, empty to let the transport resolve it
+		std::string resolve(const std::string& host, const CancelToken& cancel) const { return dns_ != nullptr ? dns_->lookup(host, cancel) : std::string(); }
+
+		DnsCache* dns_ = nullptr;
+		std::atomic<std::uint64_t> requests_{ 0 };
+		std::atomic<std::uint64_t> connections_{ 0 };
+		std::atomic<std::uint64_t> cancelled_{ 0 };
+	};
+
+	// cpp-httplib over a small pool of persistent keep-alive clients. Each pooled client creates its
+	// SSL_CTX and loads the system CA roots (crypt32 on Windows) once, then reuses its TLS connection
+	// across calls, so a poll, menu open or assignment no longer pays for a context, the root store
+	// and a full handshake. Each endpoint (the API host and its mirrors) has its own pool.
+	// Reconnects resume a TLS session of the host: the clients of a host share its latest session
+	// tickets, one is set on each new connection before its ClientHello (httplib has no hook there,
+	// the SSL_CTX info callback at handshake start is used). TLS 1.3 tickets are used once where
+	// there are enough, as RFC 8446 asks, so concurrent reconnects each take their own.
+	// Cancelling shuts the client's socket down: a blocked TLS handshake, send or receive fails at
+	// once. httplib::Client::stop() can't be used for this, it waits on the mutex held across the
+	// connect and handshake. A connect in progress is aborted on POSIX; WinSock ignores shutdown()
+	// on an unconnected socket, so there the connect runs to its 700 ms timeout.
+	class HttplibClient : public ApiClient {
+	public:
+		static constexpr std::size_t MAX_IDLE_CLIENTS = 4; // per host
+		static constexpr std::size_t MAX_POOLED_HOSTS = 8; // beyond that the endpoint list changed, start over
+		static constexpr std::size_t MAX_TLS_SESSIONS = 8; // per host, newest kept
+
+		std::uint64_t resumedSessions() const { return resumed_.load(std::memory_order_relaxed); } // abbreviated handshakes
+
+		// caFile: extra CA bundle, e.g. for a local test server; empty uses the system store
+		explicit HttplibClient(std::string caFile = {}) : caFile_(std::move(caFile)) {}
+
+		// host may carry a port, "host:port"
+		ApiResponse get(const std::string& host, const std::string& path, const CancelToken& cancel = {}) override {
+			if (cancel.cancelled()) return {};
+			Pooled pooled = checkout(host);
+			httplib::Headers headers = { {"User-Agent", USER_AGENT}, {"Accept", API_ACCEPT} };
+
+			++requests_;
+			if (!pooled.client->is_socket_open()) {
+				++connections_; // new connection, or the server dropped the idle one
+				pooled.socket->store(INVALID_SOCKET); // the old descriptor is closed, its number may be reused already
+				const auto [name, port] = splitHost(host);
+				const std::string address = resolve(name, cancel);
+				pooled.client->set_hostname_addr_map(address.empty() ? std::map<std::string, std::string>{} : std::map<std::string, std::string>{ { name, address } });
+			}
+			ApiResponse response;
+			httplib::Result res;
+			{
+				CancelRegistration abort = cancel.onCancel([socket = pooled.socket] { shutdownSocket(socket->load()); });
+				if (!cancel.cancelled()) res = pooled.client->Get(path, headers);
+			}
+			if (cancel.cancelled()) {
+				++cancelled_;
+				return response; // the socket is shut down, drop the client
+			}
+			if (!res) return response; // client dropped with its broken connection
+			response.status = res->status;
+			response.body = std::move(res->body);
+			response.contentType = res->get_header_value("Content-Type");
+			checkin(host, std::move(pooled));
+			return response;
+		}
+
+		const char* name() const override { return "HTTP/1.1"; }
+
+	private:
+		// Latest TLS sessions of a host, shared by its pooled clients, oldest first
+		struct TlsSessions {
+			std::mutex mutex;
+			std::vector<SSL_SESSION*> sessions;
+			std::atomic<std::uint64_t>* resumed = nullptr;
+
+			TlsSessions() = default;
+			TlsSessions(const TlsSessions&) = delete;
+			TlsSessions& operator=(const TlsSessions&) = delete;
+			~TlsSessions() {
+				for (SSL_SESSION* session : sessions) SSL_SESSION_free(session);
+			}
+		};
+
+		struct Pooled {
+			std::shared_ptr<TlsSessions> sessions; // outlives client, whose SSL_CTX points to it
+			std::unique_ptr<httplib::SSLClient> client;
+			std::shared_ptr<std::atomic<socket_t>> socket; // last socket httplib created for client
+		};
+
+		static TlsSessions* sessionsOf(const SSL* ssl) { return static_cast<TlsSessions*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl))); }
+
+		// New session or TLS 1.3 ticket from the server: kept to resume
+		static int onNewSession(SSL* ssl, SSL_SESSION* session) {
+			TlsSessions* sessions = sessionsOf(ssl);
+			std::lock_guard<std::mutex> lock(sessions->mutex);
+			if (sessions->sessions.size() >= MAX_TLS_SESSIONS) {
+				SSL_SESSION_free(sessions->sessions.front());
+				sessions->sessions.erase(sessions->sessions.begin());
+			}
+			sessions->sessions.push_back(session);
+			return 1; // reference taken
+		}
+
+		static void onHandshake(const SSL* ssl, int where, int) {
+			TlsSessions* sessions = sessionsOf(ssl);
+			if ((where & SSL_CB_HANDSHAKE_START) != 0 && SSL_in_before(ssl)) {
+				std::lock_guard<std::mutex> lock(sessions->mutex);
+				while (!sessions->sessions.empty()) {
+					SSL_SESSION* session = sessions->sessions.back();
+					if (SSL_SESSION_is_resumable(session) != 1) {
+						SSL_SESSION_free(session);
+						sessions->sessions.pop_back();
+						continue;
+					}
+					SSL_set_session(const_cast<SSL*>(ssl), session); // takes its own reference
+					// A TLS 1.3 ticket is spent unless it is the last one: reused rather than a full handshake
+					if (SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION && sessions->sessions.size() > 1) {
+						SSL_SESSION_free(session);
+						sessions->sessions.pop_back();
+					}
+					break;
+				}
+			}
+			else if ((where & SSL_CB_HANDSHAKE_DONE) != 0 && SSL_session_reused(ssl)) {
+				sessions->resumed->fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		static void shutdownSocket(socket_t socket) {
+			if (socket == INVALID_SOCKET) return;
+#ifdef _WIN32
+			::shutdown(socket, SD_BOTH);
+#else
+			::shutdown(socket, SHUT_RDWR);
+#endif
+		}
+
+		Pooled checkout(const std::string& host) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				const auto idle = idle_.find(host);
+				if (idle != idle_.end() && !idle->second.empty()) {
+					Pooled pooled = std::move(idle->second.back());
+					idle->second.pop_back();
+					return pooled;
+				}
+			}
+
+			std::shared_ptr<TlsSessions> sessions;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (sessions_.size() >= MAX_POOLED_HOSTS && sessions_.find(host) == sessions_.end()) sessions_.clear();
+				std::shared_ptr<TlsSessions>& shared = sessions_[host];
+				if (!shared) {
+					shared = std::make_shared<TlsSessions>();
+					shared->resumed = &resumed_;
+				}
+				sessions = shared;
+			}
+
+			const auto [name, port] = splitHost(host);
+			Pooled pooled{ std::move(sessions), std::make_unique<httplib::SSLClient>(name, port), std::make_shared<std::atomic<socket_t>>(INVALID_SOCKET) };
+			httplib::SSLClient& cli = *pooled.client;
+			SSL_CTX* context = cli.ssl_context();
+			SSL_CTX_set_app_data(context, pooled.sessions.get());
+			SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+			SSL_CTX_sess_set_new_cb(context, &HttplibClient::onNewSession);
+			SSL_CTX_set_info_callback(context, &HttplibClient::onHandshake);
+			cli.set_connection_timeout(0, 700000); // 700ms
+			cli.set_read_timeout(1, 0);            // 1s
+			cli.set_write_timeout(1, 0);           // 1s
+			cli.set_keep_alive(true);
+			cli.set_socket_options([socket = pooled.socket](socket_t sock) { socket->store(sock); }); // before connect
+			if (!caFile_.empty()) cli.set_ca_cert_path(caFile_);
+			return pooled;
+		}
+
+		void checkin(const std::string& host, Pooled pooled) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (idle_.size() >= MAX_POOLED_HOSTS && idle_.find(host) == idle_.end()) idle_.clear();
+			std::vector<Pooled>& idle = idle_[host];
+			if (idle.size() < MAX_IDLE_CLIENTS) idle.push_back(std::move(pooled));
+		}
+
+		std::string caFile_;
+		std::atomic<std::uint64_t> resumed_{ 0 };
+		std::mutex mutex_;
+		std::map<std::string, std::vector<Pooled>> idle_;
+		std::map<std::string, std::shared_ptr<TlsSessions>> sessions_;
+	};
+
+} // namespace rampAgent
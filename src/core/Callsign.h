@@ -0,0 +1,146 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAMPAGENT_CALLSIGN_SSE2 1
+#endif
+
+#include "core/StringTable.h"
+
+// Fixed-width callsign: upper-cased once on construction, NUL-padded to 16 bytes so equality
+// and hashing are a couple of 128-bit operations instead of toUpper() string copies.
+
+namespace rampAgent {
+
+	struct alignas(16) Callsign {
+		static constexpr std::size_t MAX_LENGTH = 15; // keeps a terminating NUL for c_str()
+
+		Callsign() = default;
+
+		explicit Callsign(std::string_view str) {
+			const std::size_t length = str.size() < MAX_LENGTH ? str.size() : MAX_LENGTH;
+			std::memcpy(bytes_.data(), str.data(), length);
+			upperCase();
+		}
+
+		explicit Callsign(const char* str) : Callsign(str ? std::string_view(str, strnlen(str, MAX_LENGTH)) : std::string_view()) {}
+
+		bool operator==(const Callsign& other) const {
+#ifdef RAMPAGENT_CALLSIGN_SSE2
+			const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes_.data()));
+			const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.bytes_.data()));
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+#else
+			return std::memcmp(bytes_.data(), other.bytes_.data(), bytes_.size()) == 0;
+#endif
+		}
+		bool operator!=(const Callsign& other) const { return !(*this == other); }
+
+		std::size_t hash() const {
+			std::uint64_t lo, hi;
+			std::memcpy(&lo, bytes_.data(), sizeof(lo));
+			std::memcpy(&hi, bytes_.data() + sizeof(lo), sizeof(hi));
+			std::uint64_t h = (lo ^ (hi * 0x9E3779B97F4A7C15ull)) * 0xFF51AFD7ED558CCDull;
+			return static_cast<std::size_t>(h ^ (h >> 32));
+		}
+
+		bool empty() const { return bytes_[0] == '\0'; }
+		std::size_t size() const { return strnlen(bytes_.data(), bytes_.size()); }
+		std::string_view view() const { return std::string_view(bytes_.data(), size()); }
+		const char* c_str() const { return bytes_.data(); }
+
+	private:
+		void upperCase() {
+#ifdef RAMPAGENT_CALLSIGN_SSE2
+			__m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes_.data()));
+			const __m128i isLower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+			v = _mm_sub_epi8(v, _mm_and_si128(isLower, _mm_set1_epi8(0x20)));
+			_mm_store_si128(reinterpret_cast<__m128i*>(bytes_.data()), v);
+#else
+			for (char& c : bytes_) {
+				if (c >= 'a' && c <= 'z') c = static_cast<char>(c - ('a' - 'A'));
+			}
+#endif
+		}
+
+		std::array<char, 16> bytes_{};
+	};
+
+	struct CallsignHash {
+		std::size_t operator()(const Callsign& callsign) const { return callsign.hash(); }
+	};
+
+	// Interning table for callsigns, same id contract as StringTable (EMPTY_ID is the empty callsign)
+	class CallsignTable {
+	public:
+		CallsignTable() {
+			callsigns_.emplace_back();
+			ids_.emplace(callsigns_.front(), EMPTY_ID);
+		}
+
+		CallsignTable(const CallsignTable&) = delete;
+		CallsignTable& operator=(const CallsignTable&) = delete;
+
+		CallsignId intern(const Callsign& callsign) {
+			{
+				std::shared_lock<std::shared_mutex> lock(mutex_);
+				if (auto it = ids_.find(callsign); it != ids_.end()) return it->second;
+			}
+			std::unique_lock<std::shared_mutex> lock(mutex_);
+			if (auto it = ids_.find(callsign); it != ids_.end()) return it->second;
+			const CallsignId id = static_cast<CallsignId>(callsigns_.size());
+			callsigns_.push_back(callsign);
+			ids_.emplace(callsign, id);
+			return id;
+		}
+		CallsignId intern(std::string_view callsign) { return intern(Callsign(callsign)); }
+
+		// NO_ID if the callsign was never interned
+		CallsignId find(const Callsign& callsign) const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			auto it = ids_.find(callsign);
+			return it != ids_.end() ? it->second : NO_ID;
+		}
+
+		Callsign get(CallsignId id) const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return id < callsigns_.size() ? callsigns_[id] : Callsign();
+		}
+
+		// Stored callsigns never move, the returned view/pointer stays valid for the table lifetime
+		std::string_view view(CallsignId id) const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return id < callsigns_.size() ? callsigns_[id].view() : std::string_view();
+		}
+		const char* c_str(CallsignId id) const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return id < callsigns_.size() ? callsigns_[id].c_str() : "";
+		}
+		std::string str(CallsignId id) const { return std::string(view(id)); }
+
+		std::size_t size() const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return callsigns_.size();
+		}
+
+		std::size_t memoryBytes() const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return callsigns_.size() * sizeof(Callsign) + ids_.bucket_count() * sizeof(void*)
+				+ ids_.size() * (sizeof(std::pair<Callsign, CallsignId>) + 2 * sizeof(void*));
+		}
+
+	private:
+		mutable std::shared_mutex mutex_;
+		std::deque<Callsign> callsigns_;
+		std::unordered_map<Callsign, CallsignId, CallsignHash> ids_;
+	};
+
+} // namespace rampAgent
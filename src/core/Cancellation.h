@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Cancellation of in-flight network work.
+// A CancelSource hands out the token of the current generation; cancel() marks it cancelled, runs
+// the callbacks registered on it (shutting a socket down, waking a wait) and starts a new
+// generation for later work. Work checks cancelled() between steps and registers a callback
+// around each blocking call, so shutdown, disconnect and URL changes don't wait for timeouts.
+
+namespace rampAgent {
+
+	class CancelRegistration;
+
+	class CancelToken {
+	public:
+		CancelToken() = default; // never cancelled
+
+		bool cancelled() const { return state_ != nullptr && state_->cancelled.load(std::memory_order_acquire); }
+
+		// fn runs on the cancelling thread, or right away if already cancelled. It must be quick
+		// and must not touch this token's registrations.
+		[[nodiscard]] CancelRegistration onCancel(std::function<void()> fn) const;
+
+	private:
+		friend class CancelSource;
+		friend class CancelRegistration;
+
+		struct State {
+			std::atomic<bool> cancelled{ false };
+			std::mutex mutex; // held while callbacks run, so unregistering waits for a running one
+			std::vector<std::pair<std::uint64_t, std::function<void()>>> callbacks;
+			std::uint64_t nextId = 0;
+		};
+
+		explicit CancelToken(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+		std::shared_ptr<State> state_;
+	};
+
+	// Keeps a callback registered until destroyed; once it returns, the callback won't run anymore
+	class CancelRegistration {
+	public:
+		CancelRegistration() = default;
+		CancelRegistration(CancelRegistration&& other) noexcept : state_(std::move(other.state_)), id_(other.id_) {}
+		CancelRegistration& operator=(CancelRegistration&& other) noexcept {
+			if (this != &other) {
+				reset();
+				state_ = std::move(other.state_);
+				id_ = other.id_;
+			}
+			return *this;
+		}
+		CancelRegistration(const CancelRegistration&) = delete;
+		CancelRegistration& operator=(const CancelRegistration&) = delete;
+		~CancelRegistration() { reset(); }
+
+		void reset() {
+			if (state_ == nullptr) return;
+			std::lock_guard<std::mutex> lock(state_->mutex);
+			auto& callbacks = state_->callbacks;
+			for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+				if (it->first != id_) continue;
+				callbacks.erase(it);
+				break;
+			}
+			state_.reset();
+		}
+
+	private:
+		friend class CancelToken;
+
+		CancelRegistration(std::shared_ptr<CancelToken::State> state, std::uint64_t id) : state_(std::move(state)), id_(id) {}
+
+		std::shared_ptr<CancelToken::State> state_;
+		std::uint64_t id_ = 0;
+	};
+
+	inline CancelRegistration CancelToken::onCancel(std::function<void()> fn) const {
+		if (state_ == nullptr) return {};
+		{
+			std::lock_guard<std::mutex> lock(state_->mutex);
+			if (!state_->cancelled.load(std::memory_order_acquire)) {
+				const std::uint64_t id = ++state_->nextId;
+				state_->callbacks.emplace_back(id, std::move(fn));
+				return CancelRegistration(state_, id);
+			}
+		}
+		fn();
+		return {};
+	}
+
+	class CancelSource {
+	public:
+		CancelSource() : current_(std::make_shared<CancelToken::State>()) {}
+
+		CancelSource(const CancelSource&) = delete;
+		CancelSource& operator=(const CancelSource&) = delete;
+
+		// Any thread: token for work starting now
+		CancelToken token() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return CancelToken(current_);
+		}
+
+		// Any thread: cancels all work holding the current token, returns once its callbacks ran
+		void cancel() {
+			std::shared_ptr<CancelToken::State> cancelled;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				cancelled = std::exchange(current_, std::make_shared<CancelToken::State>());
+			}
+			std::lock_guard<std::mutex> lock(cancelled->mutex);
+			cancelled->cancelled.store(true, std::memory_order_release);
+			for (auto& [id, fn] : cancelled->callbacks) fn();
+			cancelled->callbacks.clear();
+			++cancellations_;
+		}
+
+		std::uint64_t cancellations() const { return cancellations_.load(std::memory_order_relaxed); }
+
+	private:
+		mutable std::mutex mutex_;
+		std::shared_ptr<CancelToken::State> current_;
+		std::atomic<std::uint64_t> cancellations_{ 0 };
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,291 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/StandCatalogue.h"
+#include "core/StringTable.h"
+
+// Disk cache of stand catalogues.
+// Written after every successful stand fetch and mapped at plugin load, so the first stand menu
+// of a session is built without a request or any JSON parsing. The file is versioned and its
+// payload hashed, anything that does not validate is ignored and refetched.
+//
+// Layout (little-endian):
+//   FileHeader
+//   per airport: AirportRecord, StandRecord[standCount], string pool (poolBytes, padded to 8)
+// Stands are stored in natural order, so their position in the file is their sort key.
+
+namespace rampAgent {
+
+	// FNV-1a 64, content hash of the cache files
+	inline std::uint64_t fnv1a64(const std::uint8_t* data, std::size_t size) {
+		std::uint64_t h = 14695981039346656037ull;
+		for (std::size_t i = 0; i < size; ++i) {
+			h ^= data[i];
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// Writes header + payload through a temporary file, so a reader never sees a partial file
+	inline bool replaceFile(const std::string& path, const void* header, std::size_t headerSize, const std::vector<std::uint8_t>& payload) {
+		const std::string tmpPath = path + ".tmp";
+		{
+			std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!out) return false;
+			out.write(static_cast<const char*>(header), static_cast<std::streamsize>(headerSize));
+			out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+			if (!out) return false;
+		}
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, path, ec);
+		if (ec) std::filesystem::remove(tmpPath, ec);
+		return !ec;
+	}
+
+	// Read-only view of a whole file
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() { close(); }
+
+		bool open(const std::string& path) {
+			close();
+#ifdef _WIN32
+			file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE) return false;
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) { close(); return false; }
+			mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_ == nullptr) { close(); return false; }
+			data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+			if (data_ == nullptr) { close(); return false; }
+			size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+			fd_ = ::open(path.c_str(), O_RDONLY);
+			if (fd_ < 0) return false;
+			struct stat st {};
+			if (fstat(fd_, &st) != 0 || st.st_size == 0) { close(); return false; }
+			void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+			if (data == MAP_FAILED) { close(); return false; }
+			data_ = static_cast<const std::uint8_t*>(data);
+			size_ = static_cast<std::size_t>(st.st_size);
+#endif
+			return true;
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (data_ != nullptr) UnmapViewOfFile(data_);
+			if (mapping_ != nullptr) CloseHandle(mapping_);
+			if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+			mapping_ = nullptr;
+			file_ = INVALID_HANDLE_VALUE;
+#else
+			if (data_ != nullptr) munmap(const_cast<std::uint8_t*>(data_), size_);
+			if (fd_ >= 0) ::close(fd_);
+			fd_ = -1;
+#endif
+			data_ = nullptr;
+			size_ = 0;
+		}
+
+		const std::uint8_t* data() const { return data_; }
+		std::size_t size() const { return size_; }
+
+	private:
+#ifdef _WIN32
+		HANDLE file_ = INVALID_HANDLE_VALUE;
+		HANDLE mapping_ = nullptr;
+#else
+		int fd_ = -1;
+#endif
+		const std::uint8_t* data_ = nullptr;
+		std::size_t size_ = 0;
+	};
+
+	class CatalogueCache {
+	public:
+		static constexpr char MAGIC[8] = { 'R', 'A', 'S', 'T', 'C', 'A', 'T', '\0' };
+		static constexpr std::uint32_t VERSION = 1; // bump on any layout change
+
+		using Catalogues = std::unordered_map<AirportId, std::shared_ptr<const StandCatalogue>>;
+
+		// Writes every catalogue to path
+		static bool write(const std::string& path, const Catalogues& catalogues, const StringTable& standNames, const StringTable& airports) {
+			std::vector<std::uint8_t> payload;
+			std::uint32_t airportCount = 0;
+			for (const auto& [airport, catalogue] : catalogues) {
+				if (!catalogue) continue;
+				appendAirport(payload, *catalogue, standNames, airports.view(airport));
+				++airportCount;
+			}
+
+			FileHeader header{};
+			std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+			header.version = VERSION;
+			header.airportCount = airportCount;
+			header.payloadSize = payload.size();
+			header.payloadHash = fnv1a64(payload.data(), payload.size());
+
+			return replaceFile(path, &header, sizeof(header), payload);
+		}
+
+		// Loads every catalogue in the file into out, interning names in the given tables. Returns the
+		// number of airports loaded, 0 if the file is missing, from another version or corrupted.
+		static std::size_t read(const std::string& path, StringTable& standNames, StringTable& airports, Catalogues& out) {
+			MappedFile file;
+			if (!file.open(path) || file.size() < sizeof(FileHeader)) return 0;
+
+			FileHeader header;
+			std::memcpy(&header, file.data(), sizeof(header));
+			if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) return 0;
+			if (header.payloadSize != file.size() - sizeof(FileHeader)) return 0;
+			const std::uint8_t* payload = file.data() + sizeof(FileHeader);
+			if (fnv1a64(payload, header.payloadSize) != header.payloadHash) return 0;
+
+			// Validated: parse into a scratch map first so a malformed record can't leave half an update
+			Catalogues loaded;
+			std::size_t offset = 0;
+			for (std::uint32_t a = 0; a < header.airportCount; ++a) {
+				auto catalogue = readAirport(payload, header.payloadSize, offset, standNames, airports);
+				if (!catalogue) return 0;
+				loaded[catalogue->airport] = std::move(catalogue);
+			}
+			for (auto& [airport, catalogue] : loaded) out[airport] = std::move(catalogue);
+			return loaded.size();
+		}
+
+	private:
+		struct FileHeader {
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t airportCount;
+			std::uint64_t payloadSize;
+			std::uint64_t payloadHash;
+		};
+
+		struct AirportRecord {
+			char icao[8];
+			std::int64_t fetchedUnix; // seconds
+			std::uint32_t standCount;
+			std::uint32_t poolBytes;
+		};
+
+		struct StandRecord {
+			double latitude;
+			double longitude;
+			double radius;
+			std::uint32_t poolOffset; // name, code then use, back to back
+			std::uint16_t nameLength;
+			std::uint16_t codeLength;
+			std::uint16_t useLength;
+			std::uint8_t flags;
+			std::uint8_t reserved;
+		};
+
+		static constexpr std::uint8_t HAS_POSITION = 1;
+		static constexpr std::uint8_t SCHENGEN = 2;
+
+		static_assert(sizeof(FileHeader) == 32 && sizeof(AirportRecord) == 24 && sizeof(StandRecord) == 40, "cache layout changed, bump VERSION");
+
+		template <typename T>
+		static void append(std::vector<std::uint8_t>& buffer, const T& value) {
+			const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		static void appendAirport(std::vector<std::uint8_t>& buffer, const StandCatalogue& catalogue, const StringTable& standNames, std::string_view icao) {
+			std::string pool;
+			std::vector<StandRecord> records;
+			records.reserve(catalogue.stands.size());
+			for (const StandInfo& stand : catalogue.stands) {
+				const std::string_view name = standNames.view(stand.name);
+				StandRecord record{};
+				record.latitude = stand.latitude;
+				record.longitude = stand.longitude;
+				record.radius = stand.radius;
+				record.poolOffset = static_cast<std::uint32_t>(pool.size());
+				record.nameLength = static_cast<std::uint16_t>((std::min)(name.size(), std::size_t{ 0xFFFF }));
+				record.codeLength = static_cast<std::uint16_t>((std::min)(stand.code.size(), std::size_t{ 0xFFFF }));
+				record.useLength = static_cast<std::uint16_t>((std::min)(stand.use.size(), std::size_t{ 0xFFFF }));
+				record.flags = static_cast<std::uint8_t>((stand.hasPosition ? HAS_POSITION : 0) | (stand.schengen ? SCHENGEN : 0));
+				pool.append(name.substr(0, record.nameLength));
+				pool.append(stand.code, 0, record.codeLength);
+				pool.append(stand.use, 0, record.useLength);
+				records.push_back(record);
+			}
+			pool.resize((pool.size() + 7) & ~std::size_t{ 7 }, '\0');
+
+			AirportRecord airport{};
+			std::memcpy(airport.icao, icao.data(), (std::min)(icao.size(), sizeof(airport.icao) - 1));
+			airport.fetchedUnix = std::chrono::duration_cast<std::chrono::seconds>(catalogue.fetched.time_since_epoch()).count();
+			airport.standCount = static_cast<std::uint32_t>(records.size());
+			airport.poolBytes = static_cast<std::uint32_t>(pool.size());
+
+			append(buffer, airport);
+			for (const StandRecord& record : records) append(buffer, record);
+			buffer.insert(buffer.end(), pool.begin(), pool.end());
+		}
+
+		static std::shared_ptr<StandCatalogue> readAirport(const std::uint8_t* payload, std::size_t size, std::size_t& offset, StringTable& standNames, StringTable& airports) {
+			AirportRecord airport;
+			if (size - offset < sizeof(airport)) return nullptr;
+			std::memcpy(&airport, payload + offset, sizeof(airport));
+			offset += sizeof(airport);
+
+			const std::size_t recordsBytes = static_cast<std::size_t>(airport.standCount) * sizeof(StandRecord);
+			if (size - offset < recordsBytes || size - offset - recordsBytes < airport.poolBytes) return nullptr;
+			const std::uint8_t* records = payload + offset;
+			const char* pool = reinterpret_cast<const char*>(records + recordsBytes);
+			offset += recordsBytes + airport.poolBytes;
+
+			auto catalogue = std::make_shared<StandCatalogue>();
+			catalogue->airport = airports.intern(std::string_view(airport.icao, strnlen(airport.icao, sizeof(airport.icao))));
+			catalogue->fetched = std::chrono::system_clock::time_point(std::chrono::seconds(airport.fetchedUnix));
+			catalogue->stands.reserve(airport.standCount);
+			for (std::uint32_t i = 0; i < airport.standCount; ++i) {
+				StandRecord record;
+				std::memcpy(&record, records + i * sizeof(StandRecord), sizeof(record));
+				const std::size_t end = static_cast<std::size_t>(record.poolOffset) + record.nameLength + record.codeLength + record.useLength;
+				if (end > airport.poolBytes) return nullptr;
+
+				StandInfo stand;
+				const char* text = pool + record.poolOffset;
+				stand.name = standNames.intern(std::string_view(text, record.nameLength));
+				stand.code.assign(text + record.nameLength, record.codeLength);
+				stand.use.assign(text + record.nameLength + record.codeLength, record.useLength);
+				stand.latitude = record.latitude;
+				stand.longitude = record.longitude;
+				stand.radius = record.radius;
+				stand.hasPosition = (record.flags & HAS_POSITION) != 0;
+				stand.schengen = (record.flags & SCHENGEN) != 0;
+				catalogue->stands.push_back(std::move(stand));
+			}
+			// Already in natural order, only the index needs building
+			catalogue->index.build(catalogue->stands);
+			return catalogue;
+		}
+	};
+
+} // namespace rampAgent
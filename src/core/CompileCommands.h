@@ -1,6 +1,9 @@
 #pragma once
 #include <algorithm>
 #include <cctype>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <string>
 #include "RampAgent.h"
@@ -9,6 +12,7 @@ namespace rampAgent {
 
 inline bool RampAgent::OnCompileCommand(const char* sCommandLine)
 {
+	Watchdog::CallbackScope watch(watchdog_, "OnCompileCommand");
 	if (sCommandLine == nullptr) return false;
 
 	std::string line(sCommandLine);
@@ -53,22 +57,211 @@ inline bool RampAgent::OnCompileCommand(const char* sCommandLine)
 		iss >> url;
 		if (url.empty())
 		{
-			DisplayMessage("Usage: .ramp url <domain (no https://)>", "");
+			DisplayMessage("Usage: .ramp url <domain (no https://)>[,<mirror>...]", "");
 			return false;
 		}
 		changeApiUrl(url);
-		DisplayMessage("API URL set to " + url, "");
+		DisplayMessage("API URL set to " + endpoints_.hosts(), "");
 		return true;
 	}
 	if (sub == "disconnect")
 	{
-		isConnected_ = false;
-		isController_ = false;
-		callsign_.clear();
+		session_.publish(false, false, 0, "", [](const std::string&) { return std::string(); });
+		network_.cancel();
 		DisplayMessage("Disconnected.");
 		return true;
 	}
-	DisplayMessage("Commands: .rampAgent version / .rampAgent disconnect / .rampAgent url <url>", "");
+	if (sub == "trace")
+	{
+		std::string action;
+		iss >> action;
+		action = toLower(action);
+		trace::Tracer& tracer = trace::Tracer::instance();
+		if (action == "on")
+		{
+			tracer.setEnabled(true);
+			DisplayMessage("Tracing enabled.", "");
+			return true;
+		}
+		if (action == "off")
+		{
+			tracer.setEnabled(false);
+			DisplayMessage("Tracing disabled.", "");
+			return true;
+		}
+		if (action == "dump")
+		{
+			const std::string path = getPluginDirectory() + DIR_SEPARATOR + "RampAgent_trace.json";
+			const std::size_t count = tracer.dump(path);
+			DisplayMessage(count ? "Trace written to " + path + " (" + std::to_string(count) + " events)" : "Failed to write trace to " + path, "");
+			return true;
+		}
+		DisplayMessage("Usage: .rampAgent trace <on|off|dump>", "");
+		return false;
+	}
+	if (sub == "stands")
+	{
+		std::string action;
+		iss >> action;
+		if (toLower(action) != "export")
+		{
+			DisplayMessage("Usage: .rampAgent stands export", "");
+			return false;
+		}
+		// Rows for data/stands.csv, the built-in layouts
+		std::vector<std::pair<std::string, std::shared_ptr<const StandCatalogue>>> catalogues;
+		{
+			std::lock_guard<std::mutex> lock(standCataloguesMutex_);
+			for (const auto& [airport, catalogue] : standCatalogues_) catalogues.emplace_back(airports_.str(airport), catalogue);
+		}
+		std::sort(catalogues.begin(), catalogues.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		const std::string path = getPluginDirectory() + DIR_SEPARATOR + "RampAgent_stands.csv";
+		std::ofstream out(path, std::ios::trunc);
+		std::size_t rows = 0;
+		for (const auto& [icao, catalogue] : catalogues) {
+			catalogue->writeCsv(out, icao, standNames_);
+			rows += catalogue->stands.size();
+		}
+		DisplayMessage(out ? "Exported " + std::to_string(rows) + " stands of " + std::to_string(catalogues.size()) + " airports to " + path : "Failed to write " + path, "");
+		return static_cast<bool>(out);
+	}
+	if (sub == "shared")
+	{
+		std::string action;
+		iss >> action;
+		action = toLower(action);
+		if (action == "on")
+		{
+			if (!sharedOccupancy_.enable())
+			{
+				DisplayMessage("Failed to open the shared occupancy segment, polling the server directly.", "");
+				return false;
+			}
+			DisplayMessage("Shared occupancy enabled, one Ramp Agent instance on this machine polls for all.", "");
+			return true;
+		}
+		if (action == "off")
+		{
+			sharedOccupancy_.disable();
+			DisplayMessage("Shared occupancy disabled.", "");
+			return true;
+		}
+		DisplayMessage("Usage: .rampAgent shared <on|off>", "");
+		return false;
+	}
+	if (sub == "stats")
+	{
+		std::size_t tracked = 0;
+		std::size_t tagBytes = 0;
+		{
+			std::lock_guard<std::mutex> lock(tagItemValueMapMutex_);
+			tracked = tagItemValueMap_.size();
+			tagBytes = tagItemValueMap_.memoryBytes();
+		}
+		tagBytes += lastStandTagMap_.memoryBytes() + nextStandTagMap_.memoryBytes();
+		const std::size_t internBytes = callsigns_.memoryBytes() + standNames_.memoryBytes() + airports_.memoryBytes() + remarks_.memoryBytes();
+		DisplayMessage("Interned: " + std::to_string(callsigns_.size() - 1) + " callsigns, " + std::to_string(standNames_.size() - 1) + " stands, "
+			+ std::to_string(airports_.size() - 1) + " airports, " + std::to_string(remarks_.size() - 1) + " remarks (" + std::to_string(internBytes) + " bytes)", "");
+		DisplayMessage("Tag tables: " + std::to_string(tracked) + " aircraft, " + std::to_string(tagBytes) + " bytes ("
+			+ std::to_string(tracked ? (tagBytes + internBytes) / tracked : 0) + " bytes per aircraft)", "");
+		{
+			std::lock_guard<std::mutex> lock(tagItemValueMapMutex_);
+			DisplayMessage("Tag cache: " + std::to_string(tagItemValueMap_.size()) + "/" + std::to_string(tagItemValueMap_.capacity()) + " entries, "
+				+ std::to_string(tagItemValueMap_.memoryBytes()) + " bytes, generation " + std::to_string(tagItemValueMap_.generation()) + ", "
+				+ std::to_string(tagItemValueMap_.idleEvictions()) + " idle and " + std::to_string(tagItemValueMap_.capacityEvictions()) + " capacity evictions", "");
+		}
+		DisplayMessage("Tag updates: " + std::to_string(tagUpdates_.backlog()) + " queued, " + std::to_string(tagUpdates_.slices()) + " slices, worst slice "
+			+ std::to_string(tagUpdates_.worstSliceUs()) + " us", "");
+		{
+			std::size_t stands = 0, indexBytes = 0, airportCount = 0;
+			{
+				std::lock_guard<std::mutex> lock(standCataloguesMutex_);
+				airportCount = standCatalogues_.size();
+				for (const auto& [airport, catalogue] : standCatalogues_) {
+					stands += catalogue->stands.size();
+					indexBytes += catalogue->index.memoryBytes();
+				}
+			}
+			DisplayMessage("Stand catalogues: " + std::to_string(airportCount) + " airports, " + std::to_string(stands) + " stands, "
+				+ std::to_string(indexBytes) + " index bytes, " + (catalogueRefreshing_ ? "refreshing" : "idle") + "; built-in: " + std::to_string(BUILTIN_STANDS.size())
+				+ " stands at " + std::to_string(BUILTIN_STANDS.airportCount()) + " airports", "");
+		}
+		{
+			const std::shared_ptr<const OccupancyState> occupancy = occupancy_.pin();
+			DisplayMessage("Occupancy: version " + std::to_string(occupancy->version) + (occupancy->received ? "" : " (no data)") + ", "
+				+ std::to_string(occupancy->assignments.size()) + " assignments, " + std::to_string(occupancy->unavailable.size()) + " unavailable stands, "
+				+ std::to_string(occupancy_.editsApplied()) + " manual edits applied", "");
+		}
+		DisplayMessage("Shared occupancy: " + std::string(!sharedOccupancy_.enabled() ? "off" : sharedOccupancy_.leading() ? "leader" : "follower") + ", "
+			+ std::to_string(sharedOccupancy_.publishes()) + " published, " + std::to_string(sharedOccupancy_.reads()) + " read, "
+			+ std::to_string(sharedOccupancy_.fallbacks()) + " own polls, " + std::to_string(sharedOccupancy_.leaderships()) + " times leader", "");
+		{
+			const std::shared_ptr<const Session> session = session_.current();
+			DisplayMessage("Session: " + (session->connected ? session->callsign : std::string("offline")) + (session->controller ? " (controller)" : "") + ", "
+				+ std::to_string(session_.evaluations()) + " evaluations, " + std::to_string(session_.changes()) + " changes", "");
+		}
+		DisplayMessage("API: " + std::string(api_->name()) + ", " + std::to_string(api_->requests()) + " requests over " + std::to_string(api_->connections()) + " connections, " + std::to_string(api_->cancelled()) + " cancelled; DNS " + std::to_string(dns_.hits()) + " hits, "
+			+ std::to_string(dns_.staleHits()) + " stale, " + std::to_string(dns_.misses()) + " misses, " + std::to_string(dns_.failures()) + " resolver failures", "");
+		for (const EndpointSet::Stats& endpoint : endpoints_.stats()) {
+			DisplayMessage("Endpoint " + endpoint.host + ": " + std::to_string(endpoint.calls) + " calls, " + std::to_string(endpoint.failures) + " failed" + (endpoint.failing ? " (failing)" : "") + ", p50 "
+				+ std::to_string(endpoint.p50.count() / 1000) + " ms, p95 " + std::to_string(endpoint.p95.count() / 1000) + " ms over " + std::to_string(endpoint.samples) + " samples", "");
+		}
+		DisplayMessage("Hedged requests: " + std::to_string(endpoints_.hedges()) + " sent, " + std::to_string(endpoints_.hedgeWins()) + " answered first", "");
+		DisplayMessage("Messages: " + std::to_string(messages_.shown()) + " shown, " + std::to_string(messages_.coalesced()) + " coalesced, "
+			+ std::to_string(messages_.suppressed()) + " rate limited, " + std::to_string(messages_.dropped()) + " dropped (queue full)", "");
+		DisplayMessage("Log: " + std::to_string(EventLog::instance().written()) + " records written, " + std::to_string(EventLog::instance().dropped()) + " dropped, "
+			+ std::to_string(EventLog::instance().rotations()) + " rotations (" + EventLog::instance().path() + ")", "");
+		DisplayMessage("Local occupancy: " + std::to_string(localOccupancy_.occupiedCount()) + " stands occupied, " + std::to_string(localOccupancy_.vacatedCount())
+			+ " recently vacated, " + std::to_string(localOccupancy_.updates()) + " changes", "");
+		DisplayMessage("Local proposals: " + std::to_string(proposals_.size()) + " shown, " + std::to_string(standAllocator_.placed()) + " placed, "
+			+ std::to_string(standAllocator_.kept()) + " kept over a cycle, " + std::to_string(standAllocator_.unplaced()) + " without a possible stand", "");
+		DisplayMessage("Annotations: " + std::to_string(annotations_.writes()) + " writes (" + std::to_string(static_cast<long long>(annotations_.writesPerHour()))
+			+ "/h), " + std::to_string(annotations_.unchanged()) + " unchanged skipped, " + std::to_string(annotations_.pendingCount()) + " pending, "
+			+ std::to_string(groundState_.size()) + " aircraft ground-tracked", "");
+		return true;
+	}
+	if (sub == "watchdog")
+	{
+		std::string action;
+		iss >> action;
+		action = toLower(action);
+		if (action == "budget")
+		{
+			double budgetMs = 0.0;
+			if (!(iss >> budgetMs) || budgetMs <= 0.0)
+			{
+				DisplayMessage("Usage: .rampAgent watchdog budget <ms>", "");
+				return false;
+			}
+			watchdog_.setBudgetUs(static_cast<std::uint64_t>(budgetMs * 1000.0));
+			DisplayMessage("Watchdog budget set to " + std::to_string(budgetMs) + " ms", "");
+			return true;
+		}
+		if (action == "clear")
+		{
+			watchdog_.clear();
+			DisplayMessage("Watchdog log cleared.", "");
+			return true;
+		}
+
+		auto toMs = [](std::uint64_t us) {
+			std::ostringstream oss;
+			oss << std::fixed << std::setprecision(1) << static_cast<double>(us) / 1000.0 << " ms";
+			return oss.str();
+		};
+		DisplayMessage("Watchdog: " + std::to_string(watchdog_.callbackCount()) + " callbacks, " + std::to_string(watchdog_.stallCount())
+			+ " over " + toMs(watchdog_.budgetUs()) + ", worst " + toMs(watchdog_.worstUs()), "");
+		for (const auto& stall : watchdog_.recentStalls(10))
+		{
+			const std::time_t when = std::chrono::system_clock::to_time_t(stall.when);
+			std::ostringstream oss;
+			oss << std::put_time(std::localtime(&when), "%H:%M:%S") << " " << stall.callback << " " << toMs(stall.durationUs);
+			if (stall.cause != BlockingOp::None) oss << " (" << blockingOpName(stall.cause) << " " << toMs(stall.causeUs) << ")";
+			DisplayMessage(oss.str(), "");
+		}
+		return true;
+	}
+	DisplayMessage("Commands: .rampAgent version / .rampAgent disconnect / .rampAgent url <url>[,<mirror>...] / .rampAgent trace <on|off|dump> / .rampAgent shared <on|off> / .rampAgent stands export / .rampAgent stats / .rampAgent watchdog [budget <ms>|clear]", "");
 	return true;
 }
 
@@ -0,0 +1,267 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windns.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#endif
+
+#include "core/Cancellation.h"
+#include "core/EventLog.h"
+#include "core/Trace.h"
+
+// Resolver cache for the API hosts.
+// Lookups are answered from memory. Entries are re-resolved in the background shortly before their
+// TTL runs out, and if the resolver fails the last known address keeps being served (up to
+// MAX_STALE) while retries continue. Only the very first lookup of a host waits for the resolver,
+// and never longer than FIRST_LOOKUP_TIMEOUT, after which the caller resolves by itself; on the UI
+// thread it doesn't wait at all. getaddrinfo and DnsQuery_A can't be aborted, so the worker owns
+// only the shared state and is left to finish on its own at destruction, holding a reference on the
+// plugin DLL until it exits.
+
+namespace rampAgent {
+
+	class DnsCache {
+	public:
+		struct Resolution {
+			std::vector<std::string> addresses; // numeric, IPv4
+			std::chrono::milliseconds ttl{ 0 };
+		};
+		using Resolver = std::function<std::optional<Resolution>(const std::string& host)>;
+
+		static constexpr std::chrono::seconds DEFAULT_TTL{ 300 };   // when the resolver reports none
+		static constexpr std::chrono::seconds MIN_TTL{ 30 };
+		static constexpr std::chrono::seconds REFRESH_AHEAD{ 10 };  // re-resolve this long before expiry
+		static constexpr std::chrono::seconds RETRY_DELAY{ 15 };    // after a failed resolution
+		static constexpr std::chrono::hours MAX_STALE{ 1 };         // serve an expired address this long at most
+		static constexpr std::chrono::milliseconds FIRST_LOOKUP_TIMEOUT{ 2000 };
+
+		// The intervals above, shortened by tests
+		struct Timing {
+			std::chrono::milliseconds minTtl = MIN_TTL;
+			std::chrono::milliseconds refreshAhead = REFRESH_AHEAD;
+			std::chrono::milliseconds retryDelay = RETRY_DELAY;
+			std::chrono::milliseconds firstLookupTimeout = FIRST_LOOKUP_TIMEOUT;
+		};
+
+		explicit DnsCache(Resolver resolver = systemResolver) : DnsCache(std::move(resolver), Timing()) {}
+
+		DnsCache(Resolver resolver, Timing timing) : state_(std::make_shared<State>()) {
+			state_->resolver = std::move(resolver);
+			state_->timing = timing;
+			std::thread([state = state_, module = pinModule()]() mutable {
+				run(std::move(state));
+#ifdef _WIN32
+				if (module != nullptr) FreeLibraryAndExitThread(module, 0);
+#endif
+			}).detach();
+		}
+
+		// Doesn't wait for the worker, which may be stuck in the resolver
+		~DnsCache() {
+			{
+				std::lock_guard<std::mutex> lock(state_->mutex);
+				state_->stop = true;
+			}
+			state_->wake.notify_all();
+			state_->resolved.notify_all();
+		}
+
+		DnsCache(const DnsCache&) = delete;
+		DnsCache& operator=(const DnsCache&) = delete;
+
+		// Lookups from this thread never wait for the resolver
+		void setUiThread(std::thread::id thread) {
+			std::lock_guard<std::mutex> lock(state_->mutex);
+			state_->uiThread = thread;
+		}
+
+		// Address to connect to for host, empty if unknown (caller falls back to its own resolution)
+		// or if cancel is cancelled while waiting on the first lookup
+		std::string lookup(const std::string& host, const CancelToken& cancel = {}) {
+			State& state = *state_;
+			const auto now = Clock::now();
+			std::unique_lock<std::mutex> lock(state.mutex);
+			Entry& entry = state.entries[host];
+			entry.lastUsed = now;
+			if (!entry.addresses.empty()) {
+				if (now < entry.expires) ++state.hits;
+				else if (now < entry.expires + MAX_STALE) ++state.staleHits;
+				else {
+					entry.addresses.clear(); // too old to trust
+					entry.nextRefresh = now;
+				}
+			}
+
+			if (entry.addresses.empty()) {
+				++state.misses;
+				entry.failed = false;
+				entry.nextRefresh = now;
+				state.wake.notify_all();
+				if (std::this_thread::get_id() == state.uiThread) return {};
+				lock.unlock();
+				CancelRegistration wakeUp = cancel.onCancel([&state] {
+					std::lock_guard<std::mutex> guard(state.mutex);
+					state.resolved.notify_all();
+				});
+				lock.lock();
+				// Map nodes are stable, entry stays valid while the lock is released
+				state.resolved.wait_for(lock, state.timing.firstLookupTimeout, [&] { return state.stop || !entry.addresses.empty() || entry.failed || cancel.cancelled(); });
+				std::string address = entry.addresses.empty() ? std::string() : entry.addresses.front();
+				lock.unlock(); // before wakeUp unregisters, its callback takes the mutex
+				return address;
+			}
+			return entry.addresses.front();
+		}
+
+		std::uint64_t hits() const { std::lock_guard<std::mutex> lock(state_->mutex); return state_->hits; }
+		std::uint64_t staleHits() const { std::lock_guard<std::mutex> lock(state_->mutex); return state_->staleHits; }
+		std::uint64_t misses() const { std::lock_guard<std::mutex> lock(state_->mutex); return state_->misses; }
+		std::uint64_t failures() const { std::lock_guard<std::mutex> lock(state_->mutex); return state_->failures; }
+
+		// getaddrinfo has no TTL, on Windows the DNS client API provides it
+		static std::optional<Resolution> systemResolver(const std::string& host) {
+			Resolution resolution;
+#ifdef _WIN32
+			PDNS_RECORD records = nullptr;
+			if (DnsQuery_A(host.c_str(), DNS_TYPE_A, DNS_QUERY_STANDARD, nullptr, &records, nullptr) == 0) {
+				DWORD ttl = 0xFFFFFFFF;
+				for (PDNS_RECORD record = records; record != nullptr; record = record->pNext) {
+					if (record->wType != DNS_TYPE_A) continue;
+					IN_ADDR address{};
+					address.S_un.S_addr = record->Data.A.IpAddress;
+					char text[INET_ADDRSTRLEN] = { 0 };
+					if (inet_ntop(AF_INET, &address, text, sizeof(text)) != nullptr) resolution.addresses.push_back(text);
+					ttl = (std::min)(ttl, record->dwTtl);
+				}
+				DnsRecordListFree(records, DnsFreeRecordList);
+				if (!resolution.addresses.empty()) resolution.ttl = std::chrono::seconds(ttl);
+			}
+			if (!resolution.addresses.empty()) return resolution;
+#endif
+			addrinfo hints{};
+			hints.ai_family = AF_INET;
+			hints.ai_socktype = SOCK_STREAM;
+			addrinfo* result = nullptr;
+			if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0) return std::nullopt;
+			for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+				char text[INET_ADDRSTRLEN] = { 0 };
+				const auto* address = reinterpret_cast<const sockaddr_in*>(ai->ai_addr);
+				if (inet_ntop(AF_INET, &address->sin_addr, text, sizeof(text)) != nullptr) resolution.addresses.push_back(text);
+			}
+			freeaddrinfo(result);
+			if (resolution.addresses.empty()) return std::nullopt;
+			return resolution;
+		}
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Entry {
+			std::vector<std::string> addresses;
+			Clock::time_point expires;
+			Clock::time_point nextRefresh;
+			Clock::time_point lastUsed;
+			bool failed = false; // last attempt failed, wakes a waiting first lookup
+		};
+
+		// Shared by the cache and its worker, outlives whichever ends last
+		struct State {
+			Resolver resolver;
+			Timing timing;
+			std::mutex mutex;
+			std::condition_variable wake;     // worker: new host or shutdown
+			std::condition_variable resolved; // first lookups waiting for the worker
+			std::unordered_map<std::string, Entry> entries;
+			std::uint64_t hits = 0;
+			std::uint64_t staleHits = 0;
+			std::uint64_t misses = 0;
+			std::uint64_t failures = 0;
+			std::thread::id uiThread;
+			bool stop = false;
+		};
+
+#ifdef _WIN32
+		// Reference on the module containing this code, released by the worker as it exits
+		static HMODULE pinModule() {
+			HMODULE module = nullptr;
+			GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&DnsCache::pinModule), &module);
+			return module;
+		}
+#else
+		static void* pinModule() { return nullptr; }
+#endif
+
+		static void run(std::shared_ptr<State> shared) {
+			State& state = *shared;
+			trace::Tracer::instance().setThreadName("DNS cache");
+			std::unique_lock<std::mutex> lock(state.mutex);
+			while (!state.stop) {
+				// Most urgent host still in use
+				const auto now = Clock::now();
+				std::string host;
+				Clock::time_point due = Clock::time_point::max();
+				for (auto& [name, entry] : state.entries) {
+					if (now - entry.lastUsed > MAX_STALE) continue; // not used lately, let it expire
+					if (entry.nextRefresh < due) {
+						due = entry.nextRefresh;
+						host = name;
+					}
+				}
+				if (host.empty() || due > now) {
+					if (due == Clock::time_point::max()) state.wake.wait(lock);
+					else state.wake.wait_until(lock, due);
+					continue;
+				}
+
+				// Resolve without holding the lock, lookups keep being served meanwhile
+				state.entries[host].nextRefresh = Clock::time_point::max(); // in progress
+				lock.unlock();
+				std::optional<Resolution> resolution;
+				{
+					TRACE_SPAN("dns resolve");
+					const auto start = EventLog::now();
+					resolution = state.resolver(host);
+					EventLog::instance().record("dns resolve", start, 0, resolution ? resolution->addresses.size() : 0, host);
+				}
+				lock.lock();
+
+				Entry& entry = state.entries[host];
+				const auto done = Clock::now();
+				if (resolution && !resolution->addresses.empty()) {
+					const std::chrono::milliseconds ttl = resolution->ttl.count() > 0 ? (std::max)(resolution->ttl, state.timing.minTtl) : DEFAULT_TTL;
+					entry.addresses = std::move(resolution->addresses);
+					entry.expires = done + ttl;
+					entry.nextRefresh = entry.expires - state.timing.refreshAhead;
+					entry.failed = false;
+				}
+				else {
+					++state.failures;
+					entry.failed = true;
+					entry.nextRefresh = done + state.timing.retryDelay; // keep serving the stale address meanwhile
+				}
+				state.resolved.notify_all();
+			}
+			state.resolved.notify_all();
+		}
+
+		std::shared_ptr<State> state_;
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,268 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/ApiClient.h"
+#include "core/Cancellation.h"
+
+// The API host and its mirrors, ranked by observed latency.
+// Every call is timed per endpoint over its last LATENCY_SAMPLES answers. A call goes to the
+// endpoint with the lowest median; if it hasn't answered by that endpoint's p95 (or failed
+// before), the same request is sent to the second best and the first answer wins, the other call
+// is cancelled. About one call in twenty is sent twice, for the slowest twentieth. If both fail
+// the remaining endpoints are tried in turn. A failed endpoint ranks last until RETRY_AFTER has
+// passed.
+// Only reads are hedged. An assignment sent twice may be applied by one endpoint and rejected as a
+// duplicate by the other, so it goes out once through getOnce().
+
+namespace rampAgent {
+
+	class EndpointSet {
+	public:
+		static constexpr std::size_t LATENCY_SAMPLES = 64;
+		static constexpr std::size_t MIN_SAMPLES = 8; // fewer: DEFAULT_HEDGE_DELAY
+		static constexpr std::chrono::milliseconds DEFAULT_HEDGE_DELAY{ 250 };
+		static constexpr std::chrono::milliseconds MIN_HEDGE_DELAY{ 20 };
+		static constexpr std::chrono::milliseconds MAX_HEDGE_DELAY{ 1000 }; // the transports' read timeout
+		static constexpr std::chrono::seconds RETRY_AFTER{ 30 };
+
+		struct Stats {
+			std::string host;
+			std::size_t samples;
+			std::chrono::microseconds p50;
+			std::chrono::microseconds p95;
+			std::uint64_t calls;
+			std::uint64_t failures;
+			bool failing;
+		};
+
+		// hosts: "host[:port]", comma-separated, primary first
+		explicit EndpointSet(const std::string& hosts) { set(hosts); }
+
+		// Any thread; latency history of hosts still listed is kept
+		void set(const std::string& hosts) {
+			std::vector<Endpoint> next;
+			std::size_t begin = 0;
+			while (begin <= hosts.size()) {
+				std::size_t end = hosts.find(',', begin);
+				if (end == std::string::npos) end = hosts.size();
+				std::string host = hosts.substr(begin, end - begin);
+				host.erase(0, host.find_first_not_of(' '));
+				host.erase(host.find_last_not_of(' ') + 1);
+				begin = end + 1;
+				if (host.empty()) continue;
+				if (std::any_of(next.begin(), next.end(), [&](const Endpoint& e) { return e.host == host; })) continue;
+				Endpoint endpoint;
+				endpoint.host = std::move(host);
+				next.push_back(std::move(endpoint));
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (Endpoint& endpoint : next) {
+				for (Endpoint& old : endpoints_) {
+					if (old.host == endpoint.host) endpoint = std::move(old);
+				}
+			}
+			endpoints_ = std::move(next);
+		}
+
+		// Comma-separated, as given to set()
+		std::string hosts() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::string list;
+			for (const Endpoint& endpoint : endpoints_) list += (list.empty() ? "" : ",") + endpoint.host;
+			return list;
+		}
+
+		// GET path from the fastest endpoint, hedged as above. Thread-safe; a cancelled call
+		// returns status 0.
+		ApiResponse get(ApiClient& api, const std::string& path, const CancelToken& cancel = {}) {
+			std::chrono::microseconds delay;
+			const std::vector<std::string> ranked = rank(delay);
+			if (ranked.empty() || cancel.cancelled()) return {};
+			if (ranked.size() == 1) return timed(api, ranked[0], path, cancel).response;
+
+			Race race;
+			CancelSource primaryCancel, hedgeCancel;
+			CancelRegistration link = cancel.onCancel([&] {
+				primaryCancel.cancel();
+				hedgeCancel.cancel();
+			});
+
+			std::thread hedge([&] {
+				{
+					std::unique_lock<std::mutex> lock(race.mutex);
+					race.cv.wait_for(lock, delay, [&] { return race.primaryReturned; });
+					if (race.done) return;
+				}
+				if (cancel.cancelled()) return;
+				++hedges_;
+				Attempt attempt = timed(api, ranked[1], path, hedgeCancel.token(), &cancel);
+				if (race.finish(attempt)) {
+					++hedgeWins_;
+					primaryCancel.cancel();
+				}
+			});
+
+			Attempt primary = timed(api, ranked[0], path, primaryCancel.token(), &cancel);
+			if (race.finish(primary)) hedgeCancel.cancel();
+			{
+				std::lock_guard<std::mutex> lock(race.mutex);
+				race.primaryReturned = true; // answered: no hedge; failed or cancelled: hedge now, or not at all
+			}
+			race.cv.notify_one();
+			hedge.join();
+			link.reset();
+
+			if (race.done || cancel.cancelled()) return std::move(race.winner);
+			for (std::size_t i = 2; i < ranked.size(); ++i) {
+				Attempt attempt = timed(api, ranked[i], path, cancel);
+				if (answered(attempt.response) || cancel.cancelled()) return std::move(attempt.response);
+				if (attempt.response.status != 0) race.failure = std::move(attempt.response);
+			}
+			return std::move(race.failure);
+		}
+
+		// GET path from the fastest endpoint, exactly once: no hedge and no other endpoint on failure.
+		// For calls that change state on the server.
+		ApiResponse getOnce(ApiClient& api, const std::string& path, const CancelToken& cancel = {}) {
+			std::chrono::microseconds delay;
+			const std::vector<std::string> ranked = rank(delay);
+			if (ranked.empty() || cancel.cancelled()) return {};
+			return timed(api, ranked[0], path, cancel).response;
+		}
+
+		std::vector<Stats> stats() const {
+			const auto now = std::chrono::steady_clock::now();
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::vector<Stats> result;
+			for (const Endpoint& endpoint : endpoints_) {
+				result.push_back({ endpoint.host, endpoint.count, endpoint.percentile(50), endpoint.percentile(95), endpoint.calls, endpoint.failures, endpoint.failing(now) });
+			}
+			return result;
+		}
+
+		std::uint64_t hedges() const { return hedges_.load(std::memory_order_relaxed); }       // second requests sent
+		std::uint64_t hedgeWins() const { return hedgeWins_.load(std::memory_order_relaxed); } // ... that answered first
+
+	private:
+		struct Endpoint {
+			std::string host;
+			std::array<std::uint32_t, LATENCY_SAMPLES> samples{}; // us, ring
+			std::size_t count = 0;
+			std::size_t next = 0;
+			std::uint64_t calls = 0;
+			std::uint64_t failures = 0;
+			std::uint32_t consecutiveFailures = 0;
+			std::chrono::steady_clock::time_point lastFailure;
+
+			bool failing(std::chrono::steady_clock::time_point now) const { return consecutiveFailures > 0 && now - lastFailure < RETRY_AFTER; }
+
+			std::chrono::microseconds percentile(int p) const {
+				if (count == 0) return std::chrono::microseconds(0);
+				std::array<std::uint32_t, LATENCY_SAMPLES> sorted = samples;
+				const std::size_t rank = (count * p + 99) / 100 - 1;
+				std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+				return std::chrono::microseconds(sorted[rank]);
+			}
+
+			// Ranking key among endpoints that aren't failing: the typical answer time
+			std::chrono::microseconds typical() const { return count < MIN_SAMPLES ? DEFAULT_HEDGE_DELAY : percentile(50); }
+
+			std::chrono::microseconds hedgeDelay() const {
+				if (count < MIN_SAMPLES) return DEFAULT_HEDGE_DELAY;
+				return std::clamp<std::chrono::microseconds>(percentile(95), MIN_HEDGE_DELAY, MAX_HEDGE_DELAY);
+			}
+		};
+
+		struct Attempt {
+			ApiResponse response;
+			bool cancelled; // lost the race, or the caller cancelled
+		};
+
+		struct Race {
+			std::mutex mutex;
+			std::condition_variable cv;
+			bool done = false; // an attempt answered
+			bool primaryReturned = false;
+			ApiResponse winner;
+			ApiResponse failure; // latest failure with a status, returned if nothing answers
+
+			// True if attempt won
+			bool finish(Attempt& attempt) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (attempt.cancelled) return false;
+				if (EndpointSet::answered(attempt.response)) {
+					if (done) return false;
+					done = true;
+					winner = std::move(attempt.response);
+					return true;
+				}
+				if (attempt.response.status != 0) failure = std::move(attempt.response);
+				return false;
+			}
+		};
+
+		// A 5xx means this endpoint can't serve the call, another one may
+		static bool answered(const ApiResponse& response) { return response.status != 0 && response.status < 500; }
+
+		// Hosts, best first, and the hedge delay of the best
+		std::vector<std::string> rank(std::chrono::microseconds& delay) const {
+			const auto now = std::chrono::steady_clock::now();
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::vector<const Endpoint*> order;
+			for (const Endpoint& endpoint : endpoints_) order.push_back(&endpoint);
+			std::stable_sort(order.begin(), order.end(), [&](const Endpoint* a, const Endpoint* b) {
+				if (a->failing(now) != b->failing(now)) return b->failing(now);
+				return a->typical() < b->typical();
+			});
+			std::vector<std::string> hosts;
+			for (const Endpoint* endpoint : order) hosts.push_back(endpoint->host);
+			delay = order.empty() ? DEFAULT_HEDGE_DELAY : order.front()->hedgeDelay();
+			return hosts;
+		}
+
+		// One call, recorded against host. A call cancelled by the race (not by caller) still
+		// records its elapsed time: the endpoint took at least that long.
+		Attempt timed(ApiClient& api, const std::string& host, const std::string& path, const CancelToken& token, const CancelToken* caller = nullptr) {
+			const auto start = std::chrono::steady_clock::now();
+			Attempt attempt{ api.get(host, path, token), token.cancelled() };
+			const auto end = std::chrono::steady_clock::now();
+			if (caller != nullptr ? caller->cancelled() : attempt.cancelled) return attempt;
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (Endpoint& endpoint : endpoints_) {
+				if (endpoint.host != host) continue;
+				++endpoint.calls;
+				if (attempt.cancelled || answered(attempt.response)) {
+					const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+					endpoint.samples[endpoint.next] = static_cast<std::uint32_t>((std::min<long long>)(elapsed, UINT32_MAX));
+					endpoint.next = (endpoint.next + 1) % LATENCY_SAMPLES;
+					endpoint.count = (std::min)(endpoint.count + 1, LATENCY_SAMPLES);
+					if (!attempt.cancelled) endpoint.consecutiveFailures = 0;
+				}
+				else {
+					++endpoint.failures;
+					++endpoint.consecutiveFailures;
+					endpoint.lastFailure = end;
+				}
+				break;
+			}
+			return attempt;
+		}
+
+		mutable std::mutex mutex_;
+		std::vector<Endpoint> endpoints_;
+		std::atomic<std::uint64_t> hedges_{ 0 };
+		std::atomic<std::uint64_t> hedgeWins_{ 0 };
+	};
+
+} // namespace rampAgent
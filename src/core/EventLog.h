@@ -0,0 +1,293 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Structured diagnostics log for post-mortem analysis (RampAgent.log, JSON Lines).
+// Each thread appends fixed-size records to its own single-producer ring, so the hot path is a
+// few stores and never locks or allocates; a background thread drains the rings, formats them
+// and appends to a size-rotated file. A full ring drops the record and counts it.
+
+namespace rampAgent {
+
+	class EventLog {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr std::size_t RING_CAPACITY = 1024;         // records per thread
+		static constexpr std::size_t DETAIL_SIZE = 80;             // longer details are truncated
+		static constexpr std::uintmax_t MAX_FILE_SIZE = 4 << 20;   // rotate past 4 MiB
+		static constexpr int MAX_FILES = 3;                        // RampAgent.log, .1, .2
+		static constexpr std::chrono::milliseconds FLUSH_INTERVAL{ 500 };
+
+		struct Record {
+			std::int64_t time = 0;        // Clock ticks
+			const char* stage = nullptr;  // must point to a string literal
+			std::uint32_t latencyUs = 0;
+			std::uint32_t bytes = 0;      // payload size
+			std::int32_t status = 0;      // HTTP status, 0: none or no response
+			std::uint32_t thread = 0;
+			char detail[DETAIL_SIZE] = { 0 };
+		};
+
+		static EventLog& instance() {
+			static EventLog log;
+			return log;
+		}
+
+		~EventLog() { stop(); }
+
+		EventLog(const EventLog&) = delete;
+		EventLog& operator=(const EventLog&) = delete;
+
+		// Starts the writer, records made while stopped are ignored
+		void start(const std::string& path) {
+			std::lock_guard<std::mutex> lock(writerMutex_);
+			if (worker_.joinable()) return;
+			path_ = path;
+			stop_ = false;
+			worker_ = std::thread(&EventLog::run, this);
+			enabled_.store(true, std::memory_order_release);
+		}
+
+		// Writes what is still buffered and stops the writer
+		void stop() {
+			{
+				std::lock_guard<std::mutex> lock(writerMutex_);
+				if (!worker_.joinable()) return;
+				enabled_.store(false, std::memory_order_release);
+				stop_ = true;
+			}
+			wake_.notify_all();
+			worker_.join();
+		}
+
+		bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+		static Clock::time_point now() { return Clock::now(); }
+
+		// Any thread. Latency is measured from start to now.
+		void record(const char* stage, Clock::time_point start, int status = 0, std::size_t bytes = 0, std::string_view detail = {}) {
+			if (!enabled()) return;
+			const Clock::time_point end = Clock::now();
+			append(stage, end, static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()), status, bytes, detail);
+		}
+
+		// Any thread, an event without duration
+		void event(const char* stage, std::string_view detail = {}, int status = 0) {
+			if (!enabled()) return;
+			append(stage, Clock::now(), 0, status, 0, detail);
+		}
+
+		std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+		std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+		std::uint64_t rotations() const { return rotations_.load(std::memory_order_relaxed); }
+		std::string path() const { std::lock_guard<std::mutex> lock(writerMutex_); return path_; }
+
+	private:
+		// Single producer (the owning thread), single consumer (the writer)
+		struct Ring {
+			std::atomic<std::uint64_t> head{ 0 };
+			alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+			std::atomic<std::uint64_t> dropped{ 0 };
+			std::atomic<bool> inUse{ true };
+			std::array<Record, RING_CAPACITY> records;
+		};
+
+		// Releases the ring on thread exit so short-lived worker threads recycle it
+		struct RingLease {
+			Ring* ring = nullptr;
+			std::uint32_t thread = 0;
+			~RingLease() { if (ring) ring->inUse.store(false, std::memory_order_release); }
+		};
+
+		EventLog() : clockEpoch_(Clock::now()), wallEpoch_(std::chrono::system_clock::now()) {}
+
+		void append(const char* stage, Clock::time_point time, std::uint32_t latencyUs, int status, std::size_t bytes, std::string_view detail) {
+			RingLease& lease = ringLease();
+			Ring& ring = *lease.ring;
+			const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+			if (head - ring.tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+				ring.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			Record& entry = ring.records[head % RING_CAPACITY];
+			entry.time = time.time_since_epoch().count();
+			entry.stage = stage;
+			entry.latencyUs = latencyUs;
+			entry.bytes = static_cast<std::uint32_t>((std::min)(bytes, std::size_t(UINT32_MAX)));
+			entry.status = status;
+			entry.thread = lease.thread;
+			const std::size_t length = (std::min)(detail.size(), DETAIL_SIZE - 1);
+			std::memcpy(entry.detail, detail.data(), length);
+			entry.detail[length] = '\0';
+			ring.head.store(head + 1, std::memory_order_release);
+		}
+
+		RingLease& ringLease() {
+			thread_local RingLease lease;
+			if (lease.ring == nullptr) {
+				lease.ring = acquireRing();
+#ifdef _WIN32
+				lease.thread = static_cast<std::uint32_t>(GetCurrentThreadId());
+#else
+				lease.thread = static_cast<std::uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+			}
+			return lease;
+		}
+
+		Ring* acquireRing() {
+			std::lock_guard<std::mutex> lock(ringsMutex_);
+			for (auto& ring : rings_) {
+				bool expected = false;
+				if (ring->inUse.compare_exchange_strong(expected, true)) return ring.get();
+			}
+			rings_.push_back(std::make_unique<Ring>());
+			return rings_.back().get();
+		}
+
+		void run() {
+			std::ofstream out;
+			std::uintmax_t size = 0;
+			auto open = [&] {
+				std::error_code ec;
+				size = std::filesystem::exists(path_, ec) ? std::filesystem::file_size(path_, ec) : 0;
+				out.open(path_, std::ios::binary | std::ios::app);
+			};
+			open();
+
+			std::string buffer;
+			std::unique_lock<std::mutex> lock(writerMutex_);
+			for (;;) {
+				const bool stopping = wake_.wait_for(lock, FLUSH_INTERVAL, [&] { return stop_; });
+				lock.unlock();
+
+				buffer.clear();
+				drain(buffer);
+				if (!buffer.empty()) {
+					if (size + buffer.size() > MAX_FILE_SIZE && size > 0) {
+						out.close();
+						rotate();
+						open();
+					}
+					out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+					out.flush();
+					size += buffer.size();
+				}
+
+				lock.lock();
+				if (stopping) break;
+			}
+		}
+
+		// Writer thread: formats every pending record as one JSON line
+		void drain(std::string& buffer) {
+			std::uint64_t lost = 0;
+			std::lock_guard<std::mutex> lock(ringsMutex_);
+			for (auto& ring : rings_) {
+				const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+				std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+				for (; tail < head; ++tail) format(ring->records[tail % RING_CAPACITY], buffer);
+				ring->tail.store(tail, std::memory_order_release);
+				lost += ring->dropped.exchange(0, std::memory_order_relaxed);
+			}
+			if (lost != 0) {
+				Record overflow;
+				overflow.time = Clock::now().time_since_epoch().count();
+				overflow.stage = "log overflow";
+				overflow.bytes = static_cast<std::uint32_t>(lost); // records lost
+				format(overflow, buffer);
+				dropped_.fetch_add(lost, std::memory_order_relaxed);
+			}
+		}
+
+		void format(const Record& entry, std::string& buffer) {
+			// {"ts":"2025-06-01T18:04:12.123456Z","thread":1234,"stage":"occupancy poll","latency_us":812,"status":200,"bytes":5123,"detail":"LFPG_GND"}
+			const auto wall = wallEpoch_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(Clock::time_point(Clock::duration(entry.time)) - clockEpoch_);
+			const auto us = std::chrono::duration_cast<std::chrono::microseconds>(wall.time_since_epoch()).count();
+			const std::time_t seconds = static_cast<std::time_t>(us / 1000000);
+			std::tm utc{};
+#ifdef _WIN32
+			gmtime_s(&utc, &seconds);
+#else
+			gmtime_r(&seconds, &utc);
+#endif
+			char line[96];
+			std::snprintf(line, sizeof(line), "{\"ts\":\"%04d-%02d-%02dT%02d:%02d:%02d.%06dZ\",\"thread\":%u,\"stage\":\"",
+				utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<int>(us % 1000000), entry.thread);
+			buffer += line;
+			escape(entry.stage, buffer);
+			std::snprintf(line, sizeof(line), "\",\"latency_us\":%u,\"status\":%d,\"bytes\":%u,\"detail\":\"", entry.latencyUs, entry.status, entry.bytes);
+			buffer += line;
+			escape(entry.detail, buffer);
+			buffer += "\"}\n";
+			written_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		static void escape(const char* text, std::string& buffer) {
+			for (; *text != '\0'; ++text) {
+				const unsigned char c = static_cast<unsigned char>(*text);
+				if (c == '"' || c == '\\') {
+					buffer += '\\';
+					buffer += static_cast<char>(c);
+				}
+				else if (c < 0x20) {
+					char code[8];
+					std::snprintf(code, sizeof(code), "\\u%04x", c);
+					buffer += code;
+				}
+				else {
+					buffer += static_cast<char>(c);
+				}
+			}
+		}
+
+		// RampAgent.log -> .1 -> .2, the oldest is deleted
+		void rotate() {
+			std::error_code ec;
+			std::filesystem::remove(path_ + "." + std::to_string(MAX_FILES - 1), ec);
+			for (int i = MAX_FILES - 2; i >= 1; --i) {
+				std::filesystem::rename(path_ + "." + std::to_string(i), path_ + "." + std::to_string(i + 1), ec);
+			}
+			std::filesystem::rename(path_, path_ + ".1", ec);
+			rotations_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::atomic<bool> enabled_{ false };
+		const Clock::time_point clockEpoch_;
+		const std::chrono::system_clock::time_point wallEpoch_;
+
+		std::mutex ringsMutex_; // registry only, records are not locked
+		std::vector<std::unique_ptr<Ring>> rings_;
+
+		mutable std::mutex writerMutex_;
+		std::condition_variable wake_;
+		std::thread worker_;
+		std::string path_;
+		bool stop_ = false;
+
+		std::atomic<std::uint64_t> written_{ 0 };
+		std::atomic<std::uint64_t> dropped_{ 0 };
+		std::atomic<std::uint64_t> rotations_{ 0 };
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+#include "core/StringTable.h"
+
+// Incremental airborne/ground state per aircraft, fed by radar position updates.
+// Hysteresis (separate thresholds plus consecutive confirmations) keeps a slow taxi or a
+// noisy ground speed around the threshold from flapping between states.
+
+namespace rampAgent {
+
+	enum class GroundTransition : std::uint8_t {
+		None = 0,
+		Landed,   // airborne -> ground, or first seen on ground
+		Airborne, // ground -> airborne
+	};
+
+	class GroundStateTracker {
+	public:
+		static constexpr int AIRBORNE_SPEED_KT = 80;
+		static constexpr std::uint8_t CONFIRMATIONS = 2;
+
+		explicit GroundStateTracker(int groundSpeedKt) : groundSpeedKt_(groundSpeedKt) {}
+
+		// UI thread only (OnRadarTargetPositionUpdate)
+		GroundTransition update(CallsignId callsign, int groundSpeed) {
+			State& state = states_[callsign];
+			if (!state.known) {
+				state.known = true;
+				state.onGround = groundSpeed <= groundSpeedKt_;
+				return state.onGround ? GroundTransition::Landed : GroundTransition::None;
+			}
+
+			const bool towardsOpposite = state.onGround ? groundSpeed > AIRBORNE_SPEED_KT : groundSpeed <= groundSpeedKt_;
+			if (!towardsOpposite) {
+				state.confirmations = 0;
+				return GroundTransition::None;
+			}
+			if (++state.confirmations < CONFIRMATIONS) return GroundTransition::None;
+
+			state.confirmations = 0;
+			state.onGround = !state.onGround;
+			return state.onGround ? GroundTransition::Landed : GroundTransition::Airborne;
+		}
+
+		bool isOnGround(CallsignId callsign) const {
+			const State* state = states_.find(callsign);
+			return state != nullptr && state->known && state->onGround;
+		}
+
+		void forget(CallsignId callsign) { states_.erase(callsign); }
+
+		std::size_t size() const { return states_.size(); }
+		std::size_t memoryBytes() const { return states_.memoryBytes(); }
+
+	private:
+		struct State {
+			bool known = false;
+			bool onGround = false;
+			std::uint8_t confirmations = 0;
+		};
+
+		int groundSpeedKt_;
+		IdMap<State> states_;
+	};
+
+} // namespace rampAgent
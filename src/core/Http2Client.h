@@ -0,0 +1,195 @@
+#pragma once
+#ifdef RAMPAGENT_HTTP2
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+#include "core/ApiClient.h"
+#include "core/Trace.h"
+
+// libcurl + nghttp2 transport (CMake option RAMPAGENT_HTTP2).
+// All requests go through one curl multi handle driven by a worker thread, with multiplexing
+// enabled and a single connection per host, so concurrent polls, catalogue fetches and
+// assignments share one TLS connection and HPACK-compressed headers. Callers block on their own
+// request only. Cancelling a request wakes the worker, which removes it from the multi handle
+// whatever its stage (resolve, connect, TLS or transfer); the shared connection stays up.
+
+namespace rampAgent {
+
+	class Http2Client : public ApiClient {
+	public:
+		// caFile: extra CA bundle, e.g. for a local test server; empty uses the system store
+		explicit Http2Client(std::string caFile = {}) : caFile_(std::move(caFile)) {
+			curl_global_init(CURL_GLOBAL_DEFAULT);
+			multi_ = curl_multi_init();
+			curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+			curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, 1L);
+			worker_ = std::thread(&Http2Client::run, this);
+		}
+
+		~Http2Client() override {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stop_ = true;
+			}
+			curl_multi_wakeup(multi_);
+			worker_.join();
+			curl_multi_cleanup(multi_);
+			curl_global_cleanup();
+		}
+
+		Http2Client(const Http2Client&) = delete;
+		Http2Client& operator=(const Http2Client&) = delete;
+
+		ApiResponse get(const std::string& host, const std::string& path, const CancelToken& cancel = {}) override {
+			auto request = std::make_unique<Request>();
+			request->url = "https://" + host + path;
+			request->cancel = cancel;
+			const auto [name, port] = splitHost(host);
+			const std::string address = resolve(name, cancel); // may wait on a first lookup, so not on the worker
+			if (!address.empty()) request->resolve = name + ":" + std::to_string(port) + ":" + address;
+			std::future<ApiResponse> result = request->promise.get_future();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (stop_ || cancel.cancelled()) return {};
+				submitted_.push_back(std::move(request));
+			}
+			++requests_;
+			CancelRegistration wakeUp = cancel.onCancel([this] { curl_multi_wakeup(multi_); });
+			curl_multi_wakeup(multi_);
+			return result.get();
+		}
+
+		const char* name() const override { return "HTTP/2"; }
+
+	private:
+		struct Request {
+			std::string url;
+			ApiResponse response;
+			std::promise<ApiResponse> promise;
+			std::string resolve; // CURLOPT_RESOLVE entry from the DNS cache
+			CancelToken cancel;
+			curl_slist* headers = nullptr;
+			curl_slist* resolveList = nullptr;
+		};
+
+		static size_t onData(char* data, size_t size, size_t count, void* user) {
+			static_cast<Request*>(user)->response.body.append(data, size * count);
+			return size * count;
+		}
+
+		void start(std::unique_ptr<Request> request) {
+			if (request->cancel.cancelled()) {
+				++cancelled_;
+				request->promise.set_value({});
+				return;
+			}
+			CURL* easy = curl_easy_init();
+			request->headers = curl_slist_append(request->headers, (std::string("Accept: ") + API_ACCEPT).c_str());
+			curl_easy_setopt(easy, CURLOPT_URL, request->url.c_str());
+			curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+			curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L); // wait for the shared connection rather than opening another
+			curl_easy_setopt(easy, CURLOPT_USERAGENT, USER_AGENT);
+			curl_easy_setopt(easy, CURLOPT_HTTPHEADER, request->headers);
+			curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+			curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, 700L);
+			curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, 2000L);
+			curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+			curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &Http2Client::onData);
+			curl_easy_setopt(easy, CURLOPT_WRITEDATA, request.get());
+			curl_easy_setopt(easy, CURLOPT_PRIVATE, request.get());
+			if (!caFile_.empty()) curl_easy_setopt(easy, CURLOPT_CAINFO, caFile_.c_str());
+			if (!request->resolve.empty()) {
+				request->resolveList = curl_slist_append(nullptr, request->resolve.c_str());
+				curl_easy_setopt(easy, CURLOPT_RESOLVE, request->resolveList);
+			}
+#ifdef _WIN32
+			curl_easy_setopt(easy, CURLOPT_SSL_OPTIONS, static_cast<long>(CURLSSLOPT_NATIVE_CA));
+#endif
+			curl_multi_add_handle(multi_, easy);
+			inFlight_.push_back(easy);
+			request.release(); // owned by the multi handle until finish()
+		}
+
+		void finish(CURL* easy, CURLcode code) {
+			Request* raw = nullptr;
+			curl_easy_getinfo(easy, CURLINFO_PRIVATE, &raw);
+			std::unique_ptr<Request> request(raw);
+
+			long connects = 0;
+			curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+			connections_ += static_cast<std::uint64_t>(connects);
+			if (code == CURLE_OK) {
+				long status = 0;
+				curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+				request->response.status = static_cast<int>(status);
+				const char* contentType = nullptr;
+				curl_easy_getinfo(easy, CURLINFO_CONTENT_TYPE, &contentType);
+				if (contentType != nullptr) request->response.contentType = contentType;
+			}
+			else {
+				request->response = {};
+			}
+
+			inFlight_.erase(std::find(inFlight_.begin(), inFlight_.end(), easy));
+			curl_multi_remove_handle(multi_, easy);
+			curl_easy_cleanup(easy);
+			curl_slist_free_all(request->headers);
+			curl_slist_free_all(request->resolveList);
+			request->promise.set_value(std::move(request->response));
+		}
+
+		void run() {
+			trace::Tracer::instance().setThreadName("HTTP/2 client");
+			std::deque<std::unique_ptr<Request>> pending;
+			for (;;) {
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					if (stop_) break;
+					pending.swap(submitted_);
+				}
+				for (auto& request : pending) start(std::move(request));
+				pending.clear();
+
+				// Cancelled requests leave before the next transfer step
+				for (std::size_t i = inFlight_.size(); i > 0; --i) {
+					Request* request = nullptr;
+					curl_easy_getinfo(inFlight_[i - 1], CURLINFO_PRIVATE, &request);
+					if (!request->cancel.cancelled()) continue;
+					++cancelled_;
+					finish(inFlight_[i - 1], CURLE_ABORTED_BY_CALLBACK);
+				}
+
+				int running = 0;
+				curl_multi_perform(multi_, &running);
+				int queued = 0;
+				while (CURLMsg* message = curl_multi_info_read(multi_, &queued)) {
+					if (message->msg == CURLMSG_DONE) finish(message->easy_handle, message->data.result);
+				}
+				curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+			}
+
+			// Fail whatever is still in flight or queued
+			while (!inFlight_.empty()) finish(inFlight_.back(), CURLE_ABORTED_BY_CALLBACK);
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (auto& request : submitted_) request->promise.set_value({});
+			submitted_.clear();
+		}
+
+		std::string caFile_;
+		CURLM* multi_ = nullptr;
+		std::thread worker_;
+		std::vector<CURL*> inFlight_; // worker thread only
+		std::mutex mutex_;
+		std::deque<std::unique_ptr<Request>> submitted_;
+		bool stop_ = false;
+	};
+
+} // namespace rampAgent
+#endif // RAMPAGENT_HTTP2
@@ -0,0 +1,119 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "core/StandCatalogue.h"
+#include "core/StringTable.h"
+
+// Radar-derived stand occupancy.
+// Slow ground targets are mapped to the stand whose circle contains them, so the local view marks
+// a stand occupied or vacated as soon as the aircraft parks or pushes back, without waiting for
+// the next server poll. Vacations override the server only until a poll taken after them has
+// had time to catch up. UI thread only.
+
+namespace rampAgent {
+
+	class LocalOccupancy {
+	public:
+		static constexpr int PARKED_SPEED_KT = 5;
+		static constexpr double DEFAULT_STAND_RADIUS_M = 25.0;
+		static constexpr std::chrono::seconds VACATE_GRACE{ 20 }; // longer than one server poll
+
+		// Feeds one radar position. Returns true if the local view changed.
+		template <typename Catalogues>
+		bool update(CallsignId callsign, double latitude, double longitude, int groundSpeed, bool onGround, const Catalogues& catalogues) {
+			if (!onGround || groundSpeed > PARKED_SPEED_KT) return vacate(callsign);
+
+			for (const auto& [airport, catalogue] : catalogues) {
+				if (!catalogue->index.withinBounds(latitude, longitude, DEFAULT_STAND_RADIUS_M * 2)) continue;
+				const std::uint32_t index = locate(*catalogue, latitude, longitude);
+				if (index == NOT_FOUND) continue;
+				return occupy(callsign, airport, catalogue->stands[index].name);
+			}
+			return vacate(callsign);
+		}
+
+		void forget(CallsignId callsign) {
+			vacate(callsign);
+			vacated_.erase(callsign);
+		}
+
+		// A server snapshot fetched at serverTime is being applied
+		void reconcile(std::chrono::steady_clock::time_point serverTime) {
+			vacatedScratch_.clear();
+			vacated_.forEach([&](CallsignId callsign, const Parked& parked) {
+				if (parked.since + VACATE_GRACE < serverTime) vacatedScratch_.push_back(callsign);
+			});
+			for (CallsignId callsign : vacatedScratch_) vacated_.erase(callsign);
+		}
+
+		// True if the server still reports callsign on stand but radar saw it leave
+		bool hasVacated(CallsignId callsign, AirportId airport, StandId stand) const {
+			const Parked* parked = vacated_.find(callsign);
+			return parked != nullptr && parked->airport == airport && parked->stand == stand;
+		}
+
+		template <typename Fn>
+		void forEachOccupied(AirportId airport, Fn&& fn) const {
+			for (const auto& [key, callsign] : occupiedBy_) {
+				if (static_cast<AirportId>(key >> 32) == airport) fn(static_cast<StandId>(key & 0xFFFFFFFFu), callsign);
+			}
+		}
+
+		bool isParked(CallsignId callsign) const { return parked_.contains(callsign); }
+
+		std::size_t occupiedCount() const { return occupiedBy_.size(); }
+		std::size_t vacatedCount() const { return vacated_.size(); }
+		std::uint64_t updates() const { return updates_; }
+
+	private:
+		static constexpr std::uint32_t NOT_FOUND = 0xFFFFFFFFu;
+
+		struct Parked {
+			AirportId airport = EMPTY_ID;
+			StandId stand = EMPTY_ID;
+			std::chrono::steady_clock::time_point since;
+		};
+
+		static std::uint64_t key(AirportId airport, StandId stand) { return (static_cast<std::uint64_t>(airport) << 32) | stand; }
+
+		// Stand whose circle contains the position; the two nearest candidates cover adjoining stands
+		static std::uint32_t locate(const StandCatalogue& catalogue, double latitude, double longitude) {
+			for (std::uint32_t index : catalogue.index.nearest(latitude, longitude, 2, [](std::uint32_t) { return true; })) {
+				const double radius = catalogue.stands[index].radius > 0.0 ? catalogue.stands[index].radius : DEFAULT_STAND_RADIUS_M;
+				if (catalogue.index.distanceSquared(index, latitude, longitude) <= radius * radius) return index;
+			}
+			return NOT_FOUND;
+		}
+
+		bool occupy(CallsignId callsign, AirportId airport, StandId stand) {
+			if (const Parked* parked = parked_.find(callsign); parked != nullptr && parked->airport == airport && parked->stand == stand) return false;
+			vacate(callsign);
+			++updates_;
+			parked_[callsign] = { airport, stand, std::chrono::steady_clock::now() };
+			occupiedBy_[key(airport, stand)] = callsign;
+			vacated_.erase(callsign);
+			return true;
+		}
+
+		bool vacate(CallsignId callsign) {
+			const Parked* parked = parked_.find(callsign);
+			if (parked == nullptr) return false;
+			++updates_;
+			auto it = occupiedBy_.find(key(parked->airport, parked->stand));
+			if (it != occupiedBy_.end() && it->second == callsign) occupiedBy_.erase(it);
+			vacated_[callsign] = { parked->airport, parked->stand, std::chrono::steady_clock::now() };
+			parked_.erase(callsign);
+			return true;
+		}
+
+		IdMap<Parked> parked_;
+		IdMap<Parked> vacated_;
+		std::unordered_map<std::uint64_t, CallsignId> occupiedBy_;
+		std::vector<CallsignId> vacatedScratch_;
+		std::uint64_t updates_ = 0;
+	};
+
+} // namespace rampAgent
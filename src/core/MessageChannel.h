@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// User messages from any thread to the EuroScope chat.
+// Producers push into a bounded lock-free queue, the UI thread drains it once per tick. Messages
+// sharing a key are coalesced, a keyed message identical to the last one shown for its key is
+// not repeated within REPEAT_INTERVAL, and a token bucket caps what reaches the chat when a
+// flapping server produces bursts. Unkeyed messages answer a user action and always get through.
+
+namespace rampAgent {
+
+	enum class MessageSeverity : std::uint8_t {
+		Info,
+		Warning,
+		Error
+	};
+
+	// Coalescing key, None: never coalesced, deduplicated nor rate limited (answers to a user action)
+	enum class MessageKey : std::uint8_t {
+		None,
+		Server,     // occupancy poll connectivity
+		Occupancy,  // occupancy payload
+		Catalogue,  // stand catalogue fetch
+		Count
+	};
+
+	struct Message {
+		MessageSeverity severity = MessageSeverity::Info;
+		MessageKey key = MessageKey::None;
+		std::string text;
+	};
+
+	// Bounded multi-producer single-consumer queue (Vyukov), Capacity must be a power of two
+	template <typename T, std::size_t Capacity>
+	class BoundedMpscQueue {
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		BoundedMpscQueue() {
+			for (std::size_t i = 0; i < Capacity; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+		BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+		// Any thread. False if the queue is full.
+		bool push(T&& value) {
+			std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;) {
+				cell = &cells_[pos & MASK];
+				const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+				if (diff == 0) {
+					if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = enqueuePos_.load(std::memory_order_relaxed);
+				}
+			}
+			cell->value = std::move(value);
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer thread only
+		bool pop(T& value) {
+			Cell& cell = cells_[dequeuePos_ & MASK];
+			const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			if (static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(dequeuePos_ + 1) < 0) return false;
+			value = std::move(cell.value);
+			cell.sequence.store(dequeuePos_ + Capacity, std::memory_order_release);
+			++dequeuePos_;
+			return true;
+		}
+
+	private:
+		static constexpr std::size_t MASK = Capacity - 1;
+
+		struct Cell {
+			std::atomic<std::size_t> sequence;
+			T value;
+		};
+
+		alignas(64) std::atomic<std::size_t> enqueuePos_{ 0 };
+		alignas(64) std::size_t dequeuePos_ = 0;
+		std::array<Cell, Capacity> cells_;
+	};
+
+	class MessageChannel {
+	public:
+		static constexpr std::size_t CAPACITY = 256;
+		static constexpr std::chrono::minutes REPEAT_INTERVAL{ 5 };
+		static constexpr double BURST = 5.0;                       // messages shown back to back at most
+		static constexpr std::chrono::seconds REFILL_PERIOD{ 5 };  // one more message allowed per period
+
+		using Clock = std::chrono::steady_clock;
+
+		// Any thread
+		void push(MessageSeverity severity, MessageKey key, std::string text) {
+			if (!queue_.push({ severity, key, std::move(text) })) dropped_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// UI thread. display(const Message&) is called for each message that gets through.
+		template <typename DisplayFn>
+		std::size_t drain(DisplayFn&& display, Clock::time_point now = Clock::now()) {
+			batch_.clear();
+			Message message;
+			while (queue_.pop(message)) {
+				if (message.key != MessageKey::None) {
+					auto it = std::find_if(batch_.begin(), batch_.end(), [&](const Pending& p) { return p.message.key == message.key; });
+					if (it != batch_.end()) {
+						it->message = std::move(message); // latest state wins
+						++it->repeats;
+						++coalesced_;
+						continue;
+					}
+				}
+				batch_.push_back({ std::move(message), 1 });
+			}
+			if (batch_.empty() && rateLimited_ == 0) return 0;
+
+			refill(now);
+			std::size_t shown = 0;
+			for (Pending& pending : batch_) {
+				Message& current = pending.message;
+				if (current.key != MessageKey::None) {
+					LastShown& last = lastShown_[static_cast<std::size_t>(current.key)];
+					if (last.text == current.text && now - last.when < REPEAT_INTERVAL) {
+						++coalesced_;
+						continue;
+					}
+					if (tokens_ < 1.0) {
+						++rateLimited_;
+						continue;
+					}
+					tokens_ -= 1.0;
+					last = { current.text, now };
+				}
+				if (pending.repeats > 1) current.text += " (x" + std::to_string(pending.repeats) + ")";
+				display(current);
+				++shown;
+			}
+
+			if (rateLimited_ != 0 && tokens_ >= 1.0) {
+				tokens_ -= 1.0;
+				display(Message{ MessageSeverity::Warning, MessageKey::None, std::to_string(rateLimited_) + " messages suppressed (rate limit)." });
+				suppressed_ += rateLimited_;
+				rateLimited_ = 0;
+				++shown;
+			}
+			shown_ += shown;
+			return shown;
+		}
+
+		std::uint64_t shown() const { return shown_; }
+		std::uint64_t coalesced() const { return coalesced_; }
+		std::uint64_t suppressed() const { return suppressed_ + rateLimited_; }
+		std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	private:
+		struct Pending {
+			Message message;
+			std::uint32_t repeats;
+		};
+
+		struct LastShown {
+			std::string text;
+			Clock::time_point when;
+		};
+
+		void refill(Clock::time_point now) {
+			if (lastRefill_ == Clock::time_point{}) lastRefill_ = now;
+			const double periods = std::chrono::duration<double>(now - lastRefill_) / std::chrono::duration<double>(REFILL_PERIOD);
+			tokens_ = (std::min)(BURST, tokens_ + periods);
+			lastRefill_ = now;
+		}
+
+		BoundedMpscQueue<Message, CAPACITY> queue_;
+		std::atomic<std::uint64_t> dropped_{ 0 };
+
+		// UI thread only
+		std::vector<Pending> batch_;
+		std::array<LastShown, static_cast<std::size_t>(MessageKey::Count)> lastShown_;
+		double tokens_ = BURST;
+		Clock::time_point lastRefill_;
+		std::uint64_t rateLimited_ = 0; // not yet reported
+		std::uint64_t shown_ = 0;
+		std::uint64_t coalesced_ = 0;
+		std::uint64_t suppressed_ = 0;
+	};
+
+} // namespace rampAgent
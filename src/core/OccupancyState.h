@@ -0,0 +1,159 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/Callsign.h"
+#include "core/StringTable.h"
+
+// Server occupancy as immutable, versioned snapshots.
+// The poll thread parses each /api/occupancy response into an OccupancyState and publishes it with
+// one atomic pointer swap; runUpdate and the stand menu pin the current version and read it
+// without locking or copying. Manual assignments are recorded as edits and applied onto the next
+// version, so no thread mutates a published state.
+
+namespace rampAgent {
+
+	// Server stand lists of an occupancy response
+	enum class StandList : std::uint8_t {
+		Assigned,
+		Occupied,
+		Blocked
+	};
+
+	// Walks assignedStands, occupiedStands and blockedStands: fn(StandList, callsign, name, remark),
+	// callsign and remark empty when absent
+	template <typename Fn>
+	void forEachServerStand(const nlohmann::ordered_json& json, Fn&& fn) {
+		constexpr std::pair<const char*, StandList> LISTS[] = { { "assignedStands", StandList::Assigned }, { "occupiedStands", StandList::Occupied }, { "blockedStands", StandList::Blocked } };
+		using Json = nlohmann::ordered_json;
+		for (const auto& [key, kind] : LISTS) {
+			const Json::const_iterator list = json.find(key);
+			if (list == json.end() || !list->is_array()) continue;
+			for (const Json& entry : *list) {
+				if (!entry.is_object()) continue;
+				const Json::const_iterator name = entry.find("name");
+				if (name == entry.end() || !name->is_string()) continue;
+				std::string_view callsign, remark;
+				if (const Json::const_iterator cs = entry.find("callsign"); cs != entry.end() && cs->is_string()) callsign = cs->get_ref<const std::string&>();
+				// remark: accept string only; treat null/other as empty
+				if (const Json::const_iterator r = entry.find("remark"); r != entry.end() && r->is_string()) remark = r->get_ref<const std::string&>();
+				fn(kind, callsign, std::string_view(name->get_ref<const std::string&>()), remark);
+			}
+		}
+	}
+
+	struct OccupancyState {
+		struct Assignment {
+			CallsignId callsign;
+			StandId stand;     // EMPTY_ID: freed by a manual edit
+			StringId remark;
+			bool manual;       // set by a manual edit, already displayed
+
+			bool operator==(const Assignment&) const = default;
+		};
+
+		struct Unavailable {
+			StandId stand;
+			CallsignId callsign; // NO_ID if unknown or not seen on radar
+			bool occupied;       // from occupiedStands, radar may have seen it leave since
+
+			bool operator==(const Unavailable&) const = default;
+		};
+
+		std::uint64_t version = 0;
+		bool received = false; // false: no data, the poll failed or returned nothing
+		std::chrono::steady_clock::time_point fetched;
+		std::vector<Assignment> assignments; // assignedStands and occupiedStands, shown as tags
+		std::vector<Unavailable> unavailable; // assigned, occupied and blocked stands, hidden from the menu
+
+		// Same server data, whatever the version and fetch time
+		bool sameStands(const OccupancyState& other) const {
+			return received == other.received && assignments == other.assignments && unavailable == other.unavailable;
+		}
+
+		// Callsigns never seen on radar get no assignment, they can't have a tag
+		void add(StandList list, std::string_view callsign, std::string_view name, std::string_view remark, const CallsignTable& callsigns, StringTable& standNames, StringTable& remarks) {
+			const StandId stand = standNames.intern(name);
+			const CallsignId callsignId = callsign.empty() ? NO_ID : callsigns.find(Callsign(callsign));
+			unavailable.push_back({ stand, callsignId, list == StandList::Occupied });
+			if (list == StandList::Blocked || callsignId == NO_ID) return;
+			assignments.push_back({ callsignId, stand, remark.empty() ? EMPTY_ID : remarks.intern(remark), false });
+		}
+
+		static std::shared_ptr<OccupancyState> fromJson(const nlohmann::ordered_json& json, const CallsignTable& callsigns, StringTable& standNames, StringTable& remarks) {
+			auto state = std::make_shared<OccupancyState>();
+			state->fetched = std::chrono::steady_clock::now();
+			if (!json.is_object() || json.empty()) return state;
+			state->received = true;
+			forEachServerStand(json, [&](StandList list, std::string_view callsign, std::string_view name, std::string_view remark) {
+				state->add(list, callsign, name, remark, callsigns, standNames, remarks);
+			});
+			return state;
+		}
+	};
+
+	class OccupancyStore {
+	public:
+		OccupancyStore() : current_(std::make_shared<const OccupancyState>()) {}
+
+		// Any thread, lock-free. The pinned version stays valid while the pointer is held.
+		std::shared_ptr<const OccupancyState> pin() const { return current_.load(std::memory_order_acquire); }
+
+		// Poll thread: applies pending edits to next and makes it the current version. Without
+		// data (failed poll) the edits stay pending for the next version that has some.
+		void publish(std::shared_ptr<OccupancyState> next) {
+			if (next->received) {
+				std::vector<Edit> edits;
+				{
+					std::lock_guard<std::mutex> lock(editsMutex_);
+					edits.swap(edits_);
+				}
+				for (const Edit& edit : edits) apply(*next, edit);
+				editsApplied_.fetch_add(edits.size(), std::memory_order_relaxed);
+			}
+			next->version = version_.fetch_add(1, std::memory_order_relaxed) + 1;
+			current_.store(std::move(next), std::memory_order_release);
+		}
+
+		// Any thread: manual assignment (or EMPTY_ID to free) to carry into the next version
+		void edit(CallsignId callsign, StandId stand) {
+			std::lock_guard<std::mutex> lock(editsMutex_);
+			edits_.push_back({ callsign, stand });
+		}
+
+		std::uint64_t version() const { return version_.load(std::memory_order_relaxed); }
+		std::uint64_t editsApplied() const { return editsApplied_.load(std::memory_order_relaxed); }
+
+	private:
+		struct Edit {
+			CallsignId callsign;
+			StandId stand;
+		};
+
+		// The server may not reflect the edit yet, the edit wins for this version
+		static void apply(OccupancyState& state, const Edit& edit) {
+			for (OccupancyState::Assignment& assignment : state.assignments) {
+				if (assignment.callsign != edit.callsign) continue;
+				assignment.stand = edit.stand;
+				assignment.manual = true;
+				return;
+			}
+			state.assignments.push_back({ edit.callsign, edit.stand, EMPTY_ID, true });
+		}
+
+		std::atomic<std::shared_ptr<const OccupancyState>> current_;
+		std::atomic<std::uint64_t> version_{ 0 };
+		std::atomic<std::uint64_t> editsApplied_{ 0 };
+		std::mutex editsMutex_; // edits are rare, user-driven
+		std::vector<Edit> edits_;
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Own session (connection, role, callsign, auth token).
+// Evaluated by the UI thread only on the user's own controller updates and on a slow timer, instead
+// of on every controller update of the network. Each evaluation that changes something publishes a
+// new immutable snapshot which worker threads read without locking.
+
+namespace rampAgent {
+
+	struct Session {
+		bool connected = false;
+		bool controller = false; // connected on a controlling position, not an observer
+		int facility = 0;
+		std::string callsign;
+		std::string token;       // API token for callsign
+	};
+
+	class SessionState {
+	public:
+		SessionState() : session_(std::make_shared<const Session>()) {}
+
+		std::shared_ptr<const Session> current() const { return session_.load(std::memory_order_acquire); }
+
+		// Cheap filter for OnControllerPositionUpdate: only our own position is relevant
+		bool isOwnCallsign(std::string_view callsign) const { return !ownCallsign_.empty() && callsign == ownCallsign_; }
+
+		// Publishes the probed state if it differs from the current snapshot. Returns the previous
+		// snapshot when it changed, nullptr otherwise. UI thread only. makeToken(callsign) runs only
+		// when the callsign changes.
+		template <typename TokenFn>
+		std::shared_ptr<const Session> publish(bool connected, bool controller, int facility, std::string_view callsign, TokenFn&& makeToken) {
+			++evaluations_;
+			std::shared_ptr<const Session> previous = current();
+			if (previous->connected == connected && previous->controller == controller && previous->facility == facility && previous->callsign == callsign) return nullptr;
+
+			auto next = std::make_shared<Session>();
+			next->connected = connected;
+			next->controller = controller;
+			next->facility = facility;
+			next->callsign = std::string(callsign);
+			next->token = previous->callsign == callsign ? previous->token : (callsign.empty() ? std::string() : makeToken(next->callsign));
+			ownCallsign_ = next->callsign;
+			session_.store(std::move(next), std::memory_order_release);
+			++changes_;
+			return previous;
+		}
+
+		std::uint64_t evaluations() const { return evaluations_; }
+		std::uint64_t changes() const { return changes_; }
+
+	private:
+		std::atomic<std::shared_ptr<const Session>> session_;
+		std::string ownCallsign_; // UI thread copy of the snapshot callsign
+		std::uint64_t evaluations_ = 0;
+		std::uint64_t changes_ = 0;
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,185 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Named shared memory and a cross-process lock, for instances of the plugin running on one machine.
+// Win32: pagefile-backed file mapping and named mutex in the session namespace. POSIX: shm_open
+// segment and flock() on a second shm object, so the same code runs (and is tested) on Linux.
+// In both cases the lock is released by the OS when its owner process dies.
+
+namespace rampAgent {
+
+	class SharedMemory {
+	public:
+		SharedMemory() = default;
+		SharedMemory(const SharedMemory&) = delete;
+		SharedMemory& operator=(const SharedMemory&) = delete;
+		~SharedMemory() { close(); }
+
+		// Creates the segment zero-filled, or maps the existing one. name: plain identifier.
+		// Read-only unless writable; setWritable() changes the view later.
+		bool open(const std::string& name, std::size_t size, bool writable) {
+			close();
+#ifdef _WIN32
+			const std::string path = "Local\\" + name;
+			mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(size), path.c_str());
+			if (mapping_ == nullptr) return false;
+#else
+			const std::string path = "/" + name;
+			fd_ = shm_open(path.c_str(), O_RDWR | O_CREAT, 0600);
+			if (fd_ < 0) return false;
+			struct stat st {};
+			if (fstat(fd_, &st) != 0) { close(); return false; }
+			if (static_cast<std::size_t>(st.st_size) < size && ftruncate(fd_, static_cast<off_t>(size)) != 0) { close(); return false; }
+#endif
+			size_ = size;
+			if (!map(writable)) { close(); return false; }
+			return true;
+		}
+
+		// Remaps the segment read-write or read-only; data() may move. False (and unmapped) on failure.
+		bool setWritable(bool writable) {
+			if (data_ == nullptr) return false;
+			if (writable == writable_) return true;
+			unmap();
+			return map(writable);
+		}
+
+		void close() {
+			unmap();
+#ifdef _WIN32
+			if (mapping_ != nullptr) CloseHandle(mapping_);
+			mapping_ = nullptr;
+#else
+			if (fd_ >= 0) ::close(fd_);
+			fd_ = -1;
+#endif
+			size_ = 0;
+		}
+
+		// POSIX segments outlive their users until unlinked, Win32 ones don't
+		static void remove(const std::string& name) {
+#ifndef _WIN32
+			shm_unlink(("/" + name).c_str());
+#else
+			(void)name;
+#endif
+		}
+
+		bool isOpen() const { return data_ != nullptr; }
+		bool writable() const { return writable_; }
+		void* data() const { return data_; }
+		std::size_t size() const { return size_; }
+
+	private:
+		bool map(bool writable) {
+#ifdef _WIN32
+			data_ = MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size_);
+#else
+			void* data = mmap(nullptr, size_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+			data_ = data == MAP_FAILED ? nullptr : data;
+#endif
+			writable_ = writable && data_ != nullptr;
+			return data_ != nullptr;
+		}
+
+		void unmap() {
+#ifdef _WIN32
+			if (data_ != nullptr) UnmapViewOfFile(data_);
+#else
+			if (data_ != nullptr) munmap(data_, size_);
+#endif
+			data_ = nullptr;
+			writable_ = false;
+		}
+
+#ifdef _WIN32
+		HANDLE mapping_ = nullptr;
+#else
+		int fd_ = -1;
+#endif
+		void* data_ = nullptr;
+		std::size_t size_ = 0;
+		bool writable_ = false;
+	};
+
+	// Non-blocking exclusive lock shared by every process opening the same name.
+	// Win32 mutexes belong to a thread: tryLock/unlock must run on one thread (the UI thread).
+	class NamedLock {
+	public:
+		NamedLock() = default;
+		NamedLock(const NamedLock&) = delete;
+		NamedLock& operator=(const NamedLock&) = delete;
+		~NamedLock() { close(); }
+
+		bool open(const std::string& name) {
+			close();
+#ifdef _WIN32
+			handle_ = CreateMutexA(nullptr, FALSE, ("Local\\" + name).c_str());
+			return handle_ != nullptr;
+#else
+			fd_ = shm_open(("/" + name).c_str(), O_RDWR | O_CREAT, 0600);
+			return fd_ >= 0;
+#endif
+		}
+
+		void close() {
+			unlock();
+#ifdef _WIN32
+			if (handle_ != nullptr) CloseHandle(handle_);
+			handle_ = nullptr;
+#else
+			if (fd_ >= 0) ::close(fd_);
+			fd_ = -1;
+#endif
+		}
+
+		// True if held by this instance, now or already
+		bool tryLock() {
+			if (locked_) return true;
+#ifdef _WIN32
+			if (handle_ == nullptr) return false;
+			const DWORD result = WaitForSingleObject(handle_, 0);
+			locked_ = result == WAIT_OBJECT_0 || result == WAIT_ABANDONED; // abandoned: previous owner died
+#else
+			if (fd_ < 0) return false;
+			locked_ = flock(fd_, LOCK_EX | LOCK_NB) == 0;
+#endif
+			return locked_;
+		}
+
+		void unlock() {
+			if (!locked_) return;
+#ifdef _WIN32
+			ReleaseMutex(handle_);
+#else
+			flock(fd_, LOCK_UN);
+#endif
+			locked_ = false;
+		}
+
+		bool locked() const { return locked_; }
+
+		static void remove(const std::string& name) { SharedMemory::remove(name); }
+
+	private:
+#ifdef _WIN32
+		HANDLE handle_ = nullptr;
+#else
+		int fd_ = -1;
+#endif
+		bool locked_ = false;
+	};
+
+} // namespace rampAgent
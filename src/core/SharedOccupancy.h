@@ -0,0 +1,277 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/OccupancyState.h"
+#include "core/SharedMemory.h"
+
+// Occupancy shared by the plugin instances running on one machine (opt-in).
+// The instance holding the leader lock polls the server and writes every response, in compact
+// form, into a named segment; the other instances read it instead of polling. The segment has two
+// slots each guarded by a sequence counter, so followers copy the latest complete snapshot while
+// the next one is written. The OS releases the lock when the leader exits or crashes and the next
+// instance asking takes over; if the leader stops publishing (e.g. disconnected) followers fall
+// back to polling themselves. Only the leader maps the segment writable, a follower can't corrupt it.
+//
+// Layout: SegmentHeader, then two slots of SlotHeader + Record[count] + string pool.
+
+namespace rampAgent {
+
+	class SharedOccupancy {
+	public:
+		static constexpr const char* SEGMENT_NAME = "RampAgentOccupancy_v1";
+		static constexpr const char* LOCK_NAME = "RampAgentOccupancyLeader_v1";
+		static constexpr char MAGIC[8] = { 'R', 'A', 'O', 'C', 'C', 'S', 'H', '\0' };
+		static constexpr std::uint32_t LAYOUT = 1; // bump on any layout change, with the names above
+		static constexpr std::size_t SEGMENT_SIZE = 1 << 20;
+		static constexpr std::chrono::seconds STALE_AFTER{ 45 }; // three missed polls
+
+		enum class ReadResult {
+			Read,      // a newer snapshot was passed to fn
+			Unchanged, // nothing newer than the last one read
+			Stale,     // no live leader, poll the server
+			None       // shared mode off or segment unused
+		};
+
+		SharedOccupancy() : SharedOccupancy(SEGMENT_NAME, LOCK_NAME, STALE_AFTER) {}
+		SharedOccupancy(std::string segmentName, std::string lockName, std::chrono::milliseconds staleAfter)
+			: segmentName_(std::move(segmentName)), lockName_(std::move(lockName)), staleAfter_(staleAfter) {}
+		~SharedOccupancy() { disable(); }
+
+		// UI thread
+		bool enable() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (segment_.isOpen()) return true;
+			if (!segment_.open(segmentName_, SEGMENT_SIZE, false) || !leaderLock_.open(lockName_)) {
+				segment_.close();
+				return false;
+			}
+			return true;
+		}
+
+		// UI thread
+		void disable() {
+			resign();
+			std::lock_guard<std::mutex> lock(mutex_);
+			leaderLock_.close();
+			segment_.close();
+		}
+
+		bool enabled() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return segment_.isOpen();
+		}
+
+		// UI thread (the Win32 lock belongs to the thread taking it). True if this instance leads.
+		bool tryLead() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!segment_.isOpen()) return false;
+			if (!leaderLock_.locked() && leaderLock_.tryLock()) {
+				if (!segment_.setWritable(true)) {
+					leaderLock_.unlock();
+					segment_.close(); // unmapped, enable() again
+					return false;
+				}
+				++leaderships_;
+			}
+			leading_.store(leaderLock_.locked(), std::memory_order_release);
+			return leaderLock_.locked();
+		}
+
+		// UI thread: stop leading, e.g. when disconnected from the network
+		void resign() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			leading_.store(false, std::memory_order_release);
+			leaderLock_.unlock();
+			if (segment_.isOpen() && !segment_.setWritable(false)) segment_.close();
+		}
+
+		bool leading() const { return leading_.load(std::memory_order_acquire); }
+
+		// Leader poll thread: writes a decoded occupancy response
+		bool publish(const nlohmann::ordered_json& response) {
+			std::vector<Record> records;
+			std::string pool;
+			const bool received = response.is_object() && !response.empty();
+			if (received) {
+				forEachServerStand(response, [&](StandList list, std::string_view callsign, std::string_view name, std::string_view remark) {
+					Record record{};
+					record.list = static_cast<std::uint8_t>(list);
+					record.offset = static_cast<std::uint32_t>(pool.size());
+					record.callsignLength = clampLength(callsign);
+					record.nameLength = clampLength(name);
+					record.remarkLength = clampLength(remark);
+					pool.append(callsign.data(), record.callsignLength).append(name.data(), record.nameLength).append(remark.data(), record.remarkLength);
+					records.push_back(record);
+				});
+			}
+			const std::size_t bytes = records.size() * sizeof(Record) + pool.size();
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!segment_.writable() || !leading() || bytes > slotCapacity()) return false;
+			SegmentHeader& header = segmentHeader();
+			if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.layout != LAYOUT) {
+				header.layout = LAYOUT;
+				header.slotSize = static_cast<std::uint32_t>(slotCapacity());
+				std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+			}
+
+			// Write the slot readers are not using, then flip the version
+			const std::uint64_t version = header.version.load(std::memory_order_relaxed) + 1;
+			SlotHeader& slot = slotHeader(version);
+			const std::uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+			slot.sequence.store(sequence + 1, std::memory_order_relaxed); // odd: being written
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.version = version;
+			slot.publishedMs = nowMs();
+			slot.count = static_cast<std::uint32_t>(records.size());
+			slot.bytes = static_cast<std::uint32_t>(bytes);
+			slot.received = received ? 1 : 0;
+			std::uint8_t* payload = reinterpret_cast<std::uint8_t*>(&slot + 1);
+			if (!records.empty()) std::memcpy(payload, records.data(), records.size() * sizeof(Record));
+			if (!pool.empty()) std::memcpy(payload + records.size() * sizeof(Record), pool.data(), pool.size());
+			slot.sequence.store(sequence + 2, std::memory_order_release);
+
+			header.version.store(version, std::memory_order_release);
+			header.publishedMs.store(slot.publishedMs, std::memory_order_release);
+			++publishes_;
+			return true;
+		}
+
+		// Follower poll thread: passes each entry of the latest snapshot newer than seen to
+		// fn(StandList, callsign, name, remark); received/published describe that snapshot
+		template <typename Fn>
+		ReadResult read(std::uint64_t& seen, bool& received, std::chrono::system_clock::time_point& published, Fn&& fn) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (!segment_.isOpen()) return ReadResult::None;
+			const SegmentHeader& header = segmentHeader();
+			if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.layout != LAYOUT) return count(ReadResult::None);
+			if (nowMs() - header.publishedMs.load(std::memory_order_acquire) > staleAfter_.count()) return count(ReadResult::Stale);
+
+			for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+				const std::uint64_t version = header.version.load(std::memory_order_acquire);
+				if (version == 0) return count(ReadResult::None);
+				if (version == seen) return count(ReadResult::Unchanged);
+
+				const SlotHeader& slot = slotHeader(version);
+				const std::uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+				if ((sequence & 1) != 0 || slot.version != version) {
+					std::this_thread::yield(); // being rewritten, the header version moves on shortly
+					continue;
+				}
+				const std::uint32_t recordCount = slot.count;
+				const std::size_t bytes = slot.bytes;
+				const bool slotReceived = slot.received != 0;
+				const std::int64_t publishedMs = slot.publishedMs;
+				if (bytes > slotCapacity() || static_cast<std::size_t>(recordCount) * sizeof(Record) > bytes) continue;
+				copy_.resize(bytes);
+				std::memcpy(copy_.data(), &slot + 1, bytes);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue; // torn copy
+
+				// Consistent copy, decode it outside the shared memory
+				const std::uint8_t* pool = copy_.data() + recordCount * sizeof(Record);
+				const std::size_t poolSize = bytes - recordCount * sizeof(Record);
+				for (std::uint32_t i = 0; i < recordCount; ++i) {
+					Record record;
+					std::memcpy(&record, copy_.data() + i * sizeof(Record), sizeof(Record));
+					const std::size_t end = static_cast<std::size_t>(record.offset) + record.callsignLength + record.nameLength + record.remarkLength;
+					if (end > poolSize || record.list > static_cast<std::uint8_t>(StandList::Blocked)) continue;
+					const char* text = reinterpret_cast<const char*>(pool) + record.offset;
+					fn(static_cast<StandList>(record.list), std::string_view(text, record.callsignLength),
+						std::string_view(text + record.callsignLength, record.nameLength),
+						std::string_view(text + record.callsignLength + record.nameLength, record.remarkLength));
+				}
+				seen = version;
+				received = slotReceived;
+				published = std::chrono::system_clock::time_point(std::chrono::milliseconds(publishedMs));
+				return count(ReadResult::Read);
+			}
+			return count(ReadResult::Unchanged); // the leader kept rewriting, try on the next cycle
+		}
+
+		std::uint64_t publishes() const { return publishes_.load(std::memory_order_relaxed); }
+		std::uint64_t reads() const { return reads_.load(std::memory_order_relaxed); }
+		std::uint64_t fallbacks() const { return fallbacks_.load(std::memory_order_relaxed); }
+		std::uint64_t leaderships() const { return leaderships_.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr int MAX_READ_ATTEMPTS = 8;
+
+		struct SegmentHeader {
+			char magic[8];
+			std::uint32_t layout;
+			std::uint32_t slotSize;
+			std::atomic<std::uint64_t> version;    // latest complete snapshot, 0: none yet
+			std::atomic<std::int64_t> publishedMs; // leader heartbeat, Unix ms
+			std::uint8_t reserved[32];
+		};
+
+		struct SlotHeader {
+			std::atomic<std::uint32_t> sequence; // odd while being written
+			std::uint32_t count;                 // records
+			std::uint64_t version;
+			std::int64_t publishedMs;
+			std::uint32_t bytes;                 // records + pool
+			std::uint32_t received;              // 0: the leader got an empty response
+		};
+
+		struct Record {
+			std::uint8_t list;
+			std::uint8_t reserved;
+			std::uint16_t callsignLength;
+			std::uint16_t nameLength;
+			std::uint16_t remarkLength;
+			std::uint32_t offset; // callsign, name and remark, back to back in the pool
+		};
+
+		static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free, "shared memory needs lock-free atomics");
+		static_assert(sizeof(SegmentHeader) == 64 && sizeof(SlotHeader) == 32 && sizeof(Record) == 12, "shared layout changed, bump LAYOUT");
+
+		static constexpr std::size_t SLOT_SIZE = (SEGMENT_SIZE - sizeof(SegmentHeader)) / 2;
+
+		static std::uint16_t clampLength(std::string_view text) { return static_cast<std::uint16_t>(text.size() < 0xFFFF ? text.size() : 0xFFFF); }
+
+		static std::int64_t nowMs() {
+			return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		std::size_t slotCapacity() const { return SLOT_SIZE - sizeof(SlotHeader); }
+
+		SegmentHeader& segmentHeader() const { return *static_cast<SegmentHeader*>(segment_.data()); }
+
+		SlotHeader& slotHeader(std::uint64_t version) const {
+			std::uint8_t* base = static_cast<std::uint8_t*>(segment_.data()) + sizeof(SegmentHeader);
+			return *reinterpret_cast<SlotHeader*>(base + (version & 1) * SLOT_SIZE);
+		}
+
+		ReadResult count(ReadResult result) {
+			if (result == ReadResult::Read) ++reads_;
+			else if (result == ReadResult::Stale || result == ReadResult::None) ++fallbacks_;
+			return result;
+		}
+
+		const std::string segmentName_;
+		const std::string lockName_;
+		const std::chrono::milliseconds staleAfter_;
+		mutable std::mutex mutex_; // segment lifetime vs the poll thread
+		SharedMemory segment_;
+		NamedLock leaderLock_;
+		std::atomic<bool> leading_{ false };
+		std::vector<std::uint8_t> copy_; // read() scratch
+		std::atomic<std::uint64_t> publishes_{ 0 };
+		std::atomic<std::uint64_t> reads_{ 0 };
+		std::atomic<std::uint64_t> fallbacks_{ 0 };
+		std::atomic<std::uint64_t> leaderships_{ 0 };
+	};
+
+} // namespace rampAgent
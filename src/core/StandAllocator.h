@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/StandCatalogue.h"
+#include "core/StringTable.h"
+
+// Local stand proposals for inbound traffic while the server can't be reached.
+// Each airport's catalogue is compiled once into compact slots (accepted size codes, Schengen
+// flag, operators allowed by Use). Flights are served nearest first; each gets the free stand that
+// satisfies every hard constraint with the best score: a stand reserved for its operator, then the
+// tightest size fit, then natural stand order. A flight keeps last cycle's proposal while it stays
+// valid, so tags don't move around between cycles. UI thread only.
+
+namespace rampAgent {
+
+	// ICAO aerodrome reference code letter (wingspan) of an aircraft type, from its wake
+	// category if the type isn't listed
+	inline char aircraftSizeCode(std::string_view type, char wtc) {
+		static constexpr std::pair<std::string_view, char> TYPES[] = {
+			{ "A124", 'F' }, { "A19N", 'C' }, { "A20N", 'C' }, { "A21N", 'C' }, { "A306", 'D' }, { "A310", 'D' }, { "A318", 'C' }, { "A319", 'C' },
+			{ "A320", 'C' }, { "A321", 'C' }, { "A332", 'E' }, { "A333", 'E' }, { "A338", 'E' }, { "A339", 'E' }, { "A343", 'E' }, { "A346", 'E' },
+			{ "A359", 'E' }, { "A35K", 'E' }, { "A388", 'F' }, { "A400", 'D' }, { "AT43", 'C' }, { "AT45", 'C' }, { "AT72", 'C' }, { "AT75", 'C' },
+			{ "AT76", 'C' }, { "B190", 'B' }, { "B38M", 'C' }, { "B39M", 'C' }, { "B737", 'C' }, { "B738", 'C' }, { "B739", 'C' }, { "B744", 'E' },
+			{ "B748", 'F' }, { "B752", 'D' }, { "B753", 'D' }, { "B763", 'D' }, { "B764", 'D' }, { "B772", 'E' }, { "B77L", 'E' }, { "B77W", 'E' },
+			{ "B788", 'E' }, { "B789", 'E' }, { "B78X", 'E' }, { "BCS1", 'C' }, { "BCS3", 'C' }, { "BE20", 'B' }, { "C130", 'D' }, { "C172", 'A' },
+			{ "C525", 'A' }, { "C56X", 'B' }, { "C68A", 'B' }, { "CL35", 'B' }, { "CL60", 'B' }, { "CRJ2", 'B' }, { "CRJ7", 'B' }, { "CRJ9", 'C' },
+			{ "CRJX", 'C' }, { "DH8D", 'C' }, { "DR40", 'A' }, { "E135", 'B' }, { "E145", 'B' }, { "E170", 'C' }, { "E190", 'C' }, { "E195", 'C' },
+			{ "E290", 'C' }, { "E295", 'C' }, { "E55P", 'B' }, { "E75L", 'C' }, { "F100", 'C' }, { "F2TH", 'B' }, { "F70", 'C' }, { "F900", 'B' },
+			{ "FA7X", 'C' }, { "FA8X", 'C' }, { "GLEX", 'C' }, { "GLF5", 'C' }, { "GLF6", 'C' }, { "LJ45", 'A' }, { "MD11", 'D' }, { "PA28", 'A' },
+			{ "PC12", 'B' }, { "PC24", 'B' }, { "SB20", 'C' }, { "SF34", 'B' }, { "SR22", 'A' }, { "TBM7", 'A' }, { "TBM9", 'A' },
+		};
+		static_assert(std::is_sorted(std::begin(TYPES), std::end(TYPES)), "keep TYPES sorted");
+
+		const auto it = std::lower_bound(std::begin(TYPES), std::end(TYPES), type, [](const auto& entry, std::string_view key) { return entry.first < key; });
+		if (it != std::end(TYPES) && it->first == type) return it->second;
+		switch (wtc) {
+		case 'L': return 'B';
+		case 'H': return 'E';
+		case 'J': return 'F';
+		default: return 'C';
+		}
+	}
+
+	// Airports of the Schengen area, by ICAO country prefix
+	inline bool isSchengenAirport(std::string_view icao) {
+		static constexpr std::string_view PREFIXES[] = {
+			"BI", "EB", "ED", "EE", "EF", "EH", "EK", "EL", "EN", "EP", "ES", "ET", "EV", "EY", "GC",
+			"LB", "LD", "LE", "LF", "LG", "LH", "LI", "LJ", "LK", "LM", "LO", "LP", "LR", "LS", "LZ",
+		};
+		if (icao.size() != 4) return false;
+		return std::binary_search(std::begin(PREFIXES), std::end(PREFIXES), icao.substr(0, 2));
+	}
+
+	// "AFR" -> 'A' << 16 | 'F' << 8 | 'R', upper-cased; 0 unless 3 letters
+	inline std::uint32_t packAirline(std::string_view designator) {
+		if (designator.size() != 3) return 0;
+		std::uint32_t code = 0;
+		for (char c : designator) {
+			c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+			if (c < 'A' || c > 'Z') return 0;
+			code = code << 8 | static_cast<std::uint8_t>(c);
+		}
+		return code;
+	}
+
+	// "AFR123" -> packed "AFR", 0 unless the callsign is an airline designator and flight number
+	inline std::uint32_t airlineOf(std::string_view callsign) {
+		if (callsign.size() < 4 || callsign[3] < '0' || callsign[3] > '9') return 0;
+		return packAirline(callsign.substr(0, 3));
+	}
+
+	struct InboundFlight {
+		CallsignId callsign = EMPTY_ID;
+		char sizeCode = 'C';       // aircraftSizeCode
+		std::uint32_t airline = 0; // airlineOf
+		bool schengen = false;     // from a Schengen airport
+		double distance = 0.0;     // to the destination, nearest served first
+	};
+
+	class StandAllocator {
+	public:
+		struct Proposal {
+			CallsignId callsign;
+			StandId stand;
+		};
+
+		// Proposes a stand to each flight bound for catalogue's airport, skipping stands for which
+		// unavailable(StandId) is true. previous: last cycle's proposals, kept while still valid.
+		// Flights without a possible stand get none. Appends to out; flights are reordered.
+		template <typename Unavailable>
+		void allocate(const std::shared_ptr<const StandCatalogue>& catalogue, std::vector<InboundFlight>& flights, Unavailable&& unavailable, const IdMap<StandId>& previous, std::vector<Proposal>& out) {
+			const Layout& layout = prepare(catalogue);
+			taken_.assign(layout.slots.size(), 0);
+			for (std::uint32_t i = 0; i < layout.slots.size(); ++i) {
+				if (unavailable(layout.slots[i].stand)) taken_[i] = 1;
+			}
+			std::sort(flights.begin(), flights.end(), [](const InboundFlight& a, const InboundFlight& b) { return a.distance < b.distance; });
+
+			// Last cycle's proposals first, nearest flight wins a contested stand
+			pending_.clear();
+			for (const InboundFlight& flight : flights) {
+				const StandId* kept = previous.find(flight.callsign);
+				const std::uint32_t* slot = kept != nullptr ? layout.slotOf.find(*kept) : nullptr;
+				if (slot != nullptr && !taken_[*slot] && accepts(layout, layout.slots[*slot], flight)) {
+					taken_[*slot] = 1;
+					out.push_back({ flight.callsign, layout.slots[*slot].stand });
+					++kept_;
+				}
+				else {
+					pending_.push_back(&flight);
+				}
+			}
+
+			for (const InboundFlight* flight : pending_) {
+				std::uint32_t best = NONE;
+				std::uint32_t bestScore = 0;
+				for (std::uint32_t i = 0; i < layout.slots.size(); ++i) {
+					const Slot& slot = layout.slots[i];
+					if (taken_[i] || !accepts(layout, slot, *flight)) continue;
+					const std::uint32_t score = (slot.airlineCount != 0 ? 0u : 1u << 24) | static_cast<std::uint32_t>(slot.maxCode - flight->sizeCode) << 16 | i;
+					if (best == NONE || score < bestScore) {
+						best = i;
+						bestScore = score;
+					}
+				}
+				if (best == NONE) {
+					++unplaced_;
+					continue;
+				}
+				taken_[best] = 1;
+				out.push_back({ flight->callsign, layout.slots[best].stand });
+				++placed_;
+			}
+		}
+
+		std::uint64_t placed() const { return placed_; }     // new proposals
+		std::uint64_t kept() const { return kept_; }         // proposals carried over a cycle
+		std::uint64_t unplaced() const { return unplaced_; } // flights without a possible stand
+
+	private:
+		static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+		struct Slot {
+			StandId stand;
+			std::uint8_t sizeMask;     // bit n: code 'A' + n accepted
+			char maxCode;              // largest accepted code
+			bool schengen;
+			std::uint16_t airlineBegin; // operators allowed by Use, in Layout::airlines
+			std::uint16_t airlineCount; // 0: open to every operator
+		};
+
+		struct Layout {
+			std::shared_ptr<const StandCatalogue> catalogue; // keeps the pointer identity valid
+			std::vector<Slot> slots;                          // catalogue (natural) order
+			std::vector<std::uint32_t> airlines;
+			IdMap<std::uint32_t> slotOf;
+			bool zoned = false; // some stand is Schengen: zones are a constraint
+		};
+
+		static bool accepts(const Layout& layout, const Slot& slot, const InboundFlight& flight) {
+			if ((slot.sizeMask & (1u << (flight.sizeCode - 'A'))) == 0) return false;
+			if (layout.zoned && slot.schengen != flight.schengen) return false;
+			if (slot.airlineCount == 0) return true;
+			const auto begin = layout.airlines.begin() + slot.airlineBegin;
+			return std::find(begin, begin + slot.airlineCount, flight.airline) != begin + slot.airlineCount;
+		}
+
+		const Layout& prepare(const std::shared_ptr<const StandCatalogue>& catalogue) {
+			Layout& layout = layouts_[catalogue->airport];
+			if (layout.catalogue == catalogue) return layout;
+
+			layout = Layout();
+			layout.catalogue = catalogue;
+			for (std::uint32_t i = 0; i < catalogue->stands.size(); ++i) {
+				const StandInfo& stand = catalogue->stands[i];
+				Slot slot{ stand.name, 0, 'A', stand.schengen, static_cast<std::uint16_t>(layout.airlines.size()), 0 };
+				for (char c : stand.code) {
+					if (c >= 'a' && c <= 'f') c = static_cast<char>(c - 'a' + 'A');
+					if (c < 'A' || c > 'F') continue;
+					slot.sizeMask |= static_cast<std::uint8_t>(1u << (c - 'A'));
+					slot.maxCode = (std::max)(slot.maxCode, c);
+				}
+				if (slot.sizeMask == 0) {
+					slot.sizeMask = 0x3F; // no code: any size
+					slot.maxCode = 'F';
+				}
+				// Use: ICAO designators among its words ("AFR HOP", "AFR/CCM") restrict the stand to
+				// them; other words ("CARGO", "GA") are labels
+				std::size_t word = 0;
+				while (word < stand.use.size()) {
+					std::size_t end = word;
+					while (end < stand.use.size() && std::isalnum(static_cast<unsigned char>(stand.use[end]))) ++end;
+					if (const std::uint32_t airline = packAirline(std::string_view(stand.use).substr(word, end - word)); airline != 0) {
+						layout.airlines.push_back(airline);
+						++slot.airlineCount;
+					}
+					word = end + 1;
+				}
+				layout.zoned = layout.zoned || stand.schengen;
+				layout.slotOf[stand.name] = i;
+				layout.slots.push_back(slot);
+			}
+			return layout;
+		}
+
+		std::unordered_map<AirportId, Layout> layouts_; // rebuilt when the airport's catalogue is replaced
+		std::vector<std::uint8_t> taken_;                 // allocate() scratch
+		std::vector<const InboundFlight*> pending_;
+		std::uint64_t placed_ = 0;
+		std::uint64_t kept_ = 0;
+		std::uint64_t unplaced_ = 0;
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,376 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "core/StandTables.h"
+#include "core/StringTable.h"
+
+// Per-airport stand catalogue (names, attributes, coordinates) parsed once from
+// /api/airports/{icao}/stands, kept in natural stand order, with a uniform-grid spatial index
+// for nearest-stand queries.
+
+namespace rampAgent {
+
+	// Natural stand order: 2, 2A, 2B, 3A, ..., 10, then names without a numeric prefix
+	inline bool standNameLess(std::string_view a, std::string_view b)
+	{
+		auto key = [](std::string_view s) {
+			size_t i = 0, n = s.size();
+
+			// Trim leading spaces
+			while (i < n && std::isspace(static_cast<unsigned char>(s[i]))) ++i;
+
+			// Leading number
+			int num = 0;
+			bool hasNum = false;
+			while (i < n && std::isdigit(static_cast<unsigned char>(s[i]))) {
+				hasNum = true;
+				int digit = s[i] - '0';
+				if (num > ((std::numeric_limits<int>::max)() - digit) / 10)
+					num = (std::numeric_limits<int>::max)(); // clamp overflow
+				else
+					num = num * 10 + digit;
+				++i;
+			}
+
+			// Immediate letter suffix (A, B, AB, ...)
+			std::string letters;
+			while (i < n && std::isalpha(static_cast<unsigned char>(s[i]))) {
+				letters.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(s[i]))));
+				++i;
+			}
+
+			// Remainder (case-insensitive)
+			std::string tailUpper;
+			tailUpper.reserve(n - i);
+			for (; i < n; ++i) {
+				unsigned char c = static_cast<unsigned char>(s[i]);
+				tailUpper.push_back(static_cast<char>(std::toupper(c)));
+			}
+
+			// Bare names (no numeric prefix) go to the end
+			return std::tuple<int, std::string, std::string, std::string_view>(
+				hasNum ? num : (std::numeric_limits<int>::max)(), letters, tailUpper, s
+			);
+			};
+
+		const auto [an, al, ar, as] = key(a);
+		const auto [bn, bl, br, bs] = key(b);
+
+		if (an != bn) return an < bn;
+
+		// If numbers equal, empty suffix (e.g., "2") comes before "2A"
+		if (al != bl) {
+			if (al.empty() != bl.empty()) return al.empty();
+			return al < bl;
+		}
+
+		// Fallback: remainder, then original
+		if (ar != br) return ar < br;
+		return as < bs;
+	}
+
+	struct StandInfo {
+		StandId name = EMPTY_ID;
+		double latitude = 0.0;
+		double longitude = 0.0;
+		double radius = 0.0;     // metres, 0 if unknown
+		bool hasPosition = false;
+		std::string code;        // accepted aircraft size codes, e.g. "ABC"
+		std::string use;         // operator/usage restriction
+		bool schengen = false;
+	};
+
+	// Uniform grid over a local equirectangular projection, cells of CELL_SIZE_M metres.
+	// Stand positions are stored in a compressed cell -> items layout so a query touches
+	// only the few cells around the query point.
+	class StandSpatialIndex {
+	public:
+		static constexpr double CELL_SIZE_M = 100.0;
+		static constexpr double EARTH_RADIUS_M = 6371000.0;
+
+		void build(const std::vector<StandInfo>& stands) {
+			points_.clear();
+			cellStart_.clear();
+			items_.clear();
+
+			std::vector<std::uint32_t> located;
+			double latSum = 0.0, lonSum = 0.0;
+			for (std::uint32_t i = 0; i < stands.size(); ++i) {
+				if (!stands[i].hasPosition) continue;
+				located.push_back(i);
+				latSum += stands[i].latitude;
+				lonSum += stands[i].longitude;
+			}
+			if (located.empty()) return;
+
+			originLat_ = latSum / static_cast<double>(located.size());
+			originLon_ = lonSum / static_cast<double>(located.size());
+			cosLat_ = std::cos(originLat_ * PI / 180.0);
+
+			double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+			points_.resize(stands.size(), { 0.0, 0.0 });
+			for (std::size_t n = 0; n < located.size(); ++n) {
+				const auto [x, y] = project(stands[located[n]].latitude, stands[located[n]].longitude);
+				points_[located[n]] = { x, y };
+				minX = n ? (std::min)(minX, x) : x;
+				minY = n ? (std::min)(minY, y) : y;
+				maxX = n ? (std::max)(maxX, x) : x;
+				maxY = n ? (std::max)(maxY, y) : y;
+			}
+			minX_ = minX;
+			minY_ = minY;
+			cols_ = static_cast<int>((maxX - minX) / CELL_SIZE_M) + 1;
+			rows_ = static_cast<int>((maxY - minY) / CELL_SIZE_M) + 1;
+
+			// Counting sort of stands into cells
+			cellStart_.assign(static_cast<std::size_t>(cols_) * rows_ + 1, 0);
+			for (std::uint32_t i : located) ++cellStart_[cellOf(i) + 1];
+			for (std::size_t c = 1; c < cellStart_.size(); ++c) cellStart_[c] += cellStart_[c - 1];
+			items_.resize(located.size());
+			std::vector<std::uint32_t> fill(cellStart_.begin(), cellStart_.end() - 1);
+			for (std::uint32_t i : located) items_[fill[cellOf(i)]++] = i;
+		}
+
+		bool empty() const { return items_.empty(); }
+
+		// Cheap rejection of positions away from this airport
+		bool withinBounds(double latitude, double longitude, double marginM) const {
+			if (items_.empty()) return false;
+			const auto [x, y] = project(latitude, longitude);
+			return x >= minX_ - marginM && y >= minY_ - marginM
+				&& x <= minX_ + cols_ * CELL_SIZE_M + marginM && y <= minY_ + rows_ * CELL_SIZE_M + marginM;
+		}
+
+		// Indices of the k nearest stands accepted by the filter, closest first
+		template <typename Filter>
+		std::vector<std::uint32_t> nearest(double latitude, double longitude, std::size_t k, Filter&& accept) const {
+			std::vector<std::pair<double, std::uint32_t>> best; // (squared distance, index)
+			if (items_.empty() || k == 0) return {};
+
+			// Rings around the query's cell, or the nearest grid cell when the query is off the grid
+			const auto [qx, qy] = project(latitude, longitude);
+			const int qc = std::clamp(static_cast<int>(std::floor((qx - minX_) / CELL_SIZE_M)), 0, cols_ - 1);
+			const int qr = std::clamp(static_cast<int>(std::floor((qy - minY_) / CELL_SIZE_M)), 0, rows_ - 1);
+			const int maxRing = (std::max)({ qc, cols_ - 1 - qc, qr, rows_ - 1 - qr }); // < max(rows_, cols_)
+
+			for (int ring = 0; ring <= maxRing; ++ring) {
+				const int c0 = (std::max)(qc - ring, 0), c1 = (std::min)(qc + ring, cols_ - 1);
+				const int r0 = (std::max)(qr - ring, 0), r1 = (std::min)(qr + ring, rows_ - 1);
+				for (int r = r0; r <= r1; ++r) {
+					if (r == qr - ring || r == qr + ring) {
+						for (int c = c0; c <= c1; ++c) visitCell(static_cast<std::size_t>(r) * cols_ + c, qx, qy, k, best, accept);
+					}
+					else {
+						if (qc - ring >= 0) visitCell(static_cast<std::size_t>(r) * cols_ + qc - ring, qx, qy, k, best, accept);
+						if (qc + ring < cols_) visitCell(static_cast<std::size_t>(r) * cols_ + qc + ring, qx, qy, k, best, accept);
+					}
+				}
+				// Stands not visited yet lie past a side of the square that still has grid beyond it
+				if (best.size() == k) {
+					double bound = std::numeric_limits<double>::infinity();
+					if (c0 > 0) bound = (std::min)(bound, qx - (minX_ + c0 * CELL_SIZE_M));
+					if (c1 < cols_ - 1) bound = (std::min)(bound, minX_ + (c1 + 1) * CELL_SIZE_M - qx);
+					if (r0 > 0) bound = (std::min)(bound, qy - (minY_ + r0 * CELL_SIZE_M));
+					if (r1 < rows_ - 1) bound = (std::min)(bound, minY_ + (r1 + 1) * CELL_SIZE_M - qy);
+					if (bound == std::numeric_limits<double>::infinity()) break;
+					if (bound > 0.0 && best.back().first <= bound * bound) break;
+				}
+			}
+
+			std::vector<std::uint32_t> result;
+			result.reserve(best.size());
+			for (const auto& [distance, index] : best) result.push_back(index);
+			return result;
+		}
+
+		// Squared distance in metres between a position and an indexed stand
+		double distanceSquared(std::uint32_t index, double latitude, double longitude) const {
+			const auto [x, y] = project(latitude, longitude);
+			const double dx = points_[index].first - x, dy = points_[index].second - y;
+			return dx * dx + dy * dy;
+		}
+
+		std::size_t memoryBytes() const {
+			return points_.capacity() * sizeof(points_[0]) + cellStart_.capacity() * sizeof(std::uint32_t) + items_.capacity() * sizeof(std::uint32_t);
+		}
+
+	private:
+		static constexpr double PI = 3.14159265358979323846;
+
+		std::pair<double, double> project(double latitude, double longitude) const {
+			return { (longitude - originLon_) * PI / 180.0 * EARTH_RADIUS_M * cosLat_, (latitude - originLat_) * PI / 180.0 * EARTH_RADIUS_M };
+		}
+
+		std::size_t cellOf(std::uint32_t index) const {
+			const int c = (std::min)(static_cast<int>((points_[index].first - minX_) / CELL_SIZE_M), cols_ - 1);
+			const int r = (std::min)(static_cast<int>((points_[index].second - minY_) / CELL_SIZE_M), rows_ - 1);
+			return static_cast<std::size_t>(r) * cols_ + c;
+		}
+
+		template <typename Filter>
+		void visitCell(std::size_t cell, double qx, double qy, std::size_t k, std::vector<std::pair<double, std::uint32_t>>& best, Filter& accept) const {
+			for (std::uint32_t n = cellStart_[cell]; n < cellStart_[cell + 1]; ++n) {
+				const std::uint32_t index = items_[n];
+				const double dx = points_[index].first - qx, dy = points_[index].second - qy;
+				const double d = dx * dx + dy * dy;
+				if (best.size() == k && d >= best.back().first) continue;
+				if (!accept(index)) continue;
+				auto pos = std::upper_bound(best.begin(), best.end(), std::make_pair(d, index));
+				best.insert(pos, { d, index });
+				if (best.size() > k) best.pop_back();
+			}
+		}
+
+		double originLat_ = 0.0, originLon_ = 0.0, cosLat_ = 1.0;
+		double minX_ = 0.0, minY_ = 0.0;
+		int cols_ = 0, rows_ = 0;
+		std::vector<std::pair<double, double>> points_; // projected metres, by stand index
+		std::vector<std::uint32_t> cellStart_;
+		std::vector<std::uint32_t> items_;
+	};
+
+	struct StandCatalogue {
+		AirportId airport = EMPTY_ID;
+		std::vector<StandInfo> stands;
+		StandSpatialIndex index;
+		std::chrono::system_clock::time_point fetched; // wall clock, persisted in the disk cache
+
+		// Position of a stand by name, nullptr if unknown or not located
+		const StandInfo* find(StandId name) const {
+			for (const auto& stand : stands) {
+				if (stand.name == name) return &stand;
+			}
+			return nullptr;
+		}
+
+		// Accepts "Coordinates": "lat:lon[:radius]" as well as numeric lat/lon fields
+		static std::shared_ptr<StandCatalogue> fromJson(AirportId airport, const nlohmann::ordered_json& json, StringTable& standNames) {
+			return fromJson(airport, json, standNames, [&standNames](std::string_view name) { return standNames.intern(name); });
+		}
+
+		// nameId gives the StandId of a name, e.g. StaticStandIds::resolve for the airport
+		static std::shared_ptr<StandCatalogue> fromJson(AirportId airport, const nlohmann::ordered_json& json, const StringTable& standNames, const std::function<StandId(std::string_view)>& nameId) {
+			auto catalogue = std::make_shared<StandCatalogue>();
+			catalogue->airport = airport;
+			catalogue->fetched = std::chrono::system_clock::now();
+			if (!json.is_object()) return catalogue;
+
+			for (const auto& [name, data] : json.items()) {
+				StandInfo stand;
+				stand.name = nameId(name);
+				if (data.is_object()) {
+					if (auto it = data.find("Coordinates"); it != data.end() && it->is_string()) {
+						parseCoordinates(it->get_ref<const std::string&>(), stand);
+					}
+					else {
+						readNumber(data, { "lat", "latitude" }, stand.latitude, stand.hasPosition);
+						bool hasLon = false;
+						readNumber(data, { "lon", "lng", "longitude" }, stand.longitude, hasLon);
+						stand.hasPosition = stand.hasPosition && hasLon;
+					}
+					if (auto it = data.find("Code"); it != data.end() && it->is_string()) stand.code = it->get<std::string>();
+					if (auto it = data.find("Use"); it != data.end() && it->is_string()) stand.use = it->get<std::string>();
+					if (auto it = data.find("Schengen"); it != data.end() && it->is_boolean()) stand.schengen = it->get<bool>();
+				}
+				catalogue->stands.push_back(std::move(stand));
+			}
+			catalogue->finalize(standNames);
+			return catalogue;
+		}
+
+		// From the built-in tables (StandTables.h). fetched is left at the epoch: the catalogue is
+		// stale from the start and replaced by the server's as soon as it can be fetched. ids holds the
+		// names of the table the stands come from (StaticStandIds).
+		template <typename Ids>
+		static std::shared_ptr<StandCatalogue> fromStatic(AirportId airport, std::span<const StaticStand> stands, const Ids& ids, const StringTable& standNames) {
+			auto catalogue = std::make_shared<StandCatalogue>();
+			catalogue->airport = airport;
+			catalogue->stands.reserve(stands.size());
+			for (const StaticStand& entry : stands) {
+				StandInfo stand;
+				stand.name = ids.id(entry);
+				stand.hasPosition = entry.hasPosition;
+				stand.latitude = entry.latitude;
+				stand.longitude = entry.longitude;
+				stand.radius = entry.radius;
+				stand.code = entry.code;
+				stand.use = entry.use;
+				stand.schengen = entry.schengen;
+				catalogue->stands.push_back(std::move(stand));
+			}
+			catalogue->finalize(standNames);
+			return catalogue;
+		}
+
+		// Rows in the data/stands.csv format, fields the format can't carry are blanked
+		void writeCsv(std::ostream& out, std::string_view icao, const StringTable& standNames) const {
+			auto field = [](std::string_view text) {
+				std::string clean(text);
+				for (char& c : clean) {
+					if (c == ',' || c == '"' || c == '\\' || c == '\n' || c == '\r') c = ' ';
+				}
+				return clean;
+			};
+			const std::ios::fmtflags flags = out.flags();
+			const std::streamsize precision = out.precision();
+			out << std::fixed;
+			for (const StandInfo& stand : stands) {
+				out << icao << ',' << field(standNames.view(stand.name)) << ',';
+				if (stand.hasPosition) out << std::setprecision(7) << stand.latitude << ',' << stand.longitude << ',';
+				else out << ",,";
+				if (stand.radius > 0.0) out << std::setprecision(1) << stand.radius;
+				out << ',' << field(stand.code) << ',' << field(stand.use) << ',' << (stand.schengen ? 1 : 0) << '\n';
+			}
+			out.flags(flags);
+			out.precision(precision);
+		}
+
+		// Puts stands in natural order, which is then also the menu order, and builds the index
+		void finalize(const StringTable& standNames) {
+			std::sort(stands.begin(), stands.end(), [&](const StandInfo& a, const StandInfo& b) {
+				return standNameLess(standNames.view(a.name), standNames.view(b.name));
+			});
+			index.build(stands);
+		}
+
+	private:
+		static void parseCoordinates(const std::string& text, StandInfo& stand) {
+			char* end = nullptr;
+			const double latitude = std::strtod(text.c_str(), &end);
+			if (end == nullptr || *end != ':') return;
+			const double longitude = std::strtod(end + 1, &end);
+			if (end != nullptr && *end == ':') stand.radius = std::strtod(end + 1, nullptr);
+			stand.latitude = latitude;
+			stand.longitude = longitude;
+			stand.hasPosition = true;
+		}
+
+		static void readNumber(const nlohmann::ordered_json& data, std::initializer_list<const char*> keys, double& value, bool& found) {
+			for (const char* key : keys) {
+				if (auto it = data.find(key); it != data.end() && it->is_number()) {
+					value = it->get<double>();
+					found = true;
+					return;
+				}
+			}
+		}
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,238 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "core/StringTable.h"
+
+// Stand layouts compiled into the plugin.
+// data/stands.csv is turned into constexpr tables (StandData.h, generated at configure time by
+// cmake/StandData.cmake). Airports are keyed by their ICAO code packed into a uint32_t and found
+// through a seeded perfect hash; stands are keyed by (airport, name) through a hash-and-
+// displace perfect hash. Both are built by the compiler, so a lookup is one hash and one compare,
+// and a stand is identified by its dense index in the table. The tables are the catalogue of last
+// resort when the API can't be reached, and the fast path from a stand name to its StandId.
+
+namespace rampAgent {
+
+	// "LFPG" -> 'L' << 24 | 'F' << 16 | 'P' << 8 | 'G', upper-cased; 0 unless 4 letters or digits
+	constexpr std::uint32_t packIcao(std::string_view icao) {
+		if (icao.size() != 4) return 0;
+		std::uint32_t code = 0;
+		for (char c : icao) {
+			if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+			if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) return 0;
+			code = code << 8 | static_cast<std::uint8_t>(c);
+		}
+		return code;
+	}
+
+	constexpr std::uint32_t FRENCH_AIRPORTS = packIcao("LF00") & 0xFFFF0000u; // stand assignment is offered for LF** only
+
+	constexpr bool isFrenchAirport(std::uint32_t icao) { return (icao & 0xFFFF0000u) == FRENCH_AIRPORTS; }
+
+	struct StaticStand {
+		std::uint32_t airport; // packIcao
+		std::string_view name;
+		bool hasPosition;
+		double latitude;
+		double longitude;
+		double radius;         // metres, 0 if unknown
+		std::string_view code; // accepted aircraft size codes
+		std::string_view use;
+		bool schengen;
+	};
+
+	// N stands grouped by airport, A distinct airports
+	template <std::size_t N, std::size_t A>
+	class StaticStandTable {
+	public:
+		static constexpr std::uint32_t NOT_FOUND = 0xFFFFFFFFu;
+
+		constexpr explicit StaticStandTable(const std::array<StaticStand, N>& stands) : stands_(stands.data()) {
+			slots_.fill(NOT_FOUND);
+			buildAirports();
+			buildStands();
+		}
+
+		// Dense index of the stand, NOT_FOUND if not in the table
+		constexpr std::uint32_t find(std::uint32_t airport, std::string_view name) const {
+			if constexpr (N == 0) {
+				return NOT_FOUND;
+			}
+			else {
+				const std::uint64_t key = keyHash(airport, name);
+				const std::uint32_t index = slots_[mix(key, seeds_[mix(key, 0) % BUCKETS]) & (SLOTS - 1)];
+				if (index == NOT_FOUND || stands_[index].airport != airport || stands_[index].name != name) return NOT_FOUND;
+				return index;
+			}
+		}
+
+		// Stands of an airport, empty if it has none in the table
+		constexpr std::span<const StaticStand> airport(std::uint32_t icao) const {
+			if constexpr (A == 0) {
+				return {};
+			}
+			else {
+				const Airport& entry = airports_[mix(icao, airportSeed_) & (AIRPORT_SLOTS - 1)];
+				if (entry.count == 0 || entry.icao != icao) return {};
+				return { stands_ + entry.first, entry.count };
+			}
+		}
+
+		constexpr const StaticStand& operator[](std::uint32_t index) const { return stands_[index]; }
+		constexpr std::uint32_t indexOf(const StaticStand& stand) const { return static_cast<std::uint32_t>(&stand - stands_); }
+		static constexpr std::size_t size() { return N; }
+		static constexpr std::size_t airportCount() { return A; }
+
+	private:
+		struct Airport {
+			std::uint32_t icao = 0;
+			std::uint32_t first = 0;
+			std::uint32_t count = 0;
+		};
+
+		static constexpr std::size_t SLOTS = std::bit_ceil(N * 2 + 1);
+		static constexpr std::size_t BUCKETS = N / 2 + 1;
+		static constexpr std::size_t AIRPORT_SLOTS = std::bit_ceil(A * 4 + 1);
+		static constexpr std::uint32_t MAX_SEED = 1u << 16; // far beyond what the tables need
+
+		// 64-bit FNV-1a of the key, hashed once; seeds only remix it
+		static constexpr std::uint64_t keyHash(std::uint32_t airport, std::string_view name) {
+			std::uint64_t h = 14695981039346656037ull;
+			for (int shift = 24; shift >= 0; shift -= 8) {
+				h ^= (airport >> shift) & 0xFFu;
+				h *= 1099511628211ull;
+			}
+			for (char c : name) {
+				h ^= static_cast<std::uint8_t>(c);
+				h *= 1099511628211ull;
+			}
+			return h;
+		}
+
+		// splitmix64 finalizer
+		static constexpr std::uint32_t mix(std::uint64_t h, std::uint32_t seed) {
+			h ^= seed * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 30;
+			h *= 0xBF58476D1CE4E5B9ull;
+			h ^= h >> 27;
+			h *= 0x94D049BB133111EBull;
+			h ^= h >> 31;
+			return static_cast<std::uint32_t>(h);
+		}
+
+		// Ranges of consecutive stands per airport, then the first seed without collisions
+		constexpr void buildAirports() {
+			std::array<Airport, A + 1> ranges{};
+			std::size_t count = 0;
+			for (std::uint32_t i = 0; i < N; ++i) {
+				if (count == 0 || ranges[count - 1].icao != stands_[i].airport) {
+					if (count == A) throw std::logic_error("stand table: more airports than declared, or not grouped by airport");
+					ranges[count++] = { stands_[i].airport, i, 0 };
+				}
+				++ranges[count - 1].count;
+			}
+			if (count != A) throw std::logic_error("stand table: fewer airports than declared");
+
+			for (std::uint32_t seed = 0; seed < MAX_SEED; ++seed) {
+				airports_.fill({});
+				bool placed = true;
+				for (std::size_t a = 0; a < count && placed; ++a) {
+					Airport& slot = airports_[mix(ranges[a].icao, seed) & (AIRPORT_SLOTS - 1)];
+					placed = slot.count == 0;
+					slot = ranges[a];
+				}
+				if (!placed) continue;
+				airportSeed_ = seed;
+				return;
+			}
+			throw std::logic_error("stand table: no perfect hash for the airports");
+		}
+
+		// Hash and displace: buckets, largest first, each get the first seed sending all their keys
+		// to free slots
+		constexpr void buildStands() {
+			std::array<std::uint64_t, N + 1> keys{};
+			for (std::uint32_t i = 0; i < N; ++i) keys[i] = keyHash(stands_[i].airport, stands_[i].name);
+
+			std::array<std::uint32_t, BUCKETS + 1> start{};
+			for (std::uint32_t i = 0; i < N; ++i) ++start[mix(keys[i], 0) % BUCKETS + 1];
+			for (std::size_t b = 1; b <= BUCKETS; ++b) start[b] += start[b - 1];
+			std::array<std::uint32_t, N + 1> members{};
+			std::array<std::uint32_t, BUCKETS + 1> fill = start;
+			for (std::uint32_t i = 0; i < N; ++i) members[fill[mix(keys[i], 0) % BUCKETS]++] = i;
+
+			std::uint32_t largest = 0;
+			for (std::size_t b = 0; b < BUCKETS; ++b) largest = (std::max)(largest, start[b + 1] - start[b]);
+
+			for (std::uint32_t size = largest; size > 0; --size) {
+				for (std::uint32_t bucket = 0; bucket < BUCKETS; ++bucket) {
+					const std::uint32_t begin = start[bucket], end = start[bucket + 1];
+					if (end - begin != size) continue;
+					for (std::uint32_t m = begin; m < end; ++m) {
+						for (std::uint32_t other = begin; other < m; ++other) {
+							if (keys[members[m]] == keys[members[other]]) throw std::logic_error("stand table: duplicate stand"); // no seed separates them
+						}
+					}
+					std::uint32_t seed = 1;
+					for (; seed < MAX_SEED; ++seed) {
+						if (fits(keys, members, begin, end, seed)) break;
+					}
+					if (seed == MAX_SEED) throw std::logic_error("stand table: no perfect hash for the stands");
+					seeds_[bucket] = seed;
+					for (std::uint32_t m = begin; m < end; ++m) slots_[mix(keys[members[m]], seed) & (SLOTS - 1)] = members[m];
+				}
+			}
+		}
+
+		// All members land in free, distinct slots with this seed
+		constexpr bool fits(const std::array<std::uint64_t, N + 1>& keys, const std::array<std::uint32_t, N + 1>& members, std::uint32_t begin, std::uint32_t end, std::uint32_t seed) const {
+			for (std::uint32_t m = begin; m < end; ++m) {
+				const std::uint32_t slot = mix(keys[members[m]], seed) & (SLOTS - 1);
+				if (slots_[slot] != NOT_FOUND) return false;
+				for (std::uint32_t other = begin; other < m; ++other) {
+					if ((mix(keys[members[other]], seed) & (SLOTS - 1)) == slot) return false;
+				}
+			}
+			return true;
+		}
+
+		const StaticStand* stands_;
+		std::array<std::uint32_t, BUCKETS> seeds_{};
+		std::array<std::uint32_t, SLOTS> slots_{};
+		std::array<Airport, AIRPORT_SLOTS> airports_{};
+		std::uint32_t airportSeed_ = 0;
+	};
+
+	// StandIds of a table's stands, interned once. A name of a compiled stand is then resolved by the
+	// perfect hash, without the string table's lock and map; other names are interned as usual.
+	template <typename Table>
+	class StaticStandIds {
+	public:
+		StaticStandIds(const Table& table, StringTable& standNames) : table_(table), standNames_(standNames) {
+			ids_.reserve(Table::size());
+			for (std::uint32_t i = 0; i < Table::size(); ++i) ids_.push_back(standNames.intern(table[i].name));
+		}
+
+		StandId resolve(std::uint32_t airport, std::string_view name) const {
+			const std::uint32_t index = table_.find(airport, name);
+			return index != Table::NOT_FOUND ? ids_[index] : standNames_.intern(name);
+		}
+
+		// stand: an element of table
+		StandId id(const StaticStand& stand) const { return ids_[table_.indexOf(stand)]; }
+
+	private:
+		const Table& table_;
+		StringTable& standNames_;
+		std::vector<StandId> ids_;
+	};
+
+} // namespace rampAgent
@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// String interning: callsigns, stand names, airports and remarks are stored once and referred
+// to by dense 32-bit ids, so per-cycle maps can be flat tables indexed by id instead of
+// string-keyed hash maps that copy every key and value.
+
+namespace rampAgent {
+
+	using StringId = std::uint32_t;
+	using CallsignId = StringId;
+	using StandId = StringId;
+	using AirportId = StringId;
+
+	constexpr StringId EMPTY_ID = 0; // every table interns "" as id 0
+	constexpr StringId NO_ID = (std::numeric_limits<StringId>::max)();
+
+	class StringTable {
+	public:
+		explicit StringTable(bool caseInsensitive = false) : caseInsensitive_(caseInsensitive) {
+			strings_.emplace_back();
+			ids_.emplace(std::string_view(strings_.front()), EMPTY_ID);
+		}
+
+		StringTable(const StringTable&) = delete;
+		StringTable& operator=(const StringTable&) = delete;
+
+		// Returns the id of str, adding it to the table if needed
+		StringId intern(std::string_view str) {
+			Normalized key(str, caseInsensitive_);
+			{
+				std::shared_lock<std::shared_mutex> lock(mutex_);
+				if (auto it = ids_.find(key.view()); it != ids_.end()) return it->second;
+			}
+			std::unique_lock<std::shared_mutex> lock(mutex_);
+			if (auto it = ids_.find(key.view()); it != ids_.end()) return it->second;
+			const StringId id = static_cast<StringId>(strings_.size());
+			strings_.emplace_back(key.view());
+			ids_.emplace(std::string_view(strings_.back()), id);
+			return id;
+		}
+
+		// Lookup without insertion, NO_ID if str was never interned
+		StringId find(std::string_view str) const {
+			Normalized key(str, caseInsensitive_);
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			auto it = ids_.find(key.view());
+			return it != ids_.end() ? it->second : NO_ID;
+		}
+
+		// Interned strings never move, the returned view/pointer stays valid for the table lifetime
+		std::string_view view(StringId id) const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return id < strings_.size() ? std::string_view(strings_[id]) : std::string_view();
+		}
+
+		const char* c_str(StringId id) const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return id < strings_.size() ? strings_[id].c_str() : "";
+		}
+
+		std::string str(StringId id) const { return std::string(view(id)); }
+
+		std::size_t size() const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			return strings_.size();
+		}
+
+		// Approximate heap footprint, for diagnostics
+		std::size_t memoryBytes() const {
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			std::size_t bytes = strings_.size() * sizeof(std::string) + ids_.bucket_count() * sizeof(void*)
+				+ ids_.size() * (sizeof(std::pair<std::string_view, StringId>) + 2 * sizeof(void*));
+			for (const auto& s : strings_) {
+				if (s.capacity() > SSO_CAPACITY) bytes += s.capacity() + 1;
+			}
+			return bytes;
+		}
+
+	private:
+		static constexpr std::size_t SSO_CAPACITY = 15;
+
+		// Upper-cases short keys on the stack so lookups don't allocate
+		class Normalized {
+		public:
+			Normalized(std::string_view str, bool upper) {
+				if (!upper) {
+					view_ = str;
+					return;
+				}
+				char* out = buffer_.data();
+				if (str.size() > buffer_.size()) {
+					heap_.resize(str.size());
+					out = heap_.data();
+				}
+				std::transform(str.begin(), str.end(), out, [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+				view_ = std::string_view(out, str.size());
+			}
+			std::string_view view() const { return view_; }
+
+		private:
+			std::array<char, 32> buffer_{};
+			std::string heap_;
+			std::string_view view_;
+		};
+
+		bool caseInsensitive_;
+		mutable std::shared_mutex mutex_;
+		std::deque<std::string> strings_;
+		std::unordered_map<std::string_view, StringId> ids_;
+	};
+
+	// Flat table keyed by interned id. Clearing keeps the storage, so a table rebuilt every
+	// cycle stops allocating once it has seen the largest id.
+	template <typename T>
+	class IdMap {
+	public:
+		bool contains(StringId id) const { return id < present_.size() && present_[id]; }
+
+		T* find(StringId id) { return contains(id) ? &values_[id] : nullptr; }
+		const T* find(StringId id) const { return contains(id) ? &values_[id] : nullptr; }
+
+		T& operator[](StringId id) {
+			if (id >= present_.size()) {
+				present_.resize(static_cast<std::size_t>(id) + 1, 0);
+				values_.resize(static_cast<std::size_t>(id) + 1);
+			}
+			if (!present_[id]) {
+				present_[id] = 1;
+				values_[id] = T{};
+				++size_;
+			}
+			return values_[id];
+		}
+
+		bool erase(StringId id) {
+			if (!contains(id)) return false;
+			present_[id] = 0;
+			values_[id] = T{};
+			--size_;
+			return true;
+		}
+
+		void clear() {
+			std::fill(present_.begin(), present_.end(), static_cast<std::uint8_t>(0));
+			size_ = 0;
+		}
+
+		template <typename Fn>
+		void forEach(Fn&& fn) const {
+			for (std::size_t id = 0; id < present_.size(); ++id) {
+				if (present_[id]) fn(static_cast<StringId>(id), values_[id]);
+			}
+		}
+
+		bool empty() const { return size_ == 0; }
+		std::size_t size() const { return size_; }
+		std::size_t memoryBytes() const { return values_.capacity() * sizeof(T) + present_.capacity(); }
+
+	private:
+		std::vector<T> values_;
+		std::vector<std::uint8_t> present_;
+		std::size_t size_ = 0;
+	};
+
+} // namespace rampAgent
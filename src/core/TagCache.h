@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "core/StringTable.h"
+
+// Bounded cache of the tag values shown per callsign.
+// Entries remember the sweep generation they were last used in (written, or their radar target
+// updated). sweep() advances the generation and evicts entries idle for IDLE_SWEEPS sweeps, so
+// aircraft lost from radar or never disconnected cleanly don't accumulate over a long session.
+// Storage is a fixed slot array with a linear-probing index sized at construction: memory does not
+// depend on how many callsigns were seen, and when full the least recently used entry is evicted.
+
+namespace rampAgent {
+
+	template <typename T>
+	class TagCache {
+	public:
+		static constexpr std::uint32_t IDLE_SWEEPS = 10;
+
+		explicit TagCache(std::uint32_t capacity) : slots_(capacity) {
+			std::size_t indexSize = 2;
+			while (indexSize < static_cast<std::size_t>(capacity) * 2) indexSize <<= 1;
+			index_.assign(indexSize, NO_SLOT);
+			mask_ = static_cast<std::uint32_t>(indexSize - 1);
+			free_.reserve(capacity);
+			for (std::uint32_t slot = capacity; slot > 0; --slot) free_.push_back(slot - 1);
+		}
+
+		TagCache(const TagCache&) = delete;
+		TagCache& operator=(const TagCache&) = delete;
+
+		T* find(CallsignId callsign) {
+			const std::uint32_t position = locate(callsign);
+			return position != NO_SLOT ? &slots_[index_[position]].value : nullptr;
+		}
+		const T* find(CallsignId callsign) const {
+			const std::uint32_t position = locate(callsign);
+			return position != NO_SLOT ? &slots_[index_[position]].value : nullptr;
+		}
+
+		// Inserts or replaces. When full the least recently used entry is evicted first, calling
+		// onEvict(callsign) for it.
+		template <typename Fn>
+		void put(CallsignId callsign, const T& value, Fn&& onEvict) {
+			std::uint32_t position = locate(callsign);
+			if (position == NO_SLOT) {
+				if (free_.empty()) {
+					const std::uint32_t oldest = leastRecentlyUsed();
+					const CallsignId evicted = slots_[oldest].callsign;
+					evict(oldest);
+					onEvict(evicted);
+					++capacityEvictions_;
+				}
+				const std::uint32_t slot = free_.back();
+				free_.pop_back();
+				slots_[slot].callsign = callsign;
+				for (position = home(callsign); index_[position] != NO_SLOT; position = (position + 1) & mask_) {}
+				index_[position] = slot;
+				++size_;
+			}
+			Slot& entry = slots_[index_[position]];
+			entry.value = value;
+			entry.lastUsed = generation_;
+		}
+
+		// Marks the entry as still in use, false if absent
+		bool touch(CallsignId callsign) {
+			const std::uint32_t position = locate(callsign);
+			if (position == NO_SLOT) return false;
+			slots_[index_[position]].lastUsed = generation_;
+			return true;
+		}
+
+		bool erase(CallsignId callsign) {
+			const std::uint32_t position = locate(callsign);
+			if (position == NO_SLOT) return false;
+			remove(position);
+			return true;
+		}
+
+		// Starts a new generation and evicts the entries idle for IDLE_SWEEPS, calling onEvict(callsign)
+		template <typename Fn>
+		std::size_t sweep(Fn&& onEvict) {
+			++generation_;
+			std::size_t evicted = 0;
+			for (std::uint32_t slot = 0; slot < slots_.size(); ++slot) {
+				const Slot& entry = slots_[slot];
+				if (entry.callsign == NO_ID || generation_ - entry.lastUsed < IDLE_SWEEPS) continue;
+				const CallsignId callsign = entry.callsign;
+				evict(slot);
+				onEvict(callsign);
+				++evicted;
+			}
+			idleEvictions_ += evicted;
+			return evicted;
+		}
+
+		template <typename Fn>
+		void forEach(Fn&& fn) const {
+			for (const Slot& entry : slots_) {
+				if (entry.callsign != NO_ID) fn(entry.callsign, entry.value);
+			}
+		}
+
+		std::size_t size() const { return size_; }
+		std::size_t capacity() const { return slots_.size(); }
+		std::uint32_t generation() const { return generation_; }
+		std::uint64_t idleEvictions() const { return idleEvictions_; }
+		std::uint64_t capacityEvictions() const { return capacityEvictions_; }
+
+		// Fixed at construction
+		std::size_t memoryBytes() const {
+			return slots_.capacity() * sizeof(Slot) + index_.capacity() * sizeof(std::uint32_t) + free_.capacity() * sizeof(std::uint32_t);
+		}
+
+	private:
+		static constexpr std::uint32_t NO_SLOT = (std::numeric_limits<std::uint32_t>::max)();
+
+		struct Slot {
+			CallsignId callsign = NO_ID;
+			std::uint32_t lastUsed = 0; // generation
+			T value{};
+		};
+
+		std::uint32_t home(CallsignId callsign) const { return (callsign * 0x9E3779B1u) & mask_; }
+
+		// Index position of callsign, NO_SLOT if absent
+		std::uint32_t locate(CallsignId callsign) const {
+			for (std::uint32_t position = home(callsign); index_[position] != NO_SLOT; position = (position + 1) & mask_) {
+				if (slots_[index_[position]].callsign == callsign) return position;
+			}
+			return NO_SLOT;
+		}
+
+		std::uint32_t leastRecentlyUsed() const {
+			std::uint32_t oldest = 0;
+			for (std::uint32_t slot = 1; slot < slots_.size(); ++slot) {
+				if (generation_ - slots_[slot].lastUsed > generation_ - slots_[oldest].lastUsed) oldest = slot;
+			}
+			return oldest;
+		}
+
+		void evict(std::uint32_t slot) { remove(locate(slots_[slot].callsign)); }
+
+		// Backward-shift deletion, keeps probe sequences intact without tombstones
+		void remove(std::uint32_t position) {
+			const std::uint32_t slot = index_[position];
+			slots_[slot] = Slot{};
+			free_.push_back(slot);
+			--size_;
+
+			std::uint32_t hole = position;
+			for (std::uint32_t next = (hole + 1) & mask_; index_[next] != NO_SLOT; next = (next + 1) & mask_) {
+				const std::uint32_t wanted = home(slots_[index_[next]].callsign);
+				// Move next into the hole unless its home lies cyclically in (hole, next]
+				if (((next - wanted) & mask_) >= ((next - hole) & mask_)) {
+					index_[hole] = index_[next];
+					hole = next;
+				}
+			}
+			index_[hole] = NO_SLOT;
+		}
+
+		std::vector<Slot> slots_;
+		std::vector<std::uint32_t> index_; // slot per position, NO_SLOT if empty
+		std::vector<std::uint32_t> free_;
+		std::uint32_t mask_ = 0;
+		std::uint32_t generation_ = 0;
+		std::size_t size_ = 0;
+		std::uint64_t idleEvictions_ = 0;
+		std::uint64_t capacityEvictions_ = 0;
+	};
+
+} // namespace rampAgent
@@ -10,15 +10,16 @@ inline void RampAgent::RegisterTagActions()
 
 inline void RampAgent::OnFunctionCall(int functionId, const char* itemString, POINT pt, RECT area)
 {
+	Watchdog::CallbackScope watch(watchdog_, "OnFunctionCall");
 	std::ignore = pt;
 
-	if (isController_ == false || isConnected_ == false) return; // If OBS, can't assign stands
+	if (!session_.current()->controller) return; // If OBS, can't assign stands
 
 	auto fp = FlightPlanSelectASEL();
-	std::string callsign = toUpper(fp.GetCallsign());
+	const Callsign callsign(fp.GetCallsign());
 	std::string icao = toUpper(fp.GetFlightPlanData().GetDestination());
 
-	if (icao.substr(0, 2) != "LF") {
+	if (!isFrenchAirport(packIcao(icao))) {
 		DisplayMessage("Stand assignment only available for French airports.", "");
 		return; // Only French airports supported
 	}
@@ -26,9 +27,10 @@ inline void RampAgent::OnFunctionCall(int functionId, const char* itemString, PO
 	switch (static_cast<TagActionID>(functionId)) {
 	case TagActionID::OpenMENU:
 	{
+		TRACE_SPAN("popup build");
 		OpenPopupList(area, icao.c_str(), 1);
 
-		updateStandMenuButtons(icao);
+		updateStandMenuButtons(icao, fp);
 
 		for (const auto& button : menuButtons_) {
 			AddPopupListElement(button.c_str(), NULL, static_cast<int>(TagActionID::AssignSTAND), false, 2, false, false);
@@ -50,9 +52,11 @@ inline void RampAgent::OnFunctionCall(int functionId, const char* itemString, PO
 		}
 
 		if (m_thread.joinable()) {
+			TRACE_SPAN("thread join");
+			Watchdog::OpScope op(BlockingOp::Join);
 			m_thread.join();
 		}
-		m_thread = std::thread(&RampAgent::assignStandToAircraft, this, callsign, std::string(itemString), icao);
+		m_thread = std::thread(&RampAgent::assignStandToAircraft, this, callsigns_.intern(callsign), builtinStandIds_.resolve(packIcao(icao), itemString), airports_.intern(icao));
 		break;
 	}
 	default:
@@ -60,141 +64,229 @@ inline void RampAgent::OnFunctionCall(int functionId, const char* itemString, PO
 	}
 }
 
-inline void rampAgent::RampAgent::updateStandMenuButtons(const std::string& icao)
+inline std::shared_ptr<const StandCatalogue> rampAgent::RampAgent::getStandCatalogue(const std::string& icao)
 {
-	menuButtons_.clear();
+	const AirportId airport = airports_.intern(icao);
+	std::shared_ptr<const StandCatalogue> cached;
+	{
+		auto lock = Watchdog::acquire(standCataloguesMutex_);
+		auto it = standCatalogues_.find(airport);
+		if (it != standCatalogues_.end()) cached = it->second;
+	}
+	if (!cached) return fetchStandCatalogue(icao, false);
+	if (std::chrono::system_clock::now() - cached->fetched < STAND_CATALOGUE_TTL) return cached;
+
+	// Stale (e.g. loaded from the disk cache): serve it now, refresh in the background
+	if (!catalogueRefreshing_.exchange(true)) {
+		if (catalogueThread_.joinable()) catalogueThread_.join(); // finished, catalogueRefreshing_ was false
+		catalogueThread_ = std::thread([this, icao]() {
+			trace::Tracer::instance().setThreadName("Stand catalogue refresh");
+			fetchStandCatalogue(icao, true);
+			catalogueRefreshing_ = false;
+		});
+	}
+	return cached;
+}
+
+inline std::shared_ptr<const StandCatalogue> rampAgent::RampAgent::fetchStandCatalogue(const std::string& icao, bool background)
+{
+	// Off the UI thread, messages are displayed on the next update
+	auto report = [&](const std::string& message, MessageSeverity severity) {
+		if (background) queueMessage(message, MessageKey::Catalogue, severity);
+		else DisplayMessage(message, "");
+	};
+
 	nlohmann::ordered_json standsJson = nlohmann::ordered_json::object();
 
-	httplib::SSLClient cli(apiUrl_);
-	cli.set_connection_timeout(0, 700000); // 700ms
-	cli.set_read_timeout(1, 0);            // 1s
-	cli.set_write_timeout(1, 0);           // 1s
-	httplib::Headers headers = { {"User-Agent", "EuroscopeRampAgent"} };
 	std::string apiEndpoint = "/api/airports/" + icao + "/stands";
+	const CancelToken cancel = network_.token();
 
-	auto res = cli.Get(apiEndpoint.c_str(), headers);
+	ApiResponse res;
+	{
+		TRACE_SPAN("network request");
+		Watchdog::OpScope op(BlockingOp::Http);
+		const auto start = EventLog::now();
+		res = endpoints_.get(*api_, apiEndpoint, cancel);
+		EventLog::instance().record("stand catalogue", start, res.status, res.body.size(), icao);
+	}
+	if (cancel.cancelled()) return nullptr; // shutdown, disconnect or URL change
 
-	if (res && res->status >= 200 && res->status < 300) {
-		if (!printError) {
-			printError = true; // reset error printing flag on success
-			DisplayMessage("Successfully retrieved stands information from NeoRampAgent server for airport " + icao, "");
+	if (res.ok()) {
+		if (!printError.exchange(true)) { // reset error printing flag on success
+			report("Successfully retrieved stands information from NeoRampAgent server for airport " + icao, MessageSeverity::Info);
 		}
 		try {
-			if (!res->body.empty()) standsJson = nlohmann::ordered_json::parse(res->body);
+			TRACE_SPAN("parse");
+			if (!res.body.empty()) standsJson = decodePayload(res.contentType, res.body);
 		}
 		catch (const std::exception& e) {
-			DisplayMessage("Failed to parse stands data from NeoRampAgent server: " + std::string(e.what()), "");
-			return;
+			report("Failed to parse stands data from NeoRampAgent server: " + std::string(e.what()), MessageSeverity::Error);
+			return builtinStandCatalogue(icao);
 		}
 	}
 	else {
-		if (printError) {
-			printError = false; // avoid spamming logs
-			DisplayMessage("Failed to get stands information from NeoRampAgent server. HTTP status: " + std::to_string(res ? res->status : 0), "");
+		if (printError.exchange(false)) { // avoid spamming logs
+			report("Failed to get stands information from NeoRampAgent server. HTTP status: " + std::to_string(res.status), MessageSeverity::Error);
 		}
-		return;
+		return builtinStandCatalogue(icao);
+	}
+
+	const std::uint32_t packed = packIcao(icao);
+	std::shared_ptr<const StandCatalogue> catalogue = StandCatalogue::fromJson(airports_.intern(icao), standsJson, standNames_,
+		[this, packed](std::string_view name) { return builtinStandIds_.resolve(packed, name); });
+	{
+		auto lock = Watchdog::acquire(standCataloguesMutex_);
+		standCatalogues_[catalogue->airport] = catalogue;
+	}
+	saveStandCatalogueCache();
+	return catalogue;
+}
+
+inline std::shared_ptr<const StandCatalogue> rampAgent::RampAgent::builtinStandCatalogue(const std::string& icao)
+{
+	const std::span<const StaticStand> builtin = BUILTIN_STANDS.airport(packIcao(icao));
+	if (builtin.empty()) return nullptr;
+
+	// Kept until a fetch succeeds, a catalogue already loaded (e.g. from the disk cache) wins
+	const AirportId airport = airports_.intern(icao);
+	std::shared_ptr<const StandCatalogue> catalogue = StandCatalogue::fromStatic(airport, builtin, builtinStandIds_, standNames_);
+	{
+		auto lock = Watchdog::acquire(standCataloguesMutex_);
+		catalogue = standCatalogues_.try_emplace(airport, catalogue).first->second;
+	}
+	queueMessage("Using the built-in stand layout for " + icao + " until the server is reachable.", MessageKey::Catalogue);
+	return catalogue;
+}
+
+inline bool rampAgent::RampAgent::getMenuAnchor(const CFlightPlan& flightPlan, const StandCatalogue& catalogue, double& latitude, double& longitude)
+{
+	const CallsignId callsign = callsigns_.find(Callsign(flightPlan.GetCallsign()));
+
+	// On ground at this airport: closest to where the aircraft is now
+	if (groundState_.isOnGround(callsign)) {
+		CRadarTarget target = flightPlan.GetCorrelatedRadarTarget();
+		if (target.IsValid()) {
+			const CPosition position = target.GetPosition().GetPosition();
+			if (catalogue.index.withinBounds(position.m_Latitude, position.m_Longitude, MENU_ANCHOR_MARGIN_M)) {
+				latitude = position.m_Latitude;
+				longitude = position.m_Longitude;
+				return true;
+			}
+		}
+	}
+
+	// Inbound: closest to the stand currently assigned, ie its expected terminal
+	StandId assigned = EMPTY_ID;
+	{
+		auto lock = Watchdog::acquire(tagItemValueMapMutex_);
+		if (const TagItemInfo* info = tagItemValueMap_.find(callsign)) assigned = info->stand;
 	}
+	if (assigned == EMPTY_ID) return false;
+	const StandInfo* stand = catalogue.find(assigned);
+	if (stand == nullptr || !stand->hasPosition) return false;
+	latitude = stand->latitude;
+	longitude = stand->longitude;
+	return true;
+}
+
+inline void rampAgent::RampAgent::updateStandMenuButtons(const std::string& icao, const CFlightPlan& flightPlan)
+{
+	menuButtons_.clear();
+	std::shared_ptr<const StandCatalogue> catalogue = getStandCatalogue(icao);
+	if (!catalogue) return;
+
+	// deduct available stands list from all stands + occupied stands + blocked stands
+	unavailableStands_.clear();
+	const std::shared_ptr<const OccupancyState> occupancy = occupancy_.pin();
 
 	// minimal menu if no stands received
-	if (standsJson.empty() || assignedStands_.empty()) {
-		if (printError) {
-			printError = false; // avoid spamming logs
+	if (catalogue->stands.empty() || !occupancy->received) {
+		if (printError.exchange(false)) { // avoid spamming logs
 			DisplayMessage("No stands data received from NeoRampAgent server for airport " + icao, "");
 		}
-		menuButtons_.clear();
 		return;
 	}
 
-	// deduct available stands list from all stands + occupied stands + blocked stands
-	std::vector<std::string> availableStands;
-	{
-		std::lock_guard<std::mutex> lock(assignedStandsMutex_);
-
-		for (auto& [standName, standData] : standsJson.items()) {
-			// Check if stand is already Assigned
-			bool isOccupied = false;
-			for (const auto& occupied : assignedStands_["assignedStands"]) {
-				if (occupied["name"].get<std::string>() == standName) {
-					isOccupied = true;
-					break;
-				}
-			}
-			// Check if stand is already occupied
-			for (const auto& occupied : assignedStands_["occupiedStands"]) {
-				if (occupied["name"].get<std::string>() == standName) {
-					isOccupied = true;
-					break;
-				}
-			}
-			// Check if stand is blocked
-			for (const auto& occupied : assignedStands_["blockedStands"]) {
-				if (occupied["name"].get<std::string>() == standName) {
-					isOccupied = true;
-					break;
-				}
-			}
-			if (!isOccupied) {
-				availableStands.push_back(standName);
-			}
-		}
+	for (const OccupancyState::Unavailable& unavailable : occupancy->unavailable) {
+		// Radar saw the occupant leave since the server snapshot
+		if (unavailable.occupied && localOccupancy_.hasVacated(unavailable.callsign, catalogue->airport, unavailable.stand)) continue;
+		unavailableStands_[unavailable.stand] = 1;
+	}
+
+	// Radar saw an aircraft park there since the server snapshot
+	localOccupancy_.forEachOccupied(catalogue->airport, [&](StandId stand, CallsignId) { unavailableStands_[stand] = 1; });
+
+	auto isAvailable = [&](std::uint32_t index) { return !unavailableStands_.contains(catalogue->stands[index].name); };
+
+	// Closest suitable stands first, then every free stand in natural order
+	std::vector<std::uint32_t> nearest;
+	double latitude = 0.0, longitude = 0.0;
+	if (!catalogue->index.empty() && getMenuAnchor(flightPlan, *catalogue, latitude, longitude)) {
+		nearest = catalogue->index.nearest(latitude, longitude, MENU_NEAREST_STANDS, isAvailable);
+		for (std::uint32_t index : nearest) menuButtons_.push_back(standNames_.str(catalogue->stands[index].name));
 	}
 
-	//Sort stands alphabetically -> 2A,2B, 3A,3B,...
-	sortStandList(availableStands);
-	menuButtons_ = availableStands;
+	// Catalogue stands are already sorted -> 2A,2B, 3A,3B,...
+	for (std::uint32_t index = 0; index < catalogue->stands.size(); ++index) {
+		if (!isAvailable(index) || std::find(nearest.begin(), nearest.end(), index) != nearest.end()) continue;
+		menuButtons_.push_back(standNames_.str(catalogue->stands[index].name));
+	}
 }
 
-void RampAgent::assignStandToAircraft(const std::string& callsign, const std::string& standName, std::string menuIcao)
+void RampAgent::assignStandToAircraft(CallsignId callsign, StandId stand, AirportId airport)
 {
-	std::string token = generateToken(callsign_);
+	TRACE_SPAN("assignStandToAircraft");
+	const std::shared_ptr<const Session> session = session_.current();
+	const std::string callsignStr = callsigns_.str(callsign);
+	const std::string standName = standNames_.str(stand);
 
-	httplib::SSLClient cli(apiUrl_);
-	cli.set_connection_timeout(0, 700000); // 700ms
-	cli.set_read_timeout(1, 0);            // 1s
-	cli.set_write_timeout(1, 0);           // 1s
-	httplib::Headers headers = { {"User-Agent", "EuroscopeRampAgent"} };
-	std::string apiEndpoint = "/api/assign?stand=" + standName + "&icao=" + menuIcao + "&callsign=" + callsign + "&token=" + token + "&client=" + callsign_;
+	std::string apiEndpoint = "/api/assign?stand=" + standName + "&icao=" + airports_.str(airport) + "&callsign=" + callsignStr + "&token=" + session->token + "&client=" + session->callsign;
 
-	auto res = cli.Get(apiEndpoint.c_str(), headers);
+	const CancelToken cancel = network_.token();
 
-	if (!res || !(res->status >= 200 && res->status < 300)) {
-		queueMessage("Failed to send manual assign to NeoRampAgent server. HTTP status: " + std::to_string(res ? res->status : 0));
+	ApiResponse res;
+	{
+		TRACE_SPAN("network request");
+		const auto start = EventLog::now();
+		res = endpoints_.getOnce(*api_, apiEndpoint, cancel); // not idempotent, never hedged
+		EventLog::instance().record("stand assignment", start, res.status, res.body.size(), callsignStr + " " + standName);
+	}
+	if (cancel.cancelled()) {
+		queueMessage("Manual assign of " + standName + " to " + callsignStr + " cancelled, it may not have reached the server.", MessageKey::None, MessageSeverity::Error);
+		return;
+	}
+
+	if (!res.ok()) {
+		queueMessage("Failed to send manual assign to NeoRampAgent server. HTTP status: " + std::to_string(res.status), MessageKey::None, MessageSeverity::Error);
 		return;
 	}
 	else { // assignement processed, check response to see if successful and update tag item if so
-		if (!res->body.empty()) {
-			nlohmann::ordered_json dataJson = nlohmann::ordered_json::parse(res->body);
+		if (!res.body.empty()) {
+			nlohmann::ordered_json dataJson = decodePayload(res.contentType, res.body);
 			if (!dataJson.contains("message")) return; // malformed response
 			if (dataJson["message"]["action"].get<std::string>() == "assign") {
-				{
-					std::lock_guard<std::mutex> lock(lastStandTagMapMutex_);
-					lastStandTagMap_[callsign] = standName;
-				}
+				occupancy_.edit(callsign, stand);
 				{
 					std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
-					manualAssignedCallsigns_[callsign] = standName;
+					manualAssignedCallsigns_[callsign] = stand;
 				}
-				UpdateTagItems(callsign, WHITE, standName);
+				UpdateTagItems(callsign, WHITE, stand);
 				return;
 			}
 			else if (dataJson["message"]["action"].get<std::string>() == "free") {
-				{
-					std::lock_guard<std::mutex> lock(lastStandTagMapMutex_);
-					lastStandTagMap_.erase(callsign);
-				}
+				occupancy_.edit(callsign, EMPTY_ID);
 				{
 					std::lock_guard<std::mutex> lock(manualAssignedCallsignsMutex_);
-					manualAssignedCallsigns_[callsign] = "";
+					manualAssignedCallsigns_[callsign] = EMPTY_ID;
 				}
-				UpdateTagItems(callsign, WHITE, "");
+				UpdateTagItems(callsign, WHITE);
 				return;
 			}
 			else {
-				queueMessage("Manual stand rejected: " + dataJson["message"]["message"].get<std::string>());
-				DisplayMessage("Manual stand rejected: " + dataJson["message"]["message"].get<std::string>());
+				queueMessage("Manual stand rejected: " + dataJson["message"]["message"].get<std::string>(), MessageKey::None, MessageSeverity::Warning);
 				return;
 			}
 		}
 	}
-	queueMessage("Manual stand assignment failed for " + callsign + " to " + standName);
+	queueMessage("Manual stand assignment failed for " + callsignStr + " to " + standName, MessageKey::None, MessageSeverity::Error);
 }
\ No newline at end of file
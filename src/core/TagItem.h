@@ -8,32 +8,52 @@ void RampAgent::RegisterTagItems() {
 	RegisterTagItemType("REMARK", static_cast<int>(TagItemID::REMARK));
 }
 
-inline void RampAgent::UpdateTagItems(std::string callsign, COLORREF color, std::string standName, std::string remark)
+inline void RampAgent::UpdateTagItems(CallsignId callsign, COLORREF color, StandId stand, StringId remark)
 {
-	std::lock_guard<std::mutex> lock(tagItemValueMapMutex_);
-	TagItemInfo tagInfo;
-	tagInfo.standName = standName;
-	tagInfo.remark = remark;
-	tagInfo.color = color;
+	TRACE_SPAN("tag update");
+	auto lock = Watchdog::acquire(tagItemValueMapMutex_);
+	if (stand == EMPTY_ID && remark == EMPTY_ID) tagItemValueMap_.erase(callsign); // blank tag, nothing to keep
+	else tagItemValueMap_.put(callsign, { stand, remark, color }, [&](CallsignId evicted) { capacityEvicted_.push_back(evicted); });
 
-	tagItemValueMap_[callsign] = tagInfo;
-
-	// Set sratchpad value for the stand to appear inside vSMR when aircraft is on ground (ie speed < 60kt)
-	std::pair<bool, CRadarTarget> aircraft = aircraftExists(callsign);
+	// Stand/remark are mirrored into the strip annotations for vSMR once the aircraft is on ground,
+	// the actual write is deferred to flushAnnotations(). Local proposals stay in this instance.
+	if (color != PROPOSAL) annotations_.set(callsign, stand, remark);
+}
 
-	if (aircraft.first == false) return; // Aircraft not found, skip
+inline void RampAgent::flushAnnotations()
+{
+	if (!annotations_.hasPending()) return;
+	TRACE_SPAN("annotation flush");
 
-	if (aircraft.second.GetGS() > 60) return; // Aircraft is not on ground, skip
+	// Airborne aircraft stay pending, their write is triggered by the landing in OnRadarTargetPositionUpdate
+	annotations_.flush([&](CallsignId callsign, StandId stand, StringId remark, bool writeStand, bool writeRemark) -> int {
+		if (!groundState_.isOnGround(callsign)) return -1;
+		return writeAnnotations(FlightPlanSelect(callsigns_.c_str(callsign)), stand, remark, writeStand, writeRemark);
+	});
+}
 
-	CFlightPlanControllerAssignedData assignedData = getControllerAssignedData(callsign);
-	assignedData.SetFlightStripAnnotation(3, standName.c_str());
-	assignedData.SetFlightStripAnnotation(4, remark.c_str());
+inline int RampAgent::writeAnnotations(CFlightPlan flightPlan, StandId stand, StringId remark, bool writeStand, bool writeRemark)
+{
+	if (!flightPlan.IsValid()) return -1;
 
+	// Skip values already present on the strip (e.g. set by another controller)
+	CFlightPlanControllerAssignedData assignedData = flightPlan.GetControllerAssignedData();
+	int written = 0;
+	if (writeStand && std::strcmp(assignedData.GetFlightStripAnnotation(AnnotationSync::STAND_SLOT), standNames_.c_str(stand)) != 0) {
+		assignedData.SetFlightStripAnnotation(AnnotationSync::STAND_SLOT, standNames_.c_str(stand));
+		++written;
+	}
+	if (writeRemark && std::strcmp(assignedData.GetFlightStripAnnotation(AnnotationSync::REMARK_SLOT), remarks_.c_str(remark)) != 0) {
+		assignedData.SetFlightStripAnnotation(AnnotationSync::REMARK_SLOT, remarks_.c_str(remark));
+		++written;
+	}
+	return written;
 }
 
 inline void RampAgent::OnGetTagItem(EuroScopePlugIn::CFlightPlan FlightPlan, EuroScopePlugIn::CRadarTarget RadarTarget, int ItemCode, int TagData, char sItemString[16], int* pColorCode, COLORREF* pRGB, double* pFontSize)
 {
-	std::lock_guard<std::mutex> lock(tagItemValueMapMutex_);
+	Watchdog::CallbackScope watch(watchdog_, "OnGetTagItem");
+	auto lock = Watchdog::acquire(tagItemValueMapMutex_);
 	std::ignore = RadarTarget;
 	std::ignore = TagData;
 	std::ignore = pRGB;
@@ -42,9 +62,9 @@ inline void RampAgent::OnGetTagItem(EuroScopePlugIn::CFlightPlan FlightPlan, Eur
 	*pColorCode = EuroScopePlugIn::TAG_COLOR_RGB_DEFINED;
 
 	// FIXME: what happens if FlightPlan is not valid?
-	std::string callsign = toUpper(FlightPlan.GetCallsign());
+	const TagItemInfo* tagInfo = tagItemValueMap_.find(callsigns_.find(Callsign(FlightPlan.GetCallsign())));
 
-	if (tagItemValueMap_.find(callsign) == tagItemValueMap_.end()) {
+	if (tagInfo == nullptr) {
 		return; // No tag info found for this callsign
 	}
 
@@ -52,16 +72,14 @@ inline void RampAgent::OnGetTagItem(EuroScopePlugIn::CFlightPlan FlightPlan, Eur
 	switch (static_cast<TagItemID>(ItemCode)) {
 		case TagItemID::STAND:
 		{
-			std::string standName = tagItemValueMap_[callsign].standName;
-			std::snprintf(sItemString, 16, "%s", standName.c_str());
-			*pRGB = tagItemValueMap_[callsign].color;
+			std::snprintf(sItemString, 16, "%s", standNames_.c_str(tagInfo->stand));
+			*pRGB = tagInfo->color;
 			break;
 		}
 		case TagItemID::REMARK:
 		{
-			std::string remark = tagItemValueMap_[callsign].remark;
-			std::snprintf(sItemString, 16, "%s", remark.c_str());
-			*pRGB = tagItemValueMap_[callsign].color;
+			std::snprintf(sItemString, 16, "%s", remarks_.c_str(tagInfo->remark));
+			*pRGB = tagInfo->color;
 			break;
 		}
 		default:
@@ -0,0 +1,221 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/CatalogueCache.h"
+#include "core/Callsign.h"
+#include "core/OccupancyState.h"
+#include "core/StringTable.h"
+
+// Warm-start snapshot of the tag state.
+// The displayed stand/remark/colour per callsign and the last server occupancy are saved on
+// shutdown and periodically, and restored at startup if recent enough, so tags show straight
+// away after a restart, the stand menu knows the unavailable stands, and the first poll only
+// confirms them instead of flashing every tag as new.
+//
+// Layout (little-endian): FileHeader, then per entry an EntryRecord, per occupancy assignment an
+// AssignmentRecord and per unavailable stand an UnavailableRecord, each followed by its
+// callsign, stand and remark bytes.
+
+namespace rampAgent {
+
+	class TagSnapshot {
+	public:
+		static constexpr char MAGIC[8] = { 'R', 'A', 'T', 'A', 'G', 'S', 'N', '\0' };
+		static constexpr std::uint32_t VERSION = 2; // bump on any layout change
+
+		struct Entry {
+			CallsignId callsign = EMPTY_ID;
+			StandId stand = EMPTY_ID;
+			StringId remark = EMPTY_ID;
+			std::uint32_t color = 0; // COLORREF
+		};
+
+		// entries and occupancy reference ids of the given tables
+		static bool write(const std::string& path, const std::vector<Entry>& entries, const OccupancyState& occupancy, const CallsignTable& callsigns,
+			const StringTable& standNames, const StringTable& remarks) {
+			std::vector<std::uint8_t> payload;
+			const std::size_t assignments = occupancy.received ? occupancy.assignments.size() : 0;
+			const std::size_t unavailables = occupancy.received ? occupancy.unavailable.size() : 0;
+			payload.reserve((entries.size() + assignments + unavailables) * (sizeof(EntryRecord) + 16));
+			for (const Entry& entry : entries) {
+				EntryRecord record{};
+				record.color = entry.color;
+				appendRecord(payload, record, callsigns.view(entry.callsign), standNames.view(entry.stand), remarks.view(entry.remark));
+			}
+			for (std::size_t i = 0; i < assignments; ++i) {
+				const OccupancyState::Assignment& assignment = occupancy.assignments[i];
+				AssignmentRecord record{};
+				record.manual = assignment.manual ? 1 : 0;
+				appendRecord(payload, record, callsigns.view(assignment.callsign), standNames.view(assignment.stand), remarks.view(assignment.remark));
+			}
+			for (std::size_t i = 0; i < unavailables; ++i) {
+				const OccupancyState::Unavailable& unavailable = occupancy.unavailable[i];
+				UnavailableRecord record{};
+				record.occupied = unavailable.occupied ? 1 : 0;
+				const std::string_view callsign = unavailable.callsign == NO_ID ? std::string_view() : callsigns.view(unavailable.callsign);
+				appendRecord(payload, record, callsign, standNames.view(unavailable.stand), std::string_view());
+			}
+
+			FileHeader header{};
+			std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+			header.version = VERSION;
+			header.entryCount = static_cast<std::uint32_t>(entries.size());
+			header.assignmentCount = static_cast<std::uint32_t>(assignments);
+			header.unavailableCount = static_cast<std::uint32_t>(unavailables);
+			header.hasOccupancy = occupancy.received ? 1 : 0;
+			header.savedUnix = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			header.payloadSize = payload.size();
+			header.payloadHash = fnv1a64(payload.data(), payload.size());
+			return replaceFile(path, &header, sizeof(header), payload);
+		}
+
+		// Loads a snapshot no older than maxAge into out and occupancy, interning its strings. occupancy
+		// is left as is if none was saved; a restored one is marked received and fetched when saved.
+		// Returns false if the file is missing, too old, from another version or corrupted.
+		static bool read(const std::string& path, std::chrono::seconds maxAge, CallsignTable& callsigns, StringTable& standNames, StringTable& remarks,
+			std::vector<Entry>& out, OccupancyState& occupancy, std::chrono::system_clock::time_point& saved) {
+			MappedFile file;
+			if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+
+			FileHeader header;
+			std::memcpy(&header, file.data(), sizeof(header));
+			if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) return false;
+			saved = std::chrono::system_clock::time_point(std::chrono::seconds(header.savedUnix));
+			const auto age = std::chrono::system_clock::now() - saved;
+			if (age > maxAge) return false;
+			if (header.payloadSize != file.size() - sizeof(FileHeader)) return false;
+			const std::uint8_t* payload = file.data() + sizeof(FileHeader);
+			if (fnv1a64(payload, header.payloadSize) != header.payloadHash) return false;
+
+			Reader reader{ payload, header.payloadSize };
+			std::vector<Entry> entries;
+			const std::size_t maxRecords = header.payloadSize / sizeof(EntryRecord); // the header counts are not hashed
+			entries.reserve((std::min)(std::size_t{ header.entryCount }, maxRecords));
+			for (std::uint32_t i = 0; i < header.entryCount; ++i) {
+				EntryRecord record;
+				Text text;
+				if (!reader.next(record, text)) return false;
+				Entry entry;
+				entry.callsign = callsigns.intern(text.callsign);
+				entry.stand = standNames.intern(text.stand);
+				entry.remark = remarks.intern(text.remark);
+				entry.color = record.color;
+				entries.push_back(entry);
+			}
+
+			OccupancyState restored;
+			restored.assignments.reserve((std::min)(std::size_t{ header.assignmentCount }, maxRecords));
+			for (std::uint32_t i = 0; i < header.assignmentCount; ++i) {
+				AssignmentRecord record;
+				Text text;
+				if (!reader.next(record, text)) return false;
+				restored.assignments.push_back({ callsigns.intern(text.callsign), standNames.intern(text.stand), remarks.intern(text.remark), record.manual != 0 });
+			}
+			restored.unavailable.reserve((std::min)(std::size_t{ header.unavailableCount }, maxRecords));
+			for (std::uint32_t i = 0; i < header.unavailableCount; ++i) {
+				UnavailableRecord record;
+				Text text;
+				if (!reader.next(record, text)) return false;
+				const CallsignId callsign = text.callsign.empty() ? NO_ID : callsigns.intern(text.callsign);
+				restored.unavailable.push_back({ standNames.intern(text.stand), callsign, record.occupied != 0 });
+			}
+			if (reader.offset != header.payloadSize) return false;
+
+			out = std::move(entries);
+			if (header.hasOccupancy != 0) {
+				restored.received = true;
+				restored.fetched = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+				occupancy = std::move(restored);
+			}
+			return true;
+		}
+
+	private:
+		struct FileHeader {
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t entryCount;
+			std::uint32_t assignmentCount;
+			std::uint32_t unavailableCount;
+			std::uint32_t hasOccupancy; // 0: no server data when saved
+			std::uint32_t reserved;
+			std::int64_t savedUnix; // seconds
+			std::uint64_t payloadSize;
+			std::uint64_t payloadHash;
+		};
+
+		// Every record is followed by callsignLength + standLength + remarkLength bytes of text
+		struct EntryRecord {
+			std::uint32_t color;
+			std::uint8_t callsignLength;
+			std::uint8_t standLength;
+			std::uint16_t remarkLength;
+		};
+
+		struct AssignmentRecord {
+			std::uint8_t manual;
+			std::uint8_t callsignLength;
+			std::uint8_t standLength;
+			std::uint8_t reserved;
+			std::uint16_t remarkLength;
+			std::uint16_t reserved2;
+		};
+
+		struct UnavailableRecord {
+			std::uint8_t occupied;
+			std::uint8_t callsignLength;
+			std::uint8_t standLength;
+			std::uint8_t reserved;
+			std::uint16_t remarkLength; // always 0
+			std::uint16_t reserved2;
+		};
+
+		static_assert(sizeof(FileHeader) == 56 && sizeof(EntryRecord) == 8 && sizeof(AssignmentRecord) == 8 && sizeof(UnavailableRecord) == 8,
+			"snapshot layout changed, bump VERSION");
+
+		struct Text {
+			std::string_view callsign, stand, remark;
+		};
+
+		// Record, then its strings, truncated to what the length fields hold
+		template <typename Record>
+		static void appendRecord(std::vector<std::uint8_t>& payload, Record record, std::string_view callsign, std::string_view stand, std::string_view remark) {
+			record.callsignLength = static_cast<std::uint8_t>((std::min)(callsign.size(), std::size_t{ 0xFF }));
+			record.standLength = static_cast<std::uint8_t>((std::min)(stand.size(), std::size_t{ 0xFF }));
+			record.remarkLength = static_cast<std::uint16_t>((std::min)(remark.size(), std::size_t{ 0xFFFF }));
+			const auto* bytes = reinterpret_cast<const std::uint8_t*>(&record);
+			payload.insert(payload.end(), bytes, bytes + sizeof(record));
+			payload.insert(payload.end(), callsign.begin(), callsign.begin() + record.callsignLength);
+			payload.insert(payload.end(), stand.begin(), stand.begin() + record.standLength);
+			payload.insert(payload.end(), remark.begin(), remark.begin() + record.remarkLength);
+		}
+
+		// Bounds-checked walk over the payload
+		struct Reader {
+			const std::uint8_t* payload;
+			std::size_t size;
+			std::size_t offset = 0;
+
+			template <typename Record>
+			bool next(Record& record, Text& text) {
+				if (size - offset < sizeof(record)) return false;
+				std::memcpy(&record, payload + offset, sizeof(record));
+				offset += sizeof(record);
+				const std::size_t length = static_cast<std::size_t>(record.callsignLength) + record.standLength + record.remarkLength;
+				if (size - offset < length) return false;
+				const char* chars = reinterpret_cast<const char*>(payload + offset);
+				offset += length;
+				text.callsign = std::string_view(chars, record.callsignLength);
+				text.stand = std::string_view(chars + record.callsignLength, record.standLength);
+				text.remark = std::string_view(chars + record.callsignLength + record.standLength, record.remarkLength);
+				return true;
+			}
+		};
+	};
+
+} // namespace rampAgent
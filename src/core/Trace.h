@@ -0,0 +1,190 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Lightweight span tracer exporting Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+// Each thread records into its own fixed-size ring, so recording never takes a lock. Rings are
+// created on a thread's first span while tracing is enabled; until then a thread only keeps its
+// name. When tracing is disabled a span costs a single relaxed atomic load.
+
+namespace rampAgent {
+namespace trace {
+
+	struct Event {
+		std::atomic<const char*> name{ nullptr }; // must point to a string literal
+		std::atomic<std::uint64_t> startUs{ 0 };
+		std::atomic<std::uint64_t> durationUs{ 0 };
+	};
+
+	class ThreadBuffer {
+	public:
+		static constexpr std::size_t CAPACITY = 4096;
+
+		explicit ThreadBuffer(std::uint32_t tid) : tid_(tid) {}
+
+		// Single writer: the owning thread
+		void record(const char* name, std::uint64_t startUs, std::uint64_t durationUs) {
+			const std::uint64_t index = head_.load(std::memory_order_relaxed);
+			Event& ev = events_[index % CAPACITY];
+			ev.name.store(name, std::memory_order_relaxed);
+			ev.startUs.store(startUs, std::memory_order_relaxed);
+			ev.durationUs.store(durationUs, std::memory_order_relaxed);
+			head_.store(index + 1, std::memory_order_release);
+		}
+
+		template <typename Fn>
+		void forEach(Fn&& fn) const {
+			const std::uint64_t end = head_.load(std::memory_order_acquire);
+			const std::uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+			for (std::uint64_t i = begin; i < end; ++i) {
+				const Event& ev = events_[i % CAPACITY];
+				const char* name = ev.name.load(std::memory_order_relaxed);
+				if (name == nullptr) continue;
+				fn(name, ev.startUs.load(std::memory_order_relaxed), ev.durationUs.load(std::memory_order_relaxed));
+			}
+		}
+
+		void clear() { head_.store(0, std::memory_order_release); }
+
+		std::uint32_t tid() const { return tid_; }
+
+		std::atomic<bool> inUse{ true };
+		std::atomic<const char*> label{ nullptr };
+
+	private:
+		std::uint32_t tid_;
+		std::atomic<std::uint64_t> head_{ 0 };
+		std::array<Event, CAPACITY> events_;
+	};
+
+	class Tracer {
+	public:
+		static constexpr const char* DEFAULT_THREAD_NAME = "RampAgent worker";
+
+		static Tracer& instance() {
+			static Tracer tracer;
+			return tracer;
+		}
+
+		bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+		void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+		std::uint64_t nowUs() const {
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - epoch_).count());
+		}
+
+		void record(const char* name, std::uint64_t startUs, std::uint64_t durationUs) {
+			threadBuffer().record(name, startUs, durationUs);
+		}
+
+		// Label shown for the calling thread in the exported timeline, must point to a string literal.
+		// Doesn't create the thread's ring.
+		void setThreadName(const char* name) {
+			BufferLease& lease = threadLease();
+			lease.name = name;
+			if (lease.buffer != nullptr) lease.buffer->label.store(name, std::memory_order_relaxed);
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock(buffersMutex_);
+			for (auto& buffer : buffers_) buffer->clear();
+		}
+
+		// Writes every buffered span as a Chrome trace JSON file, returns the number of events written
+		std::size_t dump(const std::string& path) {
+			std::ofstream out(path, std::ios::trunc);
+			if (!out) return 0;
+
+			std::size_t count = 0;
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+			std::lock_guard<std::mutex> lock(buffersMutex_);
+			for (const auto& buffer : buffers_) {
+				out << (count ? "," : "") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid()
+					<< ",\"args\":{\"name\":\"" << buffer->label.load(std::memory_order_relaxed) << "\"}}";
+				++count;
+				buffer->forEach([&](const char* name, std::uint64_t startUs, std::uint64_t durationUs) {
+					out << ",{\"name\":\"" << name << "\",\"cat\":\"rampAgent\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid()
+						<< ",\"ts\":" << startUs << ",\"dur\":" << durationUs << "}";
+					++count;
+				});
+			}
+			out << "]}\n";
+			return count;
+		}
+
+	private:
+		Tracer() : epoch_(std::chrono::steady_clock::now()) {}
+
+		// Releases the buffer on thread exit so short-lived worker threads recycle it instead of growing the registry
+		struct BufferLease {
+			ThreadBuffer* buffer = nullptr;
+			const char* name = DEFAULT_THREAD_NAME;
+			~BufferLease() { if (buffer) buffer->inUse.store(false, std::memory_order_release); }
+		};
+
+		static BufferLease& threadLease() {
+			thread_local BufferLease lease;
+			return lease;
+		}
+
+		ThreadBuffer& threadBuffer() {
+			BufferLease& lease = threadLease();
+			if (lease.buffer == nullptr) lease.buffer = acquireBuffer(lease.name);
+			return *lease.buffer;
+		}
+
+		ThreadBuffer* acquireBuffer(const char* name) {
+			std::lock_guard<std::mutex> lock(buffersMutex_);
+			for (auto& buffer : buffers_) {
+				bool expected = false;
+				if (buffer->inUse.compare_exchange_strong(expected, true)) {
+					buffer->label.store(name, std::memory_order_relaxed);
+					return buffer.get();
+				}
+			}
+			buffers_.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers_.size())));
+			buffers_.back()->label.store(name, std::memory_order_relaxed);
+			return buffers_.back().get();
+		}
+
+		std::atomic<bool> enabled_{ false };
+		std::chrono::steady_clock::time_point epoch_;
+		std::mutex buffersMutex_;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+	};
+
+	class ScopedSpan {
+	public:
+		explicit ScopedSpan(const char* name) {
+			Tracer& tracer = Tracer::instance();
+			if (!tracer.enabled()) return;
+			name_ = name;
+			startUs_ = tracer.nowUs();
+		}
+		~ScopedSpan() {
+			if (name_ == nullptr) return;
+			Tracer& tracer = Tracer::instance();
+			tracer.record(name_, startUs_, tracer.nowUs() - startUs_);
+		}
+		ScopedSpan(const ScopedSpan&) = delete;
+		ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+	private:
+		const char* name_ = nullptr;
+		std::uint64_t startUs_ = 0;
+	};
+
+} // namespace trace
+} // namespace rampAgent
+
+#define RAMPAGENT_TRACE_CONCAT_INNER(a, b) a##b
+#define RAMPAGENT_TRACE_CONCAT(a, b) RAMPAGENT_TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) ::rampAgent::trace::ScopedSpan RAMPAGENT_TRACE_CONCAT(traceSpan_, __LINE__)(name)
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+#include "core/StringTable.h"
+
+// Cooperative scheduler for UI-thread work.
+// Updates are queued per priority and applied in slices bounded by a time budget, the remainder
+// is carried over to the next OnTimer tick. Queuing a newer update for the same callsign
+// supersedes the older one still waiting, so a backlog never applies stale values.
+
+namespace rampAgent {
+
+	enum class UpdatePriority : std::uint8_t {
+		High = 0, // on ground: what the controller is looking at
+		Low,
+		Count
+	};
+
+	template <typename Item> // Item must expose a CallsignId `callsign` member
+	class UpdateScheduler {
+	public:
+		void push(const Item& item, UpdatePriority priority) {
+			const std::uint32_t sequence = ++sequence_;
+			latest_[item.callsign] = sequence;
+			queues_[static_cast<std::size_t>(priority)].push_back({ item, sequence });
+		}
+
+		// Applies queued items, highest priority first, until the budget is spent. Returns the number applied.
+		template <typename ApplyFn>
+		std::size_t run(std::chrono::microseconds budget, ApplyFn&& apply) {
+			const auto start = std::chrono::steady_clock::now();
+			std::size_t applied = 0;
+			for (auto& queue : queues_) {
+				while (!queue.empty()) {
+					const Queued queued = queue.front();
+					queue.pop_front();
+					const std::uint32_t* latest = latest_.find(queued.item.callsign);
+					if (latest == nullptr || *latest != queued.sequence) continue; // superseded
+					latest_.erase(queued.item.callsign);
+
+					apply(queued.item);
+					// Checking the clock every few items keeps the overhead negligible
+					if ((++applied & 7) == 0 && std::chrono::steady_clock::now() - start >= budget) {
+						recordSlice(start);
+						return applied;
+					}
+				}
+			}
+			if (applied) recordSlice(start);
+			return applied;
+		}
+
+		bool queued(CallsignId callsign) const { return latest_.contains(callsign); }
+		std::size_t backlog() const { return latest_.size(); }
+		std::uint64_t slices() const { return slices_; }
+		std::uint64_t worstSliceUs() const { return worstSliceUs_; }
+
+	private:
+		struct Queued {
+			Item item;
+			std::uint32_t sequence;
+		};
+
+		void recordSlice(std::chrono::steady_clock::time_point start) {
+			++slices_;
+			const auto us = static_cast<std::uint64_t>(
+				std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+			if (us > worstSliceUs_) worstSliceUs_ = us;
+		}
+
+		std::array<std::deque<Queued>, static_cast<std::size_t>(UpdatePriority::Count)> queues_;
+		IdMap<std::uint32_t> latest_; // sequence of the newest queued update per callsign
+		std::uint32_t sequence_ = 0;
+		std::uint64_t slices_ = 0;
+		std::uint64_t worstSliceUs_ = 0;
+	};
+
+} // namespace rampAgent
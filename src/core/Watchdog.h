@@ -0,0 +1,174 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/EventLog.h"
+
+// Watchdog for EuroScope UI-thread callbacks.
+// Every callback is timestamped on entry/exit; blocking operations performed inside it
+// (thread join, synchronous HTTP, mutex wait) are timed separately so a callback exceeding
+// the budget can be attributed to its dominant cause.
+
+namespace rampAgent {
+
+	enum class BlockingOp : std::uint8_t {
+		None = 0,
+		Join,
+		Http,
+		LockWait,
+		Count
+	};
+
+	inline const char* blockingOpName(BlockingOp op) {
+		switch (op) {
+		case BlockingOp::Join: return "thread join";
+		case BlockingOp::Http: return "HTTP";
+		case BlockingOp::LockWait: return "lock wait";
+		default: return "compute";
+		}
+	}
+
+	class Watchdog {
+	private:
+		struct Frame {
+			const char* callback = "";
+			std::chrono::steady_clock::time_point start;
+			std::array<std::uint64_t, static_cast<std::size_t>(BlockingOp::Count)> opUs{};
+		};
+
+		static inline thread_local Frame* current_ = nullptr;
+
+	public:
+		static constexpr std::size_t LOG_SIZE = 64;
+
+		struct Stall {
+			std::chrono::system_clock::time_point when;
+			const char* callback = "";
+			std::uint64_t durationUs = 0;
+			BlockingOp cause = BlockingOp::None;
+			std::uint64_t causeUs = 0;
+		};
+
+		// Times one UI-thread callback; nested callbacks are folded into the outermost one
+		class CallbackScope {
+		public:
+			CallbackScope(Watchdog& watchdog, const char* callback) : watchdog_(watchdog) {
+				if (current_ != nullptr) return;
+				frame_.callback = callback;
+				frame_.start = std::chrono::steady_clock::now();
+				current_ = &frame_;
+				active_ = true;
+			}
+			~CallbackScope() {
+				if (!active_) return;
+				current_ = nullptr;
+				watchdog_.finish(frame_);
+			}
+			CallbackScope(const CallbackScope&) = delete;
+			CallbackScope& operator=(const CallbackScope&) = delete;
+
+		private:
+			Watchdog& watchdog_;
+			Frame frame_;
+			bool active_ = false;
+		};
+
+		// Attributes the enclosed wait to the running callback, no-op outside UI callbacks
+		class OpScope {
+		public:
+			explicit OpScope(BlockingOp op) : op_(op) {
+				if (current_ != nullptr) start_ = std::chrono::steady_clock::now();
+			}
+			~OpScope() {
+				if (current_ == nullptr) return;
+				current_->opUs[static_cast<std::size_t>(op_)] += static_cast<std::uint64_t>(
+					std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count());
+			}
+			OpScope(const OpScope&) = delete;
+			OpScope& operator=(const OpScope&) = delete;
+
+		private:
+			BlockingOp op_;
+			std::chrono::steady_clock::time_point start_;
+		};
+
+		// Locks the mutex, accounting the time spent waiting as BlockingOp::LockWait
+		template <typename Mutex>
+		static std::unique_lock<Mutex> acquire(Mutex& mutex) {
+			std::unique_lock<Mutex> lock(mutex, std::try_to_lock);
+			if (!lock.owns_lock()) {
+				OpScope op(BlockingOp::LockWait);
+				lock.lock();
+			}
+			return lock;
+		}
+
+		void setBudgetUs(std::uint64_t budgetUs) { budgetUs_.store(budgetUs, std::memory_order_relaxed); }
+		std::uint64_t budgetUs() const { return budgetUs_.load(std::memory_order_relaxed); }
+
+		std::uint64_t callbackCount() const { return callbackCount_.load(std::memory_order_relaxed); }
+		std::uint64_t stallCount() const { return stallCount_.load(std::memory_order_relaxed); }
+		std::uint64_t worstUs() const { return worstUs_.load(std::memory_order_relaxed); }
+
+		// Most recent stalls first
+		std::vector<Stall> recentStalls(std::size_t max = LOG_SIZE) const {
+			std::lock_guard<std::mutex> lock(logMutex_);
+			std::vector<Stall> result;
+			const std::size_t available = (std::min)(static_cast<std::size_t>(stallCount_.load(std::memory_order_relaxed)), LOG_SIZE);
+			for (std::size_t i = 0; i < available && i < max; ++i) {
+				result.push_back(log_[(logHead_ + LOG_SIZE - 1 - i) % LOG_SIZE]);
+			}
+			return result;
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock(logMutex_);
+			logHead_ = 0;
+			stallCount_.store(0, std::memory_order_relaxed);
+			callbackCount_.store(0, std::memory_order_relaxed);
+			worstUs_.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		void finish(const Frame& frame) {
+			const std::uint64_t durationUs = static_cast<std::uint64_t>(
+				std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frame.start).count());
+			callbackCount_.fetch_add(1, std::memory_order_relaxed);
+			if (durationUs > worstUs_.load(std::memory_order_relaxed)) worstUs_.store(durationUs, std::memory_order_relaxed);
+			if (durationUs <= budgetUs()) return;
+
+			Stall stall;
+			stall.when = std::chrono::system_clock::now();
+			stall.callback = frame.callback;
+			stall.durationUs = durationUs;
+			for (std::size_t i = 1; i < frame.opUs.size(); ++i) {
+				if (frame.opUs[i] > stall.causeUs) {
+					stall.causeUs = frame.opUs[i];
+					stall.cause = static_cast<BlockingOp>(i);
+				}
+			}
+
+			EventLog::instance().record("ui stall", frame.start, 0, 0, std::string(frame.callback) + (stall.cause != BlockingOp::None ? std::string(", ") + blockingOpName(stall.cause) + " " + std::to_string(stall.causeUs) + " us" : std::string()));
+
+			std::lock_guard<std::mutex> lock(logMutex_);
+			log_[logHead_] = stall;
+			logHead_ = (logHead_ + 1) % LOG_SIZE;
+			stallCount_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::atomic<std::uint64_t> budgetUs_{ 5000 }; // 5ms
+		std::atomic<std::uint64_t> callbackCount_{ 0 };
+		std::atomic<std::uint64_t> stallCount_{ 0 };
+		std::atomic<std::uint64_t> worstUs_{ 0 };
+		mutable std::mutex logMutex_;
+		std::array<Stall, LOG_SIZE> log_{};
+		std::size_t logHead_ = 0;
+	};
+
+} // namespace rampAgent
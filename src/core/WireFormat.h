@@ -0,0 +1,47 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+// API payload formats.
+// Requests advertise the binary encodings first, the server answers in whichever it supports and
+// the body is decoded according to its Content-Type. Anything unrecognised is parsed as JSON, so
+// servers that only speak JSON keep working unchanged.
+
+namespace rampAgent {
+
+	constexpr const char* API_ACCEPT = "application/cbor, application/msgpack;q=0.9, application/json;q=0.8";
+
+	enum class WireFormat {
+		Json,
+		Cbor,
+		MessagePack
+	};
+
+	// Media type only, parameters (charset, ...) ignored
+	inline WireFormat wireFormatOf(std::string_view contentType) {
+		contentType = contentType.substr(0, contentType.find(';'));
+		while (!contentType.empty() && std::isspace(static_cast<unsigned char>(contentType.back()))) contentType.remove_suffix(1);
+		std::string type(contentType);
+		std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		if (type == "application/cbor") return WireFormat::Cbor;
+		if (type == "application/msgpack" || type == "application/x-msgpack" || type == "application/vnd.msgpack") return WireFormat::MessagePack;
+		return WireFormat::Json;
+	}
+
+	// Throws nlohmann::json::exception on malformed payloads, like parse()
+	inline nlohmann::ordered_json decodePayload(std::string_view contentType, const std::string& body) {
+		switch (wireFormatOf(contentType)) {
+		case WireFormat::Cbor:
+			return nlohmann::ordered_json::from_cbor(body);
+		case WireFormat::MessagePack:
+			return nlohmann::ordered_json::from_msgpack(body);
+		default:
+			return nlohmann::ordered_json::parse(body);
+		}
+	}
+
+} // namespace rampAgent
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Check.h"
+#include "core/Annotations.h"
+#include "core/GroundState.h"
+
+// Replays an hour of traffic at a busy airport and counts flight strip annotation writes, the way
+// UpdateTagItems wrote them before AnnotationSync (both slots on every poll for every assigned
+// aircraft on ground) and the way the plugin writes them now (only changes, applied on the next
+// tick or at the landing). Every write is propagated to the other controllers by EuroScope.
+// Usage: AnnotationReplay [seed]
+
+using namespace rampAgent;
+
+namespace {
+
+	constexpr int GROUND_SPEED_KT = 60; // RampAgent.h GROUND_SPEED_THRESHOLD
+	constexpr int HOUR = 3600, POLL_INTERVAL = 15, RADAR_INTERVAL = 5; // s, OnTimer ticks
+	constexpr int ARRIVALS = 90, DEPARTURES = 80; // per hour
+	constexpr StandId STANDS = 150;
+
+	struct Flight {
+		CallsignId callsign;
+		int start, end;         // s, on radar from start to end
+		int landing = -1;       // s, arrivals: airborne before
+		int pushback = -1;      // s, departures: parked before
+		int takeoff = -1;       // s, departures: airborne after
+		StandId stand;
+		StandId reassigned = EMPTY_ID; // from reassignAt on
+		int reassignAt = HOUR;
+		StringId remark;
+
+		bool active(int t) const { return t >= start && t < end; }
+		StandId standAt(int t) const { return t >= reassignAt ? reassigned : stand; }
+
+		int groundSpeed(int t) const {
+			if (landing >= 0) {
+				if (t < landing) return 140 + (t * 7 + static_cast<int>(callsign)) % 110;
+				return t < landing + 300 ? 15 + (t + static_cast<int>(callsign)) % 10 : 0; // taxi in, then parked
+			}
+			if (t < pushback) return 0;
+			return t < takeoff ? 12 + (t + static_cast<int>(callsign)) % 12 : 160 + (t - takeoff);
+		}
+	};
+
+	struct Strip {
+		StandId stand = EMPTY_ID; // slot 3
+		StringId remark = EMPTY_ID; // slot 4
+	};
+
+	std::vector<Flight> traffic(unsigned seed) {
+		std::mt19937 random(seed);
+		const auto uniform = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(random); };
+		std::vector<Flight> flights;
+		CallsignId callsign = 1;
+		for (int i = 0; i < ARRIVALS; ++i) {
+			Flight flight{};
+			flight.callsign = callsign++;
+			flight.start = i * HOUR / ARRIVALS;
+			flight.landing = flight.start + uniform(600, 1200);
+			flight.end = (std::min)(HOUR, flight.landing + uniform(900, 2400)); // parked, then off the network
+			flight.stand = static_cast<StandId>(1 + uniform(0, STANDS - 1));
+			if (uniform(0, 99) < 15 && flight.end - flight.start > 60) { // the server moves 15% to another stand, before or after landing
+				flight.reassigned = static_cast<StandId>(1 + uniform(0, STANDS - 1));
+				flight.reassignAt = flight.start + uniform(60, flight.end - flight.start);
+			}
+			flight.remark = static_cast<StringId>(uniform(0, 3) == 0 ? uniform(1, 3) : 0);
+			flights.push_back(flight);
+		}
+		for (int i = 0; i < DEPARTURES; ++i) {
+			Flight flight{};
+			flight.callsign = callsign++;
+			flight.start = 0; // parked with an occupied stand from the first poll
+			flight.pushback = uniform(60, HOUR - 600);
+			flight.takeoff = flight.pushback + uniform(300, 900);
+			flight.end = (std::min)(HOUR, flight.takeoff + 300);
+			flight.stand = static_cast<StandId>(1 + uniform(0, STANDS - 1));
+			flight.remark = static_cast<StringId>(uniform(0, 3) == 0 ? uniform(1, 3) : 0);
+			flights.push_back(flight);
+		}
+		return flights;
+	}
+
+	struct Counts {
+		std::uint64_t before = 0, after = 0;
+	};
+
+	Counts replay(const std::vector<Flight>& flights) {
+		Counts writes;
+		std::vector<Strip> after(flights.size() + 1);
+		AnnotationSync annotations;
+		GroundStateTracker groundState(GROUND_SPEED_KT);
+		const auto write = [&](CallsignId callsign, StandId stand, StringId remark, bool writeStand, bool writeRemark) -> int {
+			Strip& strip = after[callsign];
+			int written = 0;
+			if (writeStand && strip.stand != stand) {
+				strip.stand = stand;
+				++written;
+			}
+			if (writeRemark && strip.remark != remark) {
+				strip.remark = remark;
+				++written;
+			}
+			return written;
+		};
+
+		for (int t = 0; t < HOUR; ++t) {
+			for (const Flight& flight : flights) {
+				if (t == flight.end) {
+					annotations.forget(flight.callsign);
+					groundState.forget(flight.callsign);
+				}
+				if (!flight.active(t) || (t - flight.start) % RADAR_INTERVAL != 0) continue;
+				// OnRadarTargetPositionUpdate: a landing applies the pending write at once
+				if (groundState.update(flight.callsign, flight.groundSpeed(t)) == GroundTransition::Landed && annotations.isPending(flight.callsign)) {
+					annotations.flush(write, flight.callsign);
+				}
+			}
+
+			if (t % POLL_INTERVAL == 0) {
+				for (const Flight& flight : flights) {
+					if (!flight.active(t)) continue;
+					// Before: UpdateTagItems wrote both slots for every assigned aircraft on ground
+					if (flight.groundSpeed(t) <= GROUND_SPEED_KT) writes.before += 2;
+					// Now: only the desired value is recorded
+					annotations.set(flight.callsign, flight.standAt(t), flight.remark);
+				}
+			}
+
+			// OnTimer: flushAnnotations(), airborne aircraft stay pending
+			annotations.flush([&](CallsignId callsign, StandId stand, StringId remark, bool writeStand, bool writeRemark) -> int {
+				if (!groundState.isOnGround(callsign)) return -1;
+				return write(callsign, stand, remark, writeStand, writeRemark);
+			});
+
+			// Every aircraft the tracker has on ground shows its current stand and remark by the end of the tick
+			for (const Flight& flight : flights) {
+				if (!flight.active(t) || !groundState.isOnGround(flight.callsign) || t - flight.start < POLL_INTERVAL) continue;
+				const Strip& strip = after[flight.callsign];
+				CHECK(strip.stand == flight.standAt(t - t % POLL_INTERVAL) && strip.remark == flight.remark);
+			}
+		}
+		writes.after = annotations.writes();
+		return writes;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const unsigned seed = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 30;
+	const std::vector<Flight> flights = traffic(seed);
+	const Counts writes = replay(flights);
+	CHECK(writes.after > 0 && writes.after * 10 < writes.before);
+
+	std::printf("AnnotationReplay: %d arrivals, %d departures, a poll every %d s for an hour\n", ARRIVALS, DEPARTURES, POLL_INTERVAL);
+	std::printf("  every poll   %7llu annotation writes per hour\n", static_cast<unsigned long long>(writes.before));
+	std::printf("  changes only %7llu annotation writes per hour\n", static_cast<unsigned long long>(writes.after));
+	std::puts("AnnotationReplay: ok");
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "core/Callsign.h"
+
+// Finds every radar target of a busy sector by callsign, the way aircraftExists() did before
+// Callsign (toUpper() copies of both sides, then std::string ==) and the ways it can be done now,
+// and checks they agree. Usage: CallsignBench [rounds]
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	constexpr std::size_t TARGETS = 500;
+
+	// The former RampAgent::toUpper
+	std::string toUpper(std::string str) {
+		std::string result = str;
+		std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+		return result;
+	}
+
+	// Callsigns as EuroScope hands them out, in mixed case as typed by pilots
+	std::vector<std::string> radarCallsigns() {
+		const char* airlines[] = { "AFR", "EZY", "DLH", "BAW", "RYR", "HOP", "UAE", "KLM", "swr", "Tap" };
+		std::mt19937 random(11);
+		std::vector<std::string> callsigns;
+		for (std::size_t i = 0; i < TARGETS; ++i) {
+			std::string callsign = std::string(airlines[i % 10]) + std::to_string(100 + i * 7) + (i % 3 == 0 ? "A" : "");
+			if (random() % 4 == 0) callsign[0] = static_cast<char>(std::tolower(static_cast<unsigned char>(callsign[0])));
+			callsigns.push_back(callsign);
+		}
+		return callsigns;
+	}
+
+	struct Result {
+		double nsPerCompare;
+		std::size_t checksum;
+	};
+
+	// Every target looked up by a linear scan over the targets, compare(i, j) tests target j against query i
+	template <typename Compare>
+	Result scan(int rounds, Compare&& compare) {
+		std::size_t checksum = 0, compares = 0;
+		const auto start = Clock::now();
+		for (int round = 0; round < rounds; ++round) {
+			for (std::size_t query = 0; query < TARGETS; ++query) {
+				for (std::size_t target = 0; target < TARGETS; ++target) {
+					++compares;
+					if (compare(query, target)) {
+						checksum += target;
+						break;
+					}
+				}
+			}
+		}
+		const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		return { ns / static_cast<double>(compares), checksum };
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 8;
+	const std::vector<std::string> targets = radarCallsigns();
+	std::vector<std::string> queries; // as stored by the plugin: upper case
+	for (const std::string& callsign : targets) queries.push_back(toUpper(callsign));
+	std::vector<const char*> raw; // CRadarTarget::GetCallsign()
+	for (const std::string& callsign : targets) raw.push_back(callsign.c_str());
+
+	std::vector<Callsign> packedQueries, packedTargets;
+	for (const std::string& callsign : queries) packedQueries.emplace_back(callsign);
+	for (const char* callsign : raw) packedTargets.emplace_back(callsign);
+	CallsignTable table;
+	for (const char* callsign : raw) table.intern(Callsign(callsign));
+
+	const Result before = scan(rounds, [&](std::size_t q, std::size_t t) { return toUpper(raw[t]) == toUpper(queries[q]); });
+	const Result construct = scan(rounds, [&](std::size_t q, std::size_t t) { return Callsign(raw[t]) == packedQueries[q]; });
+	const Result packed = scan(rounds, [&](std::size_t q, std::size_t t) { return packedTargets[t] == packedQueries[q]; });
+	CHECK(before.checksum == construct.checksum && before.checksum == packed.checksum);
+	CHECK(before.checksum == static_cast<std::size_t>(rounds) * TARGETS * (TARGETS - 1) / 2);
+
+	// What the plugin does now: one hash lookup in the intern table instead of a scan
+	std::size_t found = 0;
+	const auto start = Clock::now();
+	for (int round = 0; round < rounds; ++round) {
+		for (std::size_t query = 0; query < TARGETS; ++query) found += table.find(Callsign(raw[query])) != NO_ID ? 1 : 0;
+	}
+	const double lookupNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(rounds * TARGETS);
+	CHECK(found == static_cast<std::size_t>(rounds) * TARGETS);
+
+	std::printf("CallsignBench: %zu targets, %d rounds\n", TARGETS, rounds);
+	std::printf("  toUpper + std::string ==       %7.1f ns/compare\n", before.nsPerCompare);
+	std::printf("  Callsign(const char*) + ==     %7.1f ns/compare\n", construct.nsPerCompare);
+	std::printf("  pre-packed Callsign ==         %7.1f ns/compare\n", packed.nsPerCompare);
+	std::printf("  CallsignTable::find            %7.1f ns/lookup\n", lookupNs);
+	std::puts("CallsignBench: ok");
+	return 0;
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "core/CatalogueCache.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	// 400 stands around a point, some unlocated, with codes, use labels and zones
+	std::shared_ptr<const StandCatalogue> catalogueOf(AirportId airport, double latitude, double longitude, StringTable& standNames) {
+		auto catalogue = std::make_shared<StandCatalogue>();
+		catalogue->airport = airport;
+		catalogue->fetched = std::chrono::system_clock::time_point(std::chrono::seconds(1'760'000'000 + airport));
+		const char* codes[] = { "C", "BC", "CDE", "EF", "" };
+		const char* uses[] = { "", "AFR HOP", "CARGO", "", "GA/DHL" };
+		for (int i = 0; i < 400; ++i) {
+			StandInfo stand;
+			stand.name = standNames.intern(std::string(1, static_cast<char>('A' + i / 50)) + std::to_string(i % 50 + 1));
+			stand.hasPosition = i % 37 != 0;
+			if (stand.hasPosition) {
+				stand.latitude = latitude + (i / 20) * 0.0009;
+				stand.longitude = longitude + (i % 20) * 0.0013;
+				stand.radius = 20.0 + i % 30;
+			}
+			stand.code = codes[i % 5];
+			stand.use = uses[i % 5];
+			stand.schengen = i % 3 != 0;
+			catalogue->stands.push_back(stand);
+		}
+		catalogue->finalize(standNames);
+		return catalogue;
+	}
+
+	std::vector<char> readBytes(const std::string& path) {
+		std::ifstream in(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	void writeBytes(const std::string& path, const std::vector<char>& bytes) {
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	// Fresh tables each time, as at plugin load
+	std::size_t load(const std::string& path, CatalogueCache::Catalogues& out) {
+		StringTable standNames;
+		StringTable airports{ true };
+		return CatalogueCache::read(path, standNames, airports, out);
+	}
+
+}
+
+int main() {
+	const std::string path = (std::filesystem::temp_directory_path() / "RampAgentCatalogueCacheTest.bin").string();
+	const std::string damaged = path + ".damaged";
+
+	StringTable standNames;
+	StringTable airports{ true };
+	CatalogueCache::Catalogues written;
+	const struct { const char* icao; double latitude, longitude; } sites[] = { { "LFPG", 49.0, 2.55 }, { "LFMN", 43.66, 7.21 }, { "LFLL", 45.72, 5.08 } };
+	for (const auto& site : sites) {
+		const AirportId airport = airports.intern(site.icao);
+		written[airport] = catalogueOf(airport, site.latitude, site.longitude, standNames);
+	}
+	CHECK(CatalogueCache::write(path, written, standNames, airports));
+	CHECK(!std::filesystem::exists(path + ".tmp"));
+
+	// Round trip into other tables: same stands in the same order, same index answers
+	StringTable readNames;
+	StringTable readAirports{ true };
+	CatalogueCache::Catalogues read;
+	const auto start = std::chrono::steady_clock::now();
+	CHECK(CatalogueCache::read(path, readNames, readAirports, read) == 3);
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	for (const auto& [airport, original] : written) {
+		const auto it = read.find(readAirports.find(airports.view(airport)));
+		CHECK(it != read.end());
+		const StandCatalogue& copy = *it->second;
+		CHECK(copy.fetched == original->fetched && copy.stands.size() == original->stands.size());
+		for (std::size_t i = 0; i < copy.stands.size(); ++i) {
+			const StandInfo& a = original->stands[i];
+			const StandInfo& b = copy.stands[i];
+			CHECK(standNames.view(a.name) == readNames.view(b.name));
+			CHECK(a.hasPosition == b.hasPosition && a.latitude == b.latitude && a.longitude == b.longitude && a.radius == b.radius);
+			CHECK(a.code == b.code && a.use == b.use && a.schengen == b.schengen);
+		}
+		const StandInfo& probe = original->stands[10];
+		const auto all = [](std::uint32_t) { return true; };
+		CHECK(copy.index.nearest(probe.latitude, probe.longitude, 5, all) == original->index.nearest(probe.latitude, probe.longitude, 5, all));
+	}
+
+	// Anything that does not validate loads nothing and leaves the output untouched
+	const std::vector<char> good = readBytes(path);
+	constexpr std::size_t HEADER = 32, VERSION_OFFSET = 8;
+	auto rejected = [&](std::vector<char> bytes) {
+		writeBytes(damaged, bytes);
+		CatalogueCache::Catalogues out;
+		out[1] = nullptr;
+		return load(damaged, out) == 0 && out.size() == 1;
+	};
+	CHECK(rejected({}));                                                                          // empty
+	CHECK(rejected(std::vector<char>(good.begin(), good.begin() + HEADER - 1)));                   // shorter than the header
+	CHECK(rejected(std::vector<char>(good.begin(), good.end() - 1)));                              // truncated payload
+	CHECK(rejected(std::vector<char>(good.begin(), good.begin() + good.size() / 2)));
+	for (std::size_t at : { HEADER, HEADER + 30, good.size() / 2, good.size() - 1 }) {             // a flipped byte
+		std::vector<char> flipped = good;
+		flipped[at] ^= 0x01;
+		CHECK(rejected(flipped));
+	}
+	std::vector<char> bumped = good;                                                               // another layout version
+	CHECK(static_cast<std::uint8_t>(bumped[VERSION_OFFSET]) == CatalogueCache::VERSION);
+	bumped[VERSION_OFFSET] = static_cast<char>(CatalogueCache::VERSION + 1);
+	CHECK(rejected(bumped));
+	std::vector<char> magic = good;
+	magic[0] = 'X';
+	CHECK(rejected(magic));
+	CHECK(!rejected(good));
+	std::filesystem::remove(damaged);
+	CHECK(load(damaged, read) == 0); // missing file
+
+	std::printf("CatalogueCacheTest: 3 airports, %zu bytes, read in %.3f ms\n", good.size(), ms);
+	std::filesystem::remove(path);
+	std::puts("CatalogueCacheTest: ok");
+	return 0;
+}
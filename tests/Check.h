@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+// assert() is compiled out in Release, test checks are not
+#define CHECK(condition)                                                                   \
+	do {                                                                                   \
+		if (!(condition)) {                                                                \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			std::exit(1);                                                                  \
+		}                                                                                  \
+	} while (false)
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "Check.h"
+#include "core/DnsCache.h"
+
+using namespace rampAgent;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	// A resolver taking delay per call, answering 10.0.0.<call number> until told to fail
+	struct DelayedResolver {
+		std::atomic<int> calls{ 0 };
+		std::atomic<bool> failing{ false };
+		std::chrono::milliseconds delay;
+		std::chrono::milliseconds ttl;
+
+		std::optional<DnsCache::Resolution> operator()(const std::string&) {
+			const int call = ++calls;
+			std::this_thread::sleep_for(delay);
+			if (failing) return std::nullopt;
+			return DnsCache::Resolution{ { "10.0.0." + std::to_string(call) }, ttl };
+		}
+	};
+
+	DnsCache::Timing shortTiming() {
+		DnsCache::Timing timing;
+		timing.minTtl = 300ms;
+		timing.refreshAhead = 150ms;
+		timing.retryDelay = 50ms;
+		timing.firstLookupTimeout = 200ms;
+		return timing;
+	}
+
+	// A first lookup slower than FIRST_LOOKUP_TIMEOUT gives up, the address is cached once resolved
+	void firstLookupTimeout() {
+		auto resolver = std::make_shared<DelayedResolver>();
+		resolver->delay = 600ms;
+		resolver->ttl = 10s;
+		DnsCache dns([resolver](const std::string& host) { return (*resolver)(host); }, shortTiming());
+
+		auto start = Clock::now();
+		CHECK(dns.lookup("api.test").empty());
+		const auto waited = Clock::now() - start;
+		CHECK(waited >= 190ms && waited < 500ms);
+
+		// Another caller meanwhile doesn't start a second resolution
+		CHECK(dns.lookup("api.test").empty());
+		std::this_thread::sleep_for(600ms);
+		start = Clock::now();
+		CHECK(dns.lookup("api.test") == "10.0.0.1");
+		CHECK(Clock::now() - start < 20ms);
+		CHECK(resolver->calls == 1 && dns.misses() == 2 && dns.hits() == 1);
+
+		// Cancelled while waiting: returns at once
+		CancelSource cancel;
+		std::thread canceller([&] {
+			std::this_thread::sleep_for(50ms);
+			cancel.cancel();
+		});
+		start = Clock::now();
+		CHECK(dns.lookup("other.test", cancel.token()).empty());
+		CHECK(Clock::now() - start < 150ms);
+		canceller.join();
+	}
+
+	// Entries are re-resolved before they expire: lookups never wait again and never see a stale
+	// address, and a failing resolver leaves the last address served
+	void refreshAhead() {
+		auto resolver = std::make_shared<DelayedResolver>();
+		resolver->delay = 50ms;
+		resolver->ttl = 300ms;
+		DnsCache dns([resolver](const std::string& host) { return (*resolver)(host); }, shortTiming());
+
+		CHECK(dns.lookup("api.test") == "10.0.0.1");
+		auto slowest = Clock::duration::zero();
+		std::string address;
+		const auto until = Clock::now() + 1s;
+		while (Clock::now() < until) {
+			const auto start = Clock::now();
+			address = dns.lookup("api.test");
+			slowest = (std::max)(slowest, Clock::now() - start);
+			CHECK(!address.empty());
+			std::this_thread::sleep_for(10ms);
+		}
+		// Refreshed every ~150 ms: resolved at 50 ms, then 150 ms before each expiry
+		CHECK(resolver->calls >= 5);
+		CHECK(address != "10.0.0.1");
+		CHECK(slowest < 20ms);
+		CHECK(dns.misses() == 1 && dns.staleHits() == 0 && dns.failures() == 0);
+
+		resolver->failing = true;
+		std::this_thread::sleep_for(100ms); // a resolution in progress fails too
+		address = dns.lookup("api.test");
+		std::this_thread::sleep_for(500ms); // past expiry, retried every retryDelay
+		CHECK(dns.lookup("api.test") == address);
+		CHECK(dns.failures() >= 2 && dns.staleHits() >= 1);
+	}
+
+}
+
+int main() {
+	firstLookupTimeout();
+	refreshAhead();
+	std::puts("DnsCacheTest: ok");
+	return 0;
+}
@@ -0,0 +1,201 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Check.h"
+#include "core/Endpoints.h"
+
+using namespace rampAgent;
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	// Plain HTTP, one connection per call; cancelling shuts the socket down like HttplibClient
+	class PlainClient : public ApiClient {
+	public:
+		ApiResponse get(const std::string& host, const std::string& path, const CancelToken& cancel = {}) override {
+			if (cancel.cancelled()) return {};
+			++requests_;
+			++connections_;
+			const auto [name, port] = splitHost(host);
+			httplib::Client cli(name, port);
+			cli.set_read_timeout(5, 0);
+			auto socket = std::make_shared<std::atomic<socket_t>>(INVALID_SOCKET);
+			cli.set_socket_options([socket](socket_t sock) { socket->store(sock); });
+			httplib::Result res;
+			{
+				CancelRegistration abort = cancel.onCancel([socket] {
+					if (const socket_t sock = socket->load(); sock != INVALID_SOCKET) httplib::detail::shutdown_socket(sock);
+				});
+				if (!cancel.cancelled()) res = cli.Get(path);
+			}
+			if (cancel.cancelled()) {
+				++cancelled_;
+				return {};
+			}
+			ApiResponse response;
+			if (!res) return response;
+			response.status = res->status;
+			response.body = std::move(res->body);
+			return response;
+		}
+
+		const char* name() const override { return "test"; }
+	};
+
+	// Answers every GET with status and body, after delay; release() ends pending delays
+	class TestServer {
+	public:
+		TestServer(int status, std::string body, std::chrono::milliseconds delay = 0ms) {
+			server_.Get(".*", [this, status, body, delay](const httplib::Request&, httplib::Response& response) {
+				++requests_;
+				std::unique_lock<std::mutex> lock(mutex_);
+				released_.wait_for(lock, delay, [this] { return release_; });
+				response.status = status;
+				response.set_content(body, "text/plain");
+			});
+			port_ = server_.bind_to_any_port("127.0.0.1");
+			CHECK(port_ > 0);
+			thread_ = std::thread([this] { server_.listen_after_bind(); });
+			server_.wait_until_ready();
+		}
+
+		~TestServer() {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				release_ = true;
+			}
+			released_.notify_all();
+			server_.stop();
+			thread_.join();
+		}
+
+		// Two names for one server make two endpoints
+		std::string host(const char* name = "127.0.0.1") const { return std::string(name) + ":" + std::to_string(port_); }
+		int requests() const { return requests_; }
+
+	private:
+		httplib::Server server_;
+		std::thread thread_;
+		int port_ = 0;
+		std::atomic<int> requests_{ 0 };
+		std::mutex mutex_;
+		std::condition_variable released_;
+		bool release_ = false;
+	};
+
+	std::chrono::milliseconds since(Clock::time_point start) { return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start); }
+
+	// Primary slow: the hedge fires after DEFAULT_HEDGE_DELAY, its answer wins and the primary is
+	// cancelled. Once ranked by their samples the fast server is tried first and nothing is hedged.
+	void hedgeWins(PlainClient& api) {
+		TestServer slow(200, "slow", 3s), fast(200, "fast");
+		EndpointSet endpoints(slow.host() + "," + fast.host());
+
+		const auto start = Clock::now();
+		const ApiResponse response = endpoints.get(api, "/api/occupancy");
+		const auto took = since(start);
+		CHECK(response.status == 200 && response.body == "fast");
+		CHECK(took >= EndpointSet::DEFAULT_HEDGE_DELAY - 10ms && took < EndpointSet::DEFAULT_HEDGE_DELAY + 300ms);
+		CHECK(endpoints.hedges() == 1 && endpoints.hedgeWins() == 1);
+		CHECK(api.cancelled() == 1 && slow.requests() == 1 && fast.requests() == 1);
+
+		for (std::size_t i = 1; i < EndpointSet::MIN_SAMPLES; ++i) CHECK(endpoints.get(api, "/api/occupancy").body == "fast");
+		const std::uint64_t hedges = endpoints.hedges();
+		for (int i = 0; i < 5; ++i) {
+			const auto call = Clock::now();
+			CHECK(endpoints.get(api, "/api/occupancy").body == "fast");
+			CHECK(since(call) < 100ms);
+		}
+		CHECK(endpoints.hedges() == hedges);
+		CHECK(endpoints.stats()[1].p50 < endpoints.stats()[0].p50);
+	}
+
+	// A 5xx isn't an answer: the hedge goes out at once, then the remaining endpoints in turn
+	void serverErrorFallsThrough(PlainClient& api) {
+		TestServer failing(503, "unavailable"), ok(200, "ok");
+		{
+			EndpointSet endpoints(failing.host() + "," + ok.host());
+			const auto start = Clock::now();
+			const ApiResponse response = endpoints.get(api, "/api/occupancy");
+			CHECK(response.status == 200 && response.body == "ok");
+			CHECK(since(start) < EndpointSet::DEFAULT_HEDGE_DELAY); // didn't wait for the hedge delay
+			CHECK(endpoints.stats()[0].failing && endpoints.stats()[0].failures == 1);
+		}
+		{
+			EndpointSet endpoints(failing.host() + "," + failing.host("localhost") + "," + ok.host());
+			const ApiResponse response = endpoints.get(api, "/api/occupancy");
+			CHECK(response.status == 200 && response.body == "ok");
+			CHECK(endpoints.stats()[0].failing && endpoints.stats()[1].failing && !endpoints.stats()[2].failing);
+
+			// Failed endpoints rank last: the next call goes straight to the one that answered
+			const int before = failing.requests();
+			CHECK(endpoints.get(api, "/api/occupancy").body == "ok");
+			CHECK(failing.requests() == before);
+		}
+		{
+			// Nothing answers: the last server error is returned
+			EndpointSet endpoints(failing.host() + "," + failing.host("localhost"));
+			const ApiResponse response = endpoints.get(api, "/api/occupancy");
+			CHECK(response.status == 503 && response.body == "unavailable");
+		}
+	}
+
+	// The caller cancelling mid-race ends both calls at once
+	void callerCancels(PlainClient& api) {
+		TestServer slow(200, "slow", 3s), slower(200, "slower", 3s);
+		EndpointSet endpoints(slow.host() + "," + slower.host());
+		CancelSource cancel;
+		std::thread canceller([&] {
+			std::this_thread::sleep_for(EndpointSet::DEFAULT_HEDGE_DELAY + 100ms); // both calls out
+			cancel.cancel();
+		});
+		const auto start = Clock::now();
+		const ApiResponse response = endpoints.get(api, "/api/occupancy", cancel.token());
+		const auto took = since(start);
+		canceller.join();
+		CHECK(response.status == 0);
+		CHECK(took < EndpointSet::DEFAULT_HEDGE_DELAY + 200ms);
+		CHECK(endpoints.hedges() == 1 && slow.requests() == 1 && slower.requests() == 1);
+		CHECK(endpoints.stats()[0].samples == 0 && !endpoints.stats()[0].failing); // not held against them
+	}
+
+	// Assignments go to the best endpoint once, however long it takes or whatever it answers
+	void assignmentsAreNotHedged(PlainClient& api) {
+		TestServer slow(200, "assigned", 500ms), failing(503, "unavailable"), other(200, "duplicate");
+		{
+			EndpointSet endpoints(slow.host() + "," + other.host());
+			const ApiResponse response = endpoints.getOnce(api, "/api/assign");
+			CHECK(response.status == 200 && response.body == "assigned");
+			CHECK(endpoints.hedges() == 0 && slow.requests() == 1 && other.requests() == 0);
+			CHECK(endpoints.stats()[0].samples == 1);
+		}
+		{
+			EndpointSet endpoints(failing.host() + "," + other.host());
+			const ApiResponse response = endpoints.getOnce(api, "/api/assign");
+			CHECK(response.status == 503 && failing.requests() == 1 && other.requests() == 0);
+			CHECK(endpoints.stats()[0].failing);
+		}
+	}
+
+}
+
+int main() {
+#ifndef _WIN32
+	std::signal(SIGPIPE, SIG_IGN);
+#endif
+	PlainClient api;
+	hedgeWins(api);
+	serverErrorFallsThrough(api);
+	callerCancels(api);
+	assignmentsAreNotHedged(api);
+	std::puts("EndpointSetTest: ok");
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Check.h"
+#include "core/Annotations.h"
+#include "core/GroundState.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	constexpr int GROUND_SPEED_KT = 60; // RampAgent.h GROUND_SPEED_THRESHOLD
+
+	// 60 kt down, 80 kt up, each after CONFIRMATIONS updates in a row
+	void hysteresis() {
+		GroundStateTracker tracker(GROUND_SPEED_KT);
+		const CallsignId arriving = 1, parked = 2;
+
+		CHECK(tracker.update(arriving, 140) == GroundTransition::None && !tracker.isOnGround(arriving));
+		CHECK(tracker.update(parked, 0) == GroundTransition::Landed && tracker.isOnGround(parked)); // first seen on ground
+
+		// Between the thresholds nothing changes, either way
+		for (int speed : { 79, 70, 61 }) CHECK(tracker.update(arriving, speed) == GroundTransition::None && !tracker.isOnGround(arriving));
+		for (int speed : { 61, 70, 80 }) CHECK(tracker.update(parked, speed) == GroundTransition::None && tracker.isOnGround(parked));
+
+		// One update past the threshold is not enough, and an update back resets the count
+		CHECK(tracker.update(arriving, 60) == GroundTransition::None);
+		CHECK(tracker.update(arriving, 65) == GroundTransition::None);
+		CHECK(tracker.update(arriving, 55) == GroundTransition::None && !tracker.isOnGround(arriving));
+		CHECK(tracker.update(arriving, 50) == GroundTransition::Landed && tracker.isOnGround(arriving));
+		CHECK(tracker.update(arriving, 40) == GroundTransition::None && tracker.isOnGround(arriving));
+
+		CHECK(tracker.update(arriving, 81) == GroundTransition::None);
+		CHECK(tracker.update(arriving, 75) == GroundTransition::None);
+		CHECK(tracker.update(arriving, 85) == GroundTransition::None && tracker.isOnGround(arriving));
+		CHECK(tracker.update(arriving, 95) == GroundTransition::Airborne && !tracker.isOnGround(arriving));
+
+		// forget(): the next update is a first sighting again
+		CHECK(tracker.size() == 2);
+		tracker.forget(parked);
+		CHECK(tracker.size() == 1 && !tracker.isOnGround(parked));
+		CHECK(tracker.update(parked, 5) == GroundTransition::Landed && tracker.isOnGround(parked));
+		tracker.forget(parked);
+		CHECK(tracker.update(parked, 200) == GroundTransition::None && !tracker.isOnGround(parked));
+	}
+
+	// Arrivals polled every 5 s from far out, with a ground speed jittering around both thresholds on
+	// the roll-out, driven like OnTimer and OnRadarTargetPositionUpdate: each landing writes the
+	// strip once, whatever the noise, and repeated polls write nothing
+	void oneWritePerLanding() {
+		constexpr int AIRCRAFT = 200;
+		GroundStateTracker tracker(GROUND_SPEED_KT);
+		AnnotationSync annotations;
+		std::mt19937 random(3);
+		std::uniform_int_distribution<int> jitter(-12, 12);
+		std::vector<int> calls(AIRCRAFT + 1, 0), eligibleCalls(AIRCRAFT + 1, 0);
+		std::uint64_t flips = 0;
+
+		const auto write = [&](CallsignId callsign, StandId, StringId, bool writeStand, bool writeRemark) -> int {
+			++calls[callsign];
+			if (!tracker.isOnGround(callsign)) return -1;
+			++eligibleCalls[callsign];
+			return (writeStand ? 1 : 0) + (writeRemark ? 1 : 0);
+		};
+
+		// Approach at 180 kt, roll-out from 140 kt to taxi at 15 kt, 2 kt a second
+		for (int second = 0; second < 240; ++second) {
+			const int nominal = second < 60 ? 180 : (std::max)(15, 140 - 2 * (second - 60));
+			for (CallsignId callsign = 1; callsign <= AIRCRAFT; ++callsign) {
+				const bool wasOnGround = tracker.isOnGround(callsign);
+				const GroundTransition transition = tracker.update(callsign, nominal + jitter(random));
+				if (tracker.isOnGround(callsign) != wasOnGround) ++flips;
+				if (transition == GroundTransition::Landed && annotations.isPending(callsign)) annotations.flush(write, callsign);
+			}
+			if (second % 5 == 0) {
+				for (CallsignId callsign = 1; callsign <= AIRCRAFT; ++callsign) annotations.set(callsign, 100 + callsign, 7);
+				annotations.flush(write);
+			}
+		}
+
+		for (CallsignId callsign = 1; callsign <= AIRCRAFT; ++callsign) CHECK(tracker.isOnGround(callsign) && eligibleCalls[callsign] == 1);
+		CHECK(flips == AIRCRAFT); // no flapping
+		CHECK(annotations.writes() == 2 * AIRCRAFT && annotations.pendingCount() == 0 && annotations.unchanged() > 0);
+
+		// Disconnected and back: written again, once
+		annotations.forget(1);
+		CHECK(!annotations.isPending(1));
+		annotations.set(1, 101, 7);
+		CHECK(annotations.flush(write) == 2 && eligibleCalls[1] == 2);
+		annotations.set(1, 101, 7);
+		CHECK(!annotations.hasPending() && annotations.flush(write) == 0);
+
+		// A pending write of a forgotten aircraft is dropped
+		annotations.set(2, 300, 7);
+		CHECK(annotations.isPending(2));
+		annotations.forget(2);
+		CHECK(!annotations.hasPending() && annotations.flush(write) == 0);
+
+		std::printf("GroundStateTest: %d landings with +-12 kt jitter, %llu strip annotations written\n", AIRCRAFT, static_cast<unsigned long long>(annotations.writes()));
+	}
+
+}
+
+int main() {
+	hysteresis();
+	oneWritePerLanding();
+	std::puts("GroundStateTest: ok");
+	return 0;
+}
@@ -0,0 +1,216 @@
+// The HTTP/2 transport against a local nghttpd (path given by CMake), next to HttplibClient under
+// the same load. Built with -DRAMPAGENT_HTTP2=ON on POSIX.
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// THREADS clients connecting at once, beyond httplib's default backlog of 5 a SYN is dropped and
+// only retried after the client's 700 ms connect timeout
+#define CPPHTTPLIB_LISTEN_BACKLOG 64
+
+#include "Check.h"
+#include "TestCertificate.h"
+#include "core/Http2Client.h"
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	const std::string BODY = R"({"assignedStands":[{"name":"A1","callsign":"AFR123"}]})";
+	constexpr int THREADS = 8;
+	constexpr int CALLS_PER_THREAD = 4;
+
+	int freePort() {
+		const socket_t sock = ::socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		CHECK(::bind(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+		socklen_t length = sizeof(address);
+		CHECK(::getsockname(sock, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+		httplib::detail::close_socket(sock);
+		return ntohs(address.sin_port);
+	}
+
+	bool accepting(int port) {
+		const socket_t sock = ::socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(static_cast<std::uint16_t>(port));
+		const bool connected = ::connect(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+		httplib::detail::close_socket(sock);
+		return connected;
+	}
+
+	// nghttpd serving a directory with api/occupancy
+	class H2Server {
+	public:
+		explicit H2Server(const TestCertificate& certificate) : root_(std::filesystem::temp_directory_path() / ("RampAgentHttp2Test_" + std::to_string(getpid()))) {
+			std::filesystem::create_directories(root_ / "api");
+			std::ofstream(root_ / "api" / "occupancy") << BODY;
+			port_ = freePort();
+			const std::string root = root_.string(), port = std::to_string(port_);
+			std::vector<const char*> args = { NGHTTPD, "-d", root.c_str(), "-a", "127.0.0.1", port.c_str(), certificate.keyFile().c_str(), certificate.caFile().c_str(), nullptr };
+			pid_ = fork();
+			CHECK(pid_ >= 0);
+			if (pid_ == 0) {
+				prctl(PR_SET_PDEATHSIG, SIGTERM); // also stopped when a failed CHECK exits the test
+				execv(NGHTTPD, const_cast<char* const*>(args.data()));
+				_exit(127);
+			}
+			const auto deadline = Clock::now() + std::chrono::seconds(5);
+			while (!accepting(port_)) {
+				CHECK(Clock::now() < deadline);
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			}
+		}
+
+		~H2Server() {
+			kill(pid_, SIGTERM);
+			waitpid(pid_, nullptr, 0);
+			std::error_code ignored;
+			std::filesystem::remove_all(root_, ignored);
+		}
+
+		int port() const { return port_; }
+		std::string host(const char* name = "127.0.0.1") const { return std::string(name) + ":" + std::to_string(port_); }
+
+	private:
+		std::filesystem::path root_;
+		pid_t pid_ = 0;
+		int port_ = 0;
+	};
+
+	// The same content over HTTP/1.1, each answer after 20 ms so concurrent calls overlap
+	class H1Server {
+	public:
+		explicit H1Server(const TestCertificate& certificate) : server_(certificate.cert(), certificate.key()) {
+			server_.Get("/api/occupancy", [](const httplib::Request&, httplib::Response& response) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				response.set_content(BODY, "application/json");
+			});
+			port_ = server_.bind_to_any_port("127.0.0.1");
+			CHECK(port_ > 0);
+			thread_ = std::thread([this] { server_.listen_after_bind(); });
+			server_.wait_until_ready();
+		}
+
+		~H1Server() {
+			server_.stop();
+			thread_.join();
+		}
+
+		std::string host() const { return "127.0.0.1:" + std::to_string(port_); }
+
+	private:
+		httplib::SSLServer server_;
+		std::thread thread_;
+		int port_ = 0;
+	};
+
+	// Accepts connections and never answers: TLS handshakes stall
+	class StalledServer {
+	public:
+		StalledServer() {
+			socket_ = ::socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			CHECK(::bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+			CHECK(::listen(socket_, 8) == 0);
+			socklen_t length = sizeof(address);
+			CHECK(::getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+			port_ = ntohs(address.sin_port);
+		}
+		~StalledServer() { httplib::detail::close_socket(socket_); }
+
+		std::string host() const { return "127.0.0.1:" + std::to_string(port_); }
+
+	private:
+		socket_t socket_;
+		int port_ = 0;
+	};
+
+	// THREADS callers at once, CALLS_PER_THREAD each
+	void load(ApiClient& client, const std::string& host) {
+		std::atomic<int> ok{ 0 };
+		std::vector<std::thread> threads;
+		for (int t = 0; t < THREADS; ++t) {
+			threads.emplace_back([&] {
+				for (int i = 0; i < CALLS_PER_THREAD; ++i) {
+					const ApiResponse response = client.get(host, "/api/occupancy");
+					if (response.status == 200 && response.body == BODY) ++ok;
+				}
+			});
+		}
+		for (std::thread& thread : threads) thread.join();
+		CHECK(ok == THREADS * CALLS_PER_THREAD);
+	}
+
+}
+
+int main() {
+	std::signal(SIGPIPE, SIG_IGN);
+	const TestCertificate certificate("RampAgentHttp2Test", "IP:127.0.0.1,DNS:localhost,DNS:api.rampagent.test");
+	H2Server h2(certificate);
+	H1Server h1(certificate);
+
+	// Concurrent calls share one multiplexed connection; HTTP/1.1 opens one per overlapping call
+	Http2Client http2(certificate.caFile());
+	load(http2, h2.host());
+	HttplibClient http1(certificate.caFile());
+	load(http1, h1.host());
+	std::printf("Http2ClientTest: %d calls from %d threads, connections: HTTP/2 %llu, HTTP/1.1 %llu\n", THREADS * CALLS_PER_THREAD, THREADS,
+		static_cast<unsigned long long>(http2.connections()), static_cast<unsigned long long>(http1.connections()));
+	CHECK(http2.connections() == 1 && http2.requests() == THREADS * CALLS_PER_THREAD);
+	CHECK(http1.connections() > 1);
+
+	// A name only the DNS cache knows reaches the server through CURLOPT_RESOLVE
+	{
+		DnsCache dns([](const std::string& host) -> std::optional<DnsCache::Resolution> {
+			if (host != "api.rampagent.test") return std::nullopt;
+			return DnsCache::Resolution{ { "127.0.0.1" }, std::chrono::minutes(5) };
+		});
+		Http2Client resolved(certificate.caFile());
+		CHECK(resolved.get(h2.host("api.rampagent.test"), "/api/occupancy").status == 0); // no cache: unknown name
+		resolved.setDnsCache(&dns);
+		const ApiResponse response = resolved.get(h2.host("api.rampagent.test"), "/api/occupancy");
+		CHECK(response.status == 200 && response.body == BODY);
+	}
+
+	// Cancelling a call stuck in the TLS handshake ends it at once; the shared connection stays up
+	{
+		StalledServer stalled;
+		CancelSource cancel;
+		ApiResponse response;
+		response.status = -1;
+		std::thread call([&] { response = http2.get(stalled.host(), "/api/occupancy", cancel.token()); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		const auto start = Clock::now();
+		cancel.cancel();
+		call.join();
+		const double took = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		std::printf("Http2ClientTest: cancelling a stalled handshake took %.2f ms\n", took);
+		CHECK(response.status == 0 && http2.cancelled() == 1 && took < 50.0);
+
+		const std::uint64_t connections = http2.connections();
+		CHECK(http2.get(h2.host(), "/api/occupancy").body == BODY && http2.connections() == connections);
+	}
+
+	std::puts("Http2ClientTest: ok");
+	return 0;
+}
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "Check.h"
+#include "core/Callsign.h"
+#include "core/StringTable.h"
+
+// Replays steady-state poll cycles of the stand tag maps the way runUpdate kept them with string
+// keys (std::unordered_map<std::string, std::string>, toUpper copies) and with interned ids
+// (IdMap scratch tables swapped each cycle), counting heap allocations of each with a counting
+// operator new. Also replays the tag refresh (OnGetTagItem, stand and remark item per target).
+// Usage: InternReplay [cycles]
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // false positive: the operator new below does use malloc
+#endif
+
+namespace {
+
+	std::atomic<bool> counting{ false };
+	std::atomic<std::uint64_t> allocations{ 0 }, allocatedBytes{ 0 };
+
+}
+
+void* operator new(std::size_t size) {
+	if (counting.load(std::memory_order_relaxed)) {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+	if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+using Json = nlohmann::ordered_json;
+
+namespace {
+
+	constexpr std::size_t STANDS = 300, TARGETS = 400, REFRESHES = 5; // tag refreshes per poll cycle
+	constexpr std::uint32_t WHITE = 0xFFFFFF, YELLOW = 0x00FFFF;
+
+	// An /api/occupancy response as in TraceReplay: most stands assigned, a third occupied, a tenth blocked
+	Json occupancyResponse() {
+		Json assigned = Json::array(), occupied = Json::array(), blocked = Json::array();
+		for (std::size_t i = 0; i < STANDS; ++i) {
+			const std::string callsign = "AFR" + std::to_string(100 + i);
+			if (i % 10 == 0) blocked.push_back({ { "name", "P" + std::to_string(i) } });
+			else if (i % 3 == 0) occupied.push_back({ { "name", "P" + std::to_string(i) }, { "callsign", callsign } });
+			else assigned.push_back({ { "name", "P" + std::to_string(i) }, { "callsign", callsign }, { "remark", "SCHENGEN" } });
+		}
+		return { { "assignedStands", assigned }, { "occupiedStands", occupied }, { "blockedStands", blocked } };
+	}
+
+	// Radar targets as EuroScope names them: the assigned traffic plus overflights
+	std::vector<std::string> radarTargets() {
+		std::vector<std::string> targets;
+		for (std::size_t i = 0; i < TARGETS; ++i) targets.push_back(i < STANDS ? "AFR" + std::to_string(100 + i) : "EZY" + std::to_string(4000 + i));
+		return targets;
+	}
+
+	// The stand lists a cycle walks, in order
+	template <typename Fn>
+	void forEachStand(const Json& response, Fn&& fn) {
+		for (const char* list : { "assignedStands", "occupiedStands" }) {
+			for (const Json& stand : response[list]) fn(stand);
+		}
+	}
+
+	// String keys, as before interning
+	namespace before {
+
+		std::string toUpper(std::string str) {
+			std::string result = str;
+			std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+			return result;
+		}
+
+		struct TagItemInfo {
+			std::string standName;
+			std::string remark;
+			std::uint32_t color = WHITE;
+		};
+
+		struct Plugin {
+			explicit Plugin(const std::vector<std::string>& radar) : targets(radar) {}
+
+			const std::vector<std::string>& targets;
+			std::unordered_map<std::string, std::string> lastStandTagMap;
+			std::unordered_map<std::string, TagItemInfo> tagItemValueMap;
+			std::size_t shown = 0;
+
+			bool aircraftExists(const std::string& callsign) const {
+				for (const std::string& target : targets) {
+					if (toUpper(target) == toUpper(callsign)) return true;
+				}
+				return false;
+			}
+
+			void updateTagItems(std::string callsign, std::uint32_t color, std::string standName, std::string remark = "") {
+				TagItemInfo tagInfo;
+				tagInfo.standName = standName;
+				tagInfo.remark = remark;
+				tagInfo.color = color;
+				tagItemValueMap[callsign] = tagInfo;
+			}
+
+			void cycle(const Json& response) {
+				std::unordered_map<std::string, std::string> lastStandTagMapCopy = lastStandTagMap;
+				std::unordered_map<std::string, std::string> standTagMap;
+				forEachStand(response, [&](const Json& stand) {
+					const auto csIt = stand.find("callsign");
+					if (csIt == stand.end() || !csIt->is_string()) return;
+					const std::string callsign = csIt->get<std::string>();
+					if (!aircraftExists(callsign)) return;
+					const std::string standName = stand.find("name")->get<std::string>();
+					standTagMap[callsign] = standName;
+					std::string remark;
+					if (auto rIt = stand.find("remark"); rIt != stand.end() && rIt->is_string()) remark = rIt->get<std::string>();
+					const auto it = lastStandTagMap.find(callsign);
+					updateTagItems(callsign, it != lastStandTagMap.end() && it->second == standName ? WHITE : YELLOW, standName, remark);
+				});
+				for (const auto& [callsign, standName] : lastStandTagMapCopy) {
+					if (standTagMap.find(callsign) == standTagMap.end()) updateTagItems(callsign, WHITE, "");
+				}
+				lastStandTagMap = standTagMap;
+			}
+
+			// OnGetTagItem for the stand and remark items
+			void refresh(char* item) {
+				for (const std::string& target : targets) {
+					for (int code = 0; code < 2; ++code) {
+						const std::string callsign = toUpper(target);
+						if (tagItemValueMap.find(callsign) == tagItemValueMap.end()) continue;
+						const std::string value = code == 0 ? tagItemValueMap[callsign].standName : tagItemValueMap[callsign].remark;
+						std::snprintf(item, 16, "%s", value.c_str());
+						shown += item[0] != '\0';
+					}
+				}
+			}
+		};
+
+	}
+
+	// Interned ids and flat tables, as now
+	namespace after {
+
+		struct TagItemInfo {
+			StandId stand = EMPTY_ID;
+			StringId remark = EMPTY_ID;
+			std::uint32_t color = WHITE;
+		};
+
+		struct Plugin {
+			explicit Plugin(const std::vector<std::string>& radar) : targets(radar) {}
+
+			const std::vector<std::string>& targets;
+			CallsignTable callsigns;
+			StringTable standNames, remarks;
+			IdMap<StandId> lastStandTagMap, nextStandTagMap;
+			IdMap<TagItemInfo> tagItemValueMap;
+			std::size_t shown = 0;
+
+			bool aircraftExists(CallsignId callsign) const {
+				const Callsign wanted(callsigns.view(callsign));
+				for (const std::string& target : targets) {
+					if (Callsign(target) == wanted) return true;
+				}
+				return false;
+			}
+
+			void updateTagItems(CallsignId callsign, std::uint32_t color, StandId stand = EMPTY_ID, StringId remark = EMPTY_ID) {
+				TagItemInfo& tagInfo = tagItemValueMap[callsign];
+				tagInfo.stand = stand;
+				tagInfo.remark = remark;
+				tagInfo.color = color;
+			}
+
+			void cycle(const Json& response) {
+				IdMap<StandId>& standTagMap = nextStandTagMap;
+				standTagMap.clear();
+				forEachStand(response, [&](const Json& stand) {
+					const auto csIt = stand.find("callsign");
+					if (csIt == stand.end() || !csIt->is_string()) return;
+					const CallsignId callsign = callsigns.intern(csIt->get_ref<const std::string&>());
+					if (!aircraftExists(callsign)) return;
+					const StandId standId = standNames.intern(stand.find("name")->get_ref<const std::string&>());
+					standTagMap[callsign] = standId;
+					StringId remark = EMPTY_ID;
+					if (auto rIt = stand.find("remark"); rIt != stand.end() && rIt->is_string()) remark = remarks.intern(rIt->get_ref<const std::string&>());
+					const StandId* last = lastStandTagMap.find(callsign);
+					updateTagItems(callsign, last != nullptr && *last == standId ? WHITE : YELLOW, standId, remark);
+				});
+				lastStandTagMap.forEach([&](CallsignId callsign, StandId) {
+					if (!standTagMap.contains(callsign)) updateTagItems(callsign, WHITE);
+				});
+				std::swap(lastStandTagMap, nextStandTagMap);
+			}
+
+			void refresh(char* item) {
+				for (const std::string& target : targets) {
+					for (int code = 0; code < 2; ++code) {
+						const TagItemInfo* tagInfo = tagItemValueMap.find(callsigns.find(Callsign(target)));
+						if (tagInfo == nullptr) continue;
+						std::snprintf(item, 16, "%s", code == 0 ? standNames.c_str(tagInfo->stand) : remarks.c_str(tagInfo->remark));
+						shown += item[0] != '\0';
+					}
+				}
+			}
+		};
+
+	}
+
+	struct Result {
+		double cycleAllocations, cycleBytes, cycleUs;
+		double refreshAllocations, refreshUs;
+	};
+
+	// Two warm-up cycles (first sight of every callsign and stand), then counted ones
+	template <typename Plugin>
+	Result replay(Plugin& plugin, const Json& response, int cycles) {
+		char item[16];
+		for (int i = 0; i < 2; ++i) {
+			plugin.cycle(response);
+			plugin.refresh(item);
+		}
+		Result result{};
+		allocations = 0;
+		allocatedBytes = 0;
+		counting = true;
+		auto start = Clock::now();
+		for (int i = 0; i < cycles; ++i) plugin.cycle(response);
+		result.cycleUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / cycles;
+		counting = false;
+		result.cycleAllocations = static_cast<double>(allocations.load()) / cycles;
+		result.cycleBytes = static_cast<double>(allocatedBytes.load()) / cycles;
+
+		allocations = 0;
+		counting = true;
+		start = Clock::now();
+		for (int i = 0; i < cycles; ++i) {
+			for (std::size_t r = 0; r < REFRESHES; ++r) plugin.refresh(item);
+		}
+		result.refreshUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / cycles;
+		counting = false;
+		result.refreshAllocations = static_cast<double>(allocations.load()) / cycles;
+		return result;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const int cycles = argc > 1 ? std::atoi(argv[1]) : 50;
+	const Json response = occupancyResponse();
+	const std::vector<std::string> targets = radarTargets();
+
+	before::Plugin old{ targets };
+	after::Plugin now{ targets };
+	const Result a = replay(old, response, cycles);
+	const Result b = replay(now, response, cycles);
+
+	// Both show the same tags
+	CHECK(old.lastStandTagMap.size() == now.lastStandTagMap.size() && old.shown == now.shown && old.shown > 0);
+	now.lastStandTagMap.forEach([&](CallsignId callsign, StandId stand) {
+		const auto it = old.lastStandTagMap.find(std::string(now.callsigns.view(callsign)));
+		CHECK(it != old.lastStandTagMap.end() && it->second == now.standNames.view(stand));
+	});
+	CHECK(b.cycleAllocations == 0 && b.refreshAllocations == 0);
+
+	std::printf("InternReplay: %zu stands, %zu radar targets, %d cycles, %zu tag refreshes per cycle\n", STANDS, TARGETS, cycles, REFRESHES);
+	std::printf("  string keys   %7.0f allocations %8.0f bytes %8.1f us per cycle, %6.0f allocations %8.1f us per cycle of refreshes\n",
+		a.cycleAllocations, a.cycleBytes, a.cycleUs, a.refreshAllocations, a.refreshUs);
+	std::printf("  interned ids  %7.0f allocations %8.0f bytes %8.1f us per cycle, %6.0f allocations %8.1f us per cycle of refreshes\n",
+		b.cycleAllocations, b.cycleBytes, b.cycleUs, b.refreshAllocations, b.refreshUs);
+	std::puts("InternReplay: ok");
+	return 0;
+}
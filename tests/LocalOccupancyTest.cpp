@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Check.h"
+#include "core/LocalOccupancy.h"
+
+using namespace rampAgent;
+using Catalogues = std::unordered_map<AirportId, std::shared_ptr<const StandCatalogue>>;
+
+namespace {
+
+	constexpr double LATITUDE = 43.66, LONGITUDE = 7.21; // LFMN
+	constexpr double PI = 3.14159265358979323846;
+
+	// Offset of a position by metres north and east
+	double north(double metres) { return LATITUDE + metres / 111320.0; }
+	double east(double metres) { return LONGITUDE + metres / (111320.0 * std::cos(LATITUDE * PI / 180.0)); }
+
+	struct StandSpec {
+		const char* name;
+		double eastM;
+		double radius;
+	};
+
+	std::shared_ptr<const StandCatalogue> catalogueOf(AirportId airport, const std::vector<StandSpec>& specs, StringTable& standNames) {
+		auto catalogue = std::make_shared<StandCatalogue>();
+		catalogue->airport = airport;
+		for (const StandSpec& spec : specs) {
+			StandInfo stand;
+			stand.name = standNames.intern(spec.name);
+			stand.latitude = LATITUDE;
+			stand.longitude = east(spec.eastM);
+			stand.radius = spec.radius;
+			stand.hasPosition = true;
+			catalogue->stands.push_back(stand);
+		}
+		catalogue->finalize(standNames);
+		return catalogue;
+	}
+
+	std::vector<StandId> occupied(const LocalOccupancy& local, AirportId airport) {
+		std::vector<StandId> stands;
+		local.forEachOccupied(airport, [&](StandId stand, CallsignId) { stands.push_back(stand); });
+		return stands;
+	}
+
+}
+
+int main() {
+	StringTable standNames;
+	StringTable airports{ true };
+	const AirportId lfmn = airports.intern("LFMN");
+	Catalogues catalogues;
+	// 1 and 2 adjoin, 2 has no radius (25 m default), 3 is apart
+	catalogues[lfmn] = catalogueOf(lfmn, { { "1", 0.0, 30.0 }, { "2", 55.0, 0.0 }, { "3", 300.0, 40.0 } }, standNames);
+	const StandId one = standNames.find("1"), two = standNames.find("2"), three = standNames.find("3");
+
+	LocalOccupancy local;
+	const CallsignId afr = 1, ezy = 2;
+
+	// Point in circle, parked
+	CHECK(local.update(afr, LATITUDE, LONGITUDE, 0, true, catalogues));
+	CHECK(local.isParked(afr) && occupied(local, lfmn) == std::vector<StandId>{ one });
+	CHECK(!local.update(afr, north(10.0), LONGITUDE, 2, true, catalogues)); // same stand, no change
+	CHECK(!local.update(afr, north(29.0), LONGITUDE, 0, true, catalogues)); // inside the 30 m circle
+	CHECK(local.update(afr, north(31.0), LONGITUDE, 0, true, catalogues));  // outside: vacated
+	CHECK(!local.isParked(afr) && occupied(local, lfmn).empty() && local.hasVacated(afr, lfmn, one));
+
+	// Default radius where the catalogue has none
+	CHECK(local.update(ezy, LATITUDE, east(55.0 + 24.0), 0, true, catalogues) && occupied(local, lfmn) == std::vector<StandId>{ two });
+	CHECK(local.update(ezy, LATITUDE, east(55.0 + 27.0), 0, true, catalogues) && occupied(local, lfmn).empty());
+
+	// Between two adjoining stands, the one whose circle holds the aircraft
+	CHECK(local.update(ezy, LATITUDE, east(29.0), 0, true, catalogues) && occupied(local, lfmn) == std::vector<StandId>{ one });
+	CHECK(local.update(ezy, LATITUDE, east(32.0), 0, true, catalogues) && occupied(local, lfmn) == std::vector<StandId>{ two });
+
+	// Parked speed: taxiing through a stand is not parking on it; airborne is never parked
+	CHECK(local.update(afr, LATITUDE, east(300.0), LocalOccupancy::PARKED_SPEED_KT + 1, true, catalogues) == false && !local.isParked(afr));
+	CHECK(local.update(afr, LATITUDE, east(300.0), LocalOccupancy::PARKED_SPEED_KT, true, catalogues) && local.isParked(afr));
+	CHECK(!local.hasVacated(afr, lfmn, one)); // parked again: the old vacation is dropped
+	CHECK(local.update(afr, LATITUDE, east(300.0), LocalOccupancy::PARKED_SPEED_KT + 1, true, catalogues) && local.hasVacated(afr, lfmn, three));
+	CHECK(local.update(afr, LATITUDE, east(300.0), 0, true, catalogues));
+	CHECK(local.update(afr, LATITUDE, east(300.0), 0, false, catalogues) && !local.isParked(afr));
+
+	// Off every catalogue: nothing occupied
+	CHECK(!local.update(3, north(5000.0), LONGITUDE, 0, true, catalogues) && !local.isParked(3));
+
+	// Vacate grace: a server snapshot older than the vacation plus the grace can't override it yet
+	const auto now = std::chrono::steady_clock::now();
+	CHECK(local.hasVacated(afr, lfmn, three) && local.vacatedCount() == 1);
+	local.reconcile(now);
+	local.reconcile(now + LocalOccupancy::VACATE_GRACE - std::chrono::seconds(1));
+	CHECK(local.hasVacated(afr, lfmn, three));
+	local.reconcile(now + LocalOccupancy::VACATE_GRACE + std::chrono::seconds(1));
+	CHECK(!local.hasVacated(afr, lfmn, three) && local.vacatedCount() == 0);
+
+	// forget(): parked and vacated state both dropped, the stand is free
+	CHECK(local.isParked(ezy) && local.occupiedCount() == 1);
+	local.forget(ezy);
+	CHECK(!local.isParked(ezy) && local.occupiedCount() == 0 && !local.hasVacated(ezy, lfmn, two) && local.vacatedCount() == 0);
+
+	// A busy apron: 400 stands 60 m apart, 300 ground targets updated every 5 s for an hour
+	std::vector<StandSpec> apron;
+	std::vector<std::string> names;
+	names.reserve(400);
+	for (int i = 0; i < 400; ++i) names.push_back("P" + std::to_string(i));
+	for (int i = 0; i < 400; ++i) apron.push_back({ names[i].c_str(), 60.0 * i, 30.0 });
+	const AirportId lfpg = airports.intern("LFPG");
+	Catalogues busy;
+	busy[lfpg] = catalogueOf(lfpg, apron, standNames);
+	LocalOccupancy hub;
+	std::size_t changes = 0, updates = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (int tick = 0; tick < 720; ++tick) {
+		for (CallsignId callsign = 1; callsign <= 300; ++callsign) {
+			// Each target parks on its stand, leaves after a while and comes back
+			const bool moving = (tick + static_cast<int>(callsign)) % 120 < 10;
+			changes += hub.update(callsign, LATITUDE, east(60.0 * callsign + (moving ? 45.0 : 3.0)), moving ? 15 : 0, true, busy) ? 1 : 0;
+			++updates;
+		}
+		if (tick % 3 == 0) hub.reconcile(std::chrono::steady_clock::now() - LocalOccupancy::VACATE_GRACE);
+	}
+	const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(updates);
+	CHECK(changes > 0 && hub.occupiedCount() <= 300);
+	std::printf("LocalOccupancyTest: %zu position updates over 400 stands, %zu changes, %.2f us per update\n", updates, changes, us);
+	CHECK(us < 50.0);
+
+	std::puts("LocalOccupancyTest: ok");
+	return 0;
+}
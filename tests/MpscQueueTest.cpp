@@ -0,0 +1,154 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+#include "core/MessageChannel.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	constexpr std::uint64_t PRODUCERS = 8;
+	constexpr std::uint64_t PER_PRODUCER = 50000;
+
+	// producer << 32 | sequence
+	std::uint64_t tag(std::uint64_t producer, std::uint64_t sequence) { return producer << 32 | sequence; }
+
+	// Wraps around many times, FIFO, full and empty exactly at the bounds
+	void singleThread() {
+		BoundedMpscQueue<std::uint64_t, 8> queue;
+		std::uint64_t value = 0, next = 0, expected = 0;
+		CHECK(!queue.pop(value));
+		for (int round = 0; round < 100; ++round) {
+			for (int i = 0; i < 8; ++i) CHECK(queue.push(std::uint64_t(next++)));
+			CHECK(!queue.push(std::uint64_t(999)));
+			for (int i = 0; i < 5; ++i) {
+				CHECK(queue.pop(value) && value == expected++);
+			}
+			for (int i = 0; i < 5; ++i) CHECK(queue.push(std::uint64_t(next++)));
+			CHECK(!queue.push(std::uint64_t(999)));
+			while (queue.pop(value)) CHECK(value == expected++);
+			CHECK(expected == next);
+		}
+	}
+
+	// Producers retry when full while the consumer drains: every value arrives once, in each
+	// producer's order
+	void concurrentPush() {
+		BoundedMpscQueue<std::uint64_t, 256> queue;
+		std::atomic<bool> go{ false };
+		std::atomic<std::uint64_t> full{ 0 };
+		std::vector<std::thread> producers;
+		for (std::uint64_t p = 0; p < PRODUCERS; ++p) {
+			producers.emplace_back([&, p] {
+				while (!go.load()) std::this_thread::yield();
+				for (std::uint64_t s = 0; s < PER_PRODUCER; ++s) {
+					while (!queue.push(tag(p, s))) {
+						full.fetch_add(1, std::memory_order_relaxed);
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		std::vector<std::uint64_t> nextSequence(PRODUCERS, 0);
+		std::uint64_t received = 0, value = 0;
+		go.store(true);
+		while (received < PRODUCERS * PER_PRODUCER) {
+			if (!queue.pop(value)) {
+				std::this_thread::yield();
+				continue;
+			}
+			const std::uint64_t producer = value >> 32, sequence = value & 0xFFFFFFFFu;
+			CHECK(producer < PRODUCERS);
+			CHECK(sequence == nextSequence[producer]);
+			++nextSequence[producer];
+			++received;
+		}
+		for (std::thread& producer : producers) producer.join();
+		CHECK(!queue.pop(value));
+		for (std::uint64_t p = 0; p < PRODUCERS; ++p) CHECK(nextSequence[p] == PER_PRODUCER);
+		std::printf("MpscQueueTest: %llu values from %llu producers, %llu pushes found the queue full\n", (unsigned long long)received, (unsigned long long)PRODUCERS, (unsigned long long)full.load());
+	}
+
+	// Consumer stalled: exactly Capacity pushes succeed, the rest are refused, nothing accepted is lost
+	void atCapacity() {
+		constexpr std::size_t CAPACITY = 1024;
+		BoundedMpscQueue<std::uint64_t, CAPACITY> queue;
+		std::vector<std::vector<std::uint64_t>> accepted(PRODUCERS);
+		std::atomic<std::uint64_t> refused{ 0 };
+		std::vector<std::thread> producers;
+		for (std::uint64_t p = 0; p < PRODUCERS; ++p) {
+			producers.emplace_back([&, p] {
+				for (std::uint64_t s = 0; s < CAPACITY; ++s) {
+					if (queue.push(tag(p, s))) accepted[p].push_back(s);
+					else refused.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+		for (std::thread& producer : producers) producer.join();
+		CHECK(refused.load() == PRODUCERS * CAPACITY - CAPACITY);
+
+		std::vector<std::size_t> position(PRODUCERS, 0);
+		std::uint64_t value = 0, received = 0;
+		while (queue.pop(value)) {
+			const std::uint64_t producer = value >> 32;
+			CHECK(position[producer] < accepted[producer].size());
+			CHECK((value & 0xFFFFFFFFu) == accepted[producer][position[producer]++]);
+			++received;
+		}
+		CHECK(received == CAPACITY);
+		for (std::uint64_t p = 0; p < PRODUCERS; ++p) CHECK(position[p] == accepted[p].size());
+
+		// Usable again once drained
+		CHECK(queue.push(std::uint64_t(42)) && queue.pop(value) && value == 42);
+	}
+
+	// A full channel counts what it drops
+	void channelDrops() {
+		MessageChannel channel;
+		for (std::size_t i = 0; i < MessageChannel::CAPACITY + 10; ++i) channel.push(MessageSeverity::Info, MessageKey::Server, "down " + std::to_string(i));
+		CHECK(channel.dropped() == 10);
+		std::size_t displayed = 0;
+		channel.drain([&](const Message&) { ++displayed; });
+		CHECK(displayed == 1 && channel.coalesced() == MessageChannel::CAPACITY - 1); // latest state of the key
+	}
+
+	// A flapping server is rate limited, replies to the user's own actions are not
+	void channelRateLimit() {
+		MessageChannel channel;
+		const auto start = MessageChannel::Clock::now();
+		std::size_t keyed = 0, replies = 0, summaries = 0;
+		const auto display = [&](const Message& message) {
+			if (message.text.find("suppressed") != std::string::npos) ++summaries;
+			else if (message.key == MessageKey::None) ++replies;
+			else ++keyed;
+		};
+		for (int tick = 0; tick < 20; ++tick) {
+			channel.push(MessageSeverity::Error, MessageKey::Server, "Server down " + std::to_string(tick));
+			channel.push(MessageSeverity::Error, MessageKey::None, "Manual stand rejected.");
+			channel.drain(display, start + std::chrono::milliseconds(100 * tick));
+		}
+		CHECK(replies == 20 && keyed == static_cast<std::size_t>(MessageChannel::BURST) && summaries == 0);
+		CHECK(channel.suppressed() == 20 - keyed);
+
+		// Reported once a token is back
+		channel.drain(display, start + std::chrono::milliseconds(2000) + MessageChannel::REFILL_PERIOD);
+		CHECK(summaries == 1 && replies == 20);
+	}
+
+}
+
+int main() {
+	singleThread();
+	concurrentPush();
+	atCapacity();
+	channelDrops();
+	channelRateLimit();
+	std::puts("MpscQueueTest: ok");
+	return 0;
+}
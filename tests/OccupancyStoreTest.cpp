@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <memory>
+
+#include "Check.h"
+#include "core/OccupancyState.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	const OccupancyState::Assignment* assignmentOf(const OccupancyState& state, CallsignId callsign) {
+		for (const OccupancyState::Assignment& assignment : state.assignments) {
+			if (assignment.callsign == callsign) return &assignment;
+		}
+		return nullptr;
+	}
+
+}
+
+int main() {
+	CallsignTable callsigns;
+	StringTable standNames, remarks;
+	const CallsignId afr = callsigns.intern("AFR123");
+	const CallsignId ezy = callsigns.intern("EZY45");
+	const nlohmann::ordered_json response = {
+		{ "assignedStands", { { { "name", "A1" }, { "callsign", "AFR123" } } } },
+		{ "blockedStands", { { { "name", "B2" } } } },
+	};
+
+	OccupancyStore store;
+	store.publish(OccupancyState::fromJson(response, callsigns, standNames, remarks));
+	CHECK(store.version() == 1 && store.pin()->received);
+	CHECK(assignmentOf(*store.pin(), afr)->stand == standNames.find("A1"));
+
+	// Edits made while polls fail wait for the next version with data
+	store.edit(afr, standNames.intern("C3"));
+	store.edit(ezy, standNames.intern("D4"));
+	store.publish(OccupancyState::fromJson(nlohmann::ordered_json(), callsigns, standNames, remarks));
+	store.publish(std::make_shared<OccupancyState>());
+	CHECK(store.version() == 3 && !store.pin()->received && store.editsApplied() == 0);
+
+	const std::shared_ptr<const OccupancyState> pinned = store.pin();
+	store.publish(OccupancyState::fromJson(response, callsigns, standNames, remarks));
+	const std::shared_ptr<const OccupancyState> state = store.pin();
+	CHECK(store.editsApplied() == 2);
+	CHECK(assignmentOf(*state, afr)->stand == standNames.find("C3") && assignmentOf(*state, afr)->manual);
+	CHECK(assignmentOf(*state, ezy)->stand == standNames.find("D4"));
+	CHECK(pinned->assignments.empty()); // published versions are never mutated
+
+	// Applied once
+	store.publish(OccupancyState::fromJson(response, callsigns, standNames, remarks));
+	CHECK(store.editsApplied() == 2 && assignmentOf(*store.pin(), afr)->stand == standNames.find("A1"));
+
+	std::puts("OccupancyStoreTest: ok");
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+#include "core/SessionState.h"
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	struct Probe {
+		bool connected;
+		bool controller;
+		int facility;
+		std::string callsign;
+	};
+
+	// One publish per change; the token only recomputed when the callsign changes
+	void publishes() {
+		SessionState state;
+		int tokens = 0;
+		const auto makeToken = [&](const std::string& callsign) {
+			++tokens;
+			return "token:" + callsign;
+		};
+		const auto publish = [&](const Probe& probe) { return state.publish(probe.connected, probe.controller, probe.facility, probe.callsign, makeToken); };
+
+		CHECK(publish({ false, false, 0, "" }) == nullptr && state.changes() == 0); // the initial state
+
+		CHECK(publish({ true, true, 5, "LFMN_APP" }) != nullptr && tokens == 1);
+		CHECK(state.current()->token == "token:LFMN_APP" && state.isOwnCallsign("LFMN_APP") && !state.isOwnCallsign("LFMN_TWR"));
+		CHECK(publish({ true, true, 5, "LFMN_APP" }) == nullptr && tokens == 1);
+
+		// Same callsign, other role: a new snapshot, the token is kept
+		const auto before = state.current();
+		const auto previous = publish({ true, false, 5, "LFMN_APP" });
+		CHECK(previous == before && !state.current()->controller && state.current()->token == "token:LFMN_APP" && tokens == 1);
+
+		CHECK(publish({ true, true, 4, "LFMN_TWR" }) != nullptr && tokens == 2 && state.current()->token == "token:LFMN_TWR");
+		CHECK(publish({ false, false, 0, "" }) != nullptr && tokens == 2 && state.current()->token.empty() && !state.isOwnCallsign(""));
+		CHECK(state.changes() == 4 && state.evaluations() == 6);
+	}
+
+	// 500 controllers on the network sending position updates: only ours reaches an evaluation
+	void storm() {
+		constexpr int CONTROLLERS = 500, ROUNDS = 200;
+		std::vector<std::string> callsigns;
+		for (int i = 0; i < CONTROLLERS; ++i) callsigns.push_back("EDDF_" + std::to_string(i) + "_CTR");
+		callsigns[123] = "LFMN_APP";
+
+		SessionState state;
+		int tokens = 0;
+		const auto makeToken = [&](const std::string& callsign) {
+			++tokens;
+			return "token:" + callsign;
+		};
+		state.publish(true, true, 5, "LFMN_APP", makeToken);
+
+		// Before: every update evaluated
+		SessionState unfiltered;
+		auto start = Clock::now();
+		for (int round = 0; round < ROUNDS; ++round) {
+			for (std::size_t i = 0; i < callsigns.size(); ++i) unfiltered.publish(true, true, 5, "LFMN_APP", makeToken);
+		}
+		const double unfilteredNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (CONTROLLERS * ROUNDS);
+
+		start = Clock::now();
+		for (int round = 0; round < ROUNDS; ++round) {
+			for (const std::string& callsign : callsigns) {
+				if (state.isOwnCallsign(callsign)) state.publish(true, true, 5, "LFMN_APP", makeToken);
+			}
+		}
+		const double filteredNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (CONTROLLERS * ROUNDS);
+
+		CHECK(state.evaluations() == 1 + ROUNDS && state.changes() == 1 && tokens == 2);
+		CHECK(unfiltered.evaluations() == static_cast<std::uint64_t>(CONTROLLERS) * ROUNDS && unfiltered.changes() == 1);
+		std::printf("SessionStateTest: %d controllers x %d updates, %llu evaluations (%llu unfiltered), %.1f ns per update (%.1f unfiltered)\n",
+			CONTROLLERS, ROUNDS, static_cast<unsigned long long>(state.evaluations()), static_cast<unsigned long long>(unfiltered.evaluations()), filteredNs, unfilteredNs);
+	}
+
+	// Workers read the snapshot while the UI thread publishes: always a consistent one
+	void concurrentReaders() {
+		SessionState state;
+		std::atomic<bool> done{ false };
+		std::atomic<std::uint64_t> reads{ 0 };
+		std::vector<std::thread> readers;
+		for (int r = 0; r < 3; ++r) {
+			readers.emplace_back([&] {
+				while (!done.load(std::memory_order_acquire)) {
+					const std::shared_ptr<const Session> session = state.current();
+					CHECK(session->token == (session->callsign.empty() ? std::string() : "token:" + session->callsign));
+					CHECK(session->connected == !session->callsign.empty());
+					reads.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+		for (int i = 0; i < 20000; ++i) {
+			const std::string callsign = i % 3 == 0 ? std::string() : "LFMN_" + std::to_string(i % 7) + "_APP";
+			state.publish(!callsign.empty(), true, 5, callsign, [](const std::string& cs) { return "token:" + cs; });
+		}
+		done.store(true, std::memory_order_release);
+		for (std::thread& reader : readers) reader.join();
+		CHECK(reads.load() > 0);
+	}
+
+}
+
+int main() {
+	publishes();
+	storm();
+	concurrentReaders();
+	std::puts("SessionStateTest: ok");
+	return 0;
+}
@@ -0,0 +1,185 @@
+// Shared occupancy between instances: POSIX shm segments under names unique to this run, other
+// processes started with fork().
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Check.h"
+#include "core/SharedOccupancy.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	struct Entry {
+		StandList list;
+		std::string callsign, name, remark;
+	};
+
+	const std::string SEGMENT = "RampAgentTestOccupancy_" + std::to_string(getpid());
+	const std::string LOCK = "RampAgentTestLeader_" + std::to_string(getpid());
+
+	SharedOccupancy::ReadResult readAll(SharedOccupancy& shared, std::uint64_t& seen, bool& received, std::vector<Entry>& entries,
+		std::chrono::system_clock::time_point* published = nullptr) {
+		std::chrono::system_clock::time_point at;
+		entries.clear();
+		const auto result = shared.read(seen, received, at, [&](StandList list, std::string_view callsign, std::string_view name, std::string_view remark) {
+			entries.push_back({ list, std::string(callsign), std::string(name), std::string(remark) });
+		});
+		if (published != nullptr) *published = at;
+		return result;
+	}
+
+	// Snapshot k: k % 40 + 1 stands all carrying k, so a mix of two snapshots shows
+	nlohmann::ordered_json snapshot(int k) {
+		nlohmann::ordered_json stands = nlohmann::ordered_json::array();
+		for (int i = 0; i <= k % 40; ++i) stands.push_back({ { "name", "S" + std::to_string(i) }, { "callsign", "K" + std::to_string(k) }, { "remark", std::to_string(k) } });
+		return { { "assignedStands", stands } };
+	}
+
+	// A follower's view can't be written to: the write faults in a child process
+	void checkReadOnlyView() {
+		const std::string name = SEGMENT + "_view";
+		SharedMemory view;
+		CHECK(view.open(name, 4096, false) && !view.writable());
+		const pid_t child = fork();
+		CHECK(child >= 0);
+		if (child == 0) {
+			static_cast<volatile char*>(view.data())[0] = 1;
+			_exit(0);
+		}
+		int status = 0;
+		CHECK(waitpid(child, &status, 0) == child);
+		CHECK(WIFSIGNALED(status) && (WTERMSIG(status) == SIGSEGV || WTERMSIG(status) == SIGBUS));
+
+		CHECK(view.setWritable(true) && view.writable());
+		static_cast<volatile char*>(view.data())[0] = 1;
+		CHECK(view.setWritable(false) && !view.writable() && static_cast<const char*>(view.data())[0] == 1);
+		view.close();
+		SharedMemory::remove(name);
+	}
+
+}
+
+int main() {
+	SharedMemory::remove(SEGMENT);
+	NamedLock::remove(LOCK);
+	checkReadOnlyView();
+
+	SharedOccupancy leader(SEGMENT, LOCK, std::chrono::seconds(45));
+	SharedOccupancy follower(SEGMENT, LOCK, std::chrono::seconds(45));
+	CHECK(leader.enable() && follower.enable());
+	std::uint64_t seen = 0;
+	bool received = false;
+	std::vector<Entry> entries;
+	CHECK(readAll(follower, seen, received, entries) == SharedOccupancy::ReadResult::None);
+
+	// Publish and read
+	CHECK(leader.tryLead() && leader.leading() && !follower.tryLead() && !follower.leading());
+	CHECK(!follower.publish(snapshot(1)));
+	const nlohmann::ordered_json response = {
+		{ "assignedStands", { { { "name", "A1" }, { "callsign", "AFR123" }, { "remark", "late" } } } },
+		{ "occupiedStands", { { { "name", "B2" }, { "callsign", "EZY45" } } } },
+		{ "blockedStands", { { { "name", "C3" } } } },
+	};
+	CHECK(leader.publish(response));
+	std::chrono::system_clock::time_point published;
+	CHECK(readAll(follower, seen, received, entries, &published) == SharedOccupancy::ReadResult::Read);
+	CHECK(received && seen == 1 && entries.size() == 3);
+	CHECK(std::chrono::system_clock::now() - published < std::chrono::seconds(5));
+	CHECK(entries[0].list == StandList::Assigned && entries[0].callsign == "AFR123" && entries[0].name == "A1" && entries[0].remark == "late");
+	CHECK(entries[1].list == StandList::Occupied && entries[1].callsign == "EZY45" && entries[1].name == "B2" && entries[1].remark.empty());
+	CHECK(entries[2].list == StandList::Blocked && entries[2].callsign.empty() && entries[2].name == "C3");
+	CHECK(readAll(follower, seen, received, entries) == SharedOccupancy::ReadResult::Unchanged && entries.empty());
+
+	// An empty response is passed on as such
+	CHECK(leader.publish(nlohmann::ordered_json::object()));
+	CHECK(readAll(follower, seen, received, entries) == SharedOccupancy::ReadResult::Read);
+	CHECK(!received && seen == 2 && entries.empty());
+
+	// Resign and take over, the old leader now follows
+	leader.resign();
+	CHECK(!leader.leading() && !leader.publish(response));
+	CHECK(follower.tryLead() && !leader.tryLead());
+	CHECK(follower.publish(snapshot(7)));
+	std::uint64_t leaderSeen = 0;
+	CHECK(readAll(leader, leaderSeen, received, entries) == SharedOccupancy::ReadResult::Read);
+	CHECK(leaderSeen == 3 && entries.size() == 8 && entries[7].callsign == "K7");
+	follower.resign();
+
+	// A leader killed mid-session frees the lock
+	int ready[2];
+	CHECK(pipe(ready) == 0);
+	const pid_t child = fork();
+	CHECK(child >= 0);
+	if (child == 0) {
+		SharedOccupancy other(SEGMENT, LOCK, std::chrono::seconds(45));
+		const char ok = other.enable() && other.tryLead() && other.publish(snapshot(9)) ? 1 : 0;
+		if (write(ready[1], &ok, 1) != 1) _exit(1);
+		pause();
+		_exit(0);
+	}
+	char ok = 0;
+	CHECK(read(ready[0], &ok, 1) == 1 && ok == 1);
+	CHECK(!leader.tryLead() && !follower.tryLead());
+	CHECK(readAll(follower, seen, received, entries) == SharedOccupancy::ReadResult::Read && entries.size() == 10);
+	kill(child, SIGKILL);
+	int status = 0;
+	CHECK(waitpid(child, &status, 0) == child && WIFSIGNALED(status));
+	CHECK(leader.tryLead() && leader.leaderships() == 2);
+	close(ready[0]);
+	close(ready[1]);
+
+	// A leader that stops publishing goes stale
+	SharedOccupancy impatient(SEGMENT, LOCK, std::chrono::milliseconds(200));
+	CHECK(impatient.enable());
+	CHECK(leader.publish(snapshot(11)));
+	std::uint64_t impatientSeen = 0;
+	CHECK(readAll(impatient, impatientSeen, received, entries) == SharedOccupancy::ReadResult::Read);
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	CHECK(readAll(impatient, impatientSeen, received, entries) == SharedOccupancy::ReadResult::Stale);
+	CHECK(impatient.fallbacks() == 1);
+	impatient.disable();
+
+	// Readers never see a mix of two snapshots while the leader rewrites the slots
+	constexpr int SNAPSHOTS = 20'000;
+	std::thread writer([&] {
+		for (int k = 0; k < SNAPSHOTS; ++k) CHECK(leader.publish(snapshot(k)));
+	});
+	std::uint64_t last = seen;
+	std::size_t reads = 0;
+	for (bool done = false; !done;) {
+		const auto result = readAll(follower, seen, received, entries);
+		if (result != SharedOccupancy::ReadResult::Read) {
+			std::this_thread::yield();
+			continue;
+		}
+		CHECK(seen > last);
+		last = seen;
+		++reads;
+		CHECK(!entries.empty());
+		const int k = std::stoi(entries[0].remark);
+		CHECK(entries.size() == static_cast<std::size_t>(k % 40 + 1));
+		for (std::size_t i = 0; i < entries.size(); ++i) {
+			CHECK(entries[i].list == StandList::Assigned && entries[i].name == "S" + std::to_string(i));
+			CHECK(entries[i].callsign == "K" + std::to_string(k) && entries[i].remark == entries[0].remark);
+		}
+		done = k == SNAPSHOTS - 1;
+	}
+	writer.join();
+	CHECK(reads > 0);
+
+	leader.disable();
+	follower.disable();
+	SharedMemory::remove(SEGMENT);
+	NamedLock::remove(LOCK);
+	std::printf("SharedOccupancyTest: %zu consistent reads of %d snapshots\n", reads, SNAPSHOTS);
+	std::puts("SharedOccupancyTest: ok");
+	return 0;
+}
@@ -0,0 +1,156 @@
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "Check.h"
+#include "TestCertificate.h"
+#include "core/ApiClient.h"
+#include "core/DnsCache.h"
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	// Listens on 127.0.0.1 and never answers: connections complete, TLS handshakes stall
+	class StalledServer {
+	public:
+		StalledServer() {
+			socket_ = ::socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			CHECK(::bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+			CHECK(::listen(socket_, 8) == 0);
+			socklen_t length = sizeof(address);
+			CHECK(::getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+			port_ = ntohs(address.sin_port);
+		}
+		~StalledServer() { httplib::detail::close_socket(socket_); }
+
+		std::string host(const char* name) const { return std::string(name) + ":" + std::to_string(port_); }
+
+	private:
+		socket_t socket_;
+		int port_ = 0;
+	};
+
+	double ms(Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+	// TLS server answering /ok at once and never answering /stall
+	class SilentServer {
+	public:
+		explicit SilentServer(const TestCertificate& certificate) : server_(certificate.cert(), certificate.key()) {
+			server_.Get("/ok", [](const httplib::Request&, httplib::Response& response) { response.set_content("ok", "text/plain"); });
+			server_.Get("/stall", [this](const httplib::Request&, httplib::Response& response) {
+				std::unique_lock<std::mutex> lock(mutex_);
+				released_.wait(lock, [this] { return release_; });
+				response.set_content("late", "text/plain");
+			});
+			port_ = server_.bind_to_any_port("127.0.0.1");
+			CHECK(port_ > 0);
+			thread_ = std::thread([this] { server_.listen_after_bind(); });
+			server_.wait_until_ready();
+		}
+
+		~SilentServer() {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				release_ = true;
+			}
+			released_.notify_all();
+			server_.stop();
+			thread_.join();
+		}
+
+		std::string host() const { return "127.0.0.1:" + std::to_string(port_); }
+
+	private:
+		httplib::SSLServer server_;
+		std::thread thread_;
+		int port_ = 0;
+		std::mutex mutex_;
+		std::condition_variable released_;
+		bool release_ = false;
+	};
+
+	// The common keep-alive case: the pooled connection is up, the request went out and the
+	// server never answers. Cancelling ends the call before the read timeout.
+	void stalledResponse() {
+		const TestCertificate certificate("RampAgentShutdownTest");
+		SilentServer server(certificate);
+		HttplibClient client(certificate.caFile());
+		CHECK(client.get(server.host(), "/ok").body == "ok");
+		CHECK(client.get(server.host(), "/ok").body == "ok" && client.connections() == 1);
+
+		CancelSource cancel;
+		ApiResponse stalled;
+		stalled.status = -1;
+		std::thread call([&] { stalled = client.get(server.host(), "/stall", cancel.token()); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		const auto start = Clock::now();
+		cancel.cancel();
+		call.join();
+		const double took = ms(Clock::now() - start);
+		std::printf("ShutdownTest: cancelling a request the server never answers took %.2f ms\n", took);
+		CHECK(stalled.status == 0 && client.cancelled() == 1);
+		CHECK(took < 50.0);
+
+		// The cancelled connection was dropped, the next call opens a new one
+		CHECK(client.get(server.host(), "/ok").body == "ok" && client.connections() == 2);
+	}
+
+}
+
+int main() {
+#ifndef _WIN32
+	std::signal(SIGPIPE, SIG_IGN); // writes to a cancelled (shut down) TLS connection
+#endif
+	StalledServer server;
+	CancelSource network;
+
+	// Lookups never answered in time, and a resolver stuck in the system call
+	auto dns = std::make_unique<DnsCache>([](const std::string&) -> std::optional<DnsCache::Resolution> {
+		std::this_thread::sleep_for(std::chrono::seconds(3));
+		return std::nullopt;
+	});
+
+	// The UI thread doesn't wait on a first lookup
+	dns->setUiThread(std::this_thread::get_id());
+	auto start = Clock::now();
+	CHECK(dns->lookup("ui.invalid").empty());
+	CHECK(Clock::now() - start < std::chrono::milliseconds(20));
+
+	// One call waiting on a first lookup, one in the TLS handshake with the stalled server
+	auto resolving = std::make_unique<HttplibClient>();
+	resolving->setDnsCache(dns.get());
+	auto direct = std::make_unique<HttplibClient>();
+	ApiResponse resolved, handshake;
+	resolved.status = handshake.status = -1;
+	std::thread first([&] { resolved = resolving->get(server.host("stalled.invalid"), "/api/occupancy", network.token()); });
+	std::thread second([&] { handshake = direct->get(server.host("127.0.0.1"), "/api/occupancy", network.token()); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+	// Unload: cancel, join, then tear down the clients and the cache
+	start = Clock::now();
+	network.cancel();
+	first.join();
+	second.join();
+	resolving.reset();
+	direct.reset();
+	dns.reset();
+	const double took = ms(Clock::now() - start);
+	std::printf("ShutdownTest: unload with a stalled resolver and server took %.2f ms\n", took);
+	CHECK(took < 50.0);
+	CHECK(resolved.status == 0 && handshake.status == 0);
+
+	stalledResponse();
+
+	std::puts("ShutdownTest: ok");
+	return 0;
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "core/Callsign.h"
+#include "core/StandAllocator.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	struct StandSpec {
+		const char* name;
+		const char* code;
+		bool schengen;
+		const char* use;
+	};
+
+	std::shared_ptr<const StandCatalogue> catalogueOf(AirportId airport, const std::vector<StandSpec>& specs, StringTable& standNames) {
+		auto catalogue = std::make_shared<StandCatalogue>();
+		catalogue->airport = airport;
+		for (const StandSpec& spec : specs) {
+			StandInfo stand;
+			stand.name = standNames.intern(spec.name);
+			stand.code = spec.code;
+			stand.schengen = spec.schengen;
+			stand.use = spec.use;
+			catalogue->stands.push_back(stand);
+		}
+		catalogue->finalize(standNames);
+		return catalogue;
+	}
+
+	struct Run {
+		StandAllocator& allocator;
+		std::shared_ptr<const StandCatalogue> catalogue;
+		IdMap<StandId> previous;
+		IdMap<std::uint8_t> unavailable;
+
+		// Stand proposed to each flight, EMPTY_ID if none, in the order given
+		std::vector<StandId> operator()(std::vector<InboundFlight> flights) {
+			const std::vector<InboundFlight> order = flights;
+			std::vector<StandAllocator::Proposal> proposals;
+			allocator.allocate(catalogue, flights, [&](StandId stand) { return unavailable.contains(stand); }, previous, proposals);
+			std::vector<StandId> stands;
+			for (const InboundFlight& flight : order) {
+				StandId stand = EMPTY_ID;
+				for (const StandAllocator::Proposal& proposal : proposals) {
+					if (proposal.callsign == flight.callsign) stand = proposal.stand;
+				}
+				stands.push_back(stand);
+			}
+			return stands;
+		}
+	};
+
+}
+
+int main() {
+	StringTable standNames;
+	StringTable airports{ true };
+	CallsignTable callsigns;
+	auto flight = [&](const char* callsign, const char* type, bool schengen, double distance) {
+		return InboundFlight{ callsigns.intern(Callsign(callsign)), aircraftSizeCode(type, 'M'), airlineOf(callsign), schengen, distance };
+	};
+	auto stand = [&](const char* name) { return standNames.find(name); };
+
+	StandAllocator allocator;
+	Run run{ allocator, catalogueOf(airports.intern("LFMN"), {
+		{ "1", "C", true, "" },
+		{ "2", "CDE", true, "" },
+		{ "3", "C", true, "AFR HOP" },
+		{ "4", "C", false, "" },
+		{ "5", "C", true, "CARGO" },
+		{ "6", "", true, "GA/DHL" },
+	}, standNames) };
+
+	// Dedicated stand first, then the tightest size fit in natural order; label words don't restrict
+	auto stands = run({ flight("AFR123", "A320", true, 10), flight("EZY45", "A320", true, 20), flight("EZY46", "A320", true, 30), flight("EZY47", "A320", true, 40) });
+	CHECK(stands[0] == stand("3") && stands[1] == stand("1") && stands[2] == stand("5") && stands[3] == stand("2"));
+
+	// Size: only stands taking E; operator: DHL's stand is the only one left it may use
+	stands = run({ flight("BAW1", "B77W", true, 10), flight("DHL2", "B77W", true, 20), flight("UAE3", "B77W", true, 30) });
+	CHECK(stands[0] == stand("2") && stands[1] == stand("6") && stands[2] == EMPTY_ID);
+
+	// Zone: non-Schengen traffic only goes to non-Schengen stands
+	stands = run({ flight("BAW4", "A320", false, 10), flight("BAW5", "A320", false, 20) });
+	CHECK(stands[0] == stand("4") && stands[1] == EMPTY_ID);
+
+	// Nearest flight first when they compete for a stand
+	stands = run({ flight("BAW6", "A320", false, 50), flight("BAW7", "A320", false, 5) });
+	CHECK(stands[0] == EMPTY_ID && stands[1] == stand("4"));
+
+	// Taken stands are skipped
+	run.unavailable[stand("1")] = 1;
+	run.unavailable[stand("5")] = 1;
+	stands = run({ flight("EZY48", "A320", true, 10) });
+	CHECK(stands[0] == stand("2"));
+	run.unavailable.clear();
+
+	// Last cycle's proposal is kept while valid, even when a tighter stand is now free
+	const std::uint64_t kept = allocator.kept();
+	run.previous[callsigns.find(Callsign("EZY48"))] = stand("2");
+	stands = run({ flight("EZY48", "A320", true, 10) });
+	CHECK(stands[0] == stand("2") && allocator.kept() == kept + 1);
+	run.unavailable[stand("2")] = 1;
+	stands = run({ flight("EZY48", "A320", true, 10) });
+	CHECK(stands[0] == stand("1") && allocator.kept() == kept + 1);
+	run.unavailable.clear();
+	run.previous.clear();
+
+	// A busy hub: 300 inbounds over 400 stands, two cycles
+	std::vector<StandSpec> hub;
+	std::vector<std::string> names;
+	names.reserve(400);
+	const char* codes[] = { "C", "BC", "CD", "DE", "EF", "C" };
+	const char* uses[] = { "", "", "AFR", "", "CARGO", "EZY HOP" };
+	for (int i = 0; i < 400; ++i) names.push_back(std::string(1, static_cast<char>('A' + i / 50)) + std::to_string(i % 50 + 1));
+	for (int i = 0; i < 400; ++i) hub.push_back({ names[i].c_str(), codes[i % 6], i % 5 != 0, uses[i % 6] });
+	run.catalogue = catalogueOf(airports.intern("LFPG"), hub, standNames);
+	const char* types[] = { "A320", "B738", "A359", "E190", "B77W", "A388", "CRJ9" };
+	const char* airlines[] = { "AFR", "EZY", "DLH", "BAW", "UAE", "HOP", "RYR" };
+	std::vector<InboundFlight> inbound;
+	for (int i = 0; i < 300; ++i) {
+		const std::string callsign = std::string(airlines[i % 7]) + std::to_string(100 + i);
+		inbound.push_back(flight(callsign.c_str(), types[(i * 3) % 7], i % 4 != 0, 1000.0 + (i * 7919) % 300));
+	}
+	double worst = 0.0;
+	std::size_t placed = 0;
+	for (int cycle = 0; cycle < 2; ++cycle) {
+		std::vector<InboundFlight> flights = inbound;
+		std::vector<StandAllocator::Proposal> proposals;
+		const auto start = std::chrono::steady_clock::now();
+		allocator.allocate(run.catalogue, flights, [](StandId) { return false; }, run.previous, proposals);
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		worst = (std::max)(worst, ms);
+		IdMap<std::uint8_t> used;
+		for (const StandAllocator::Proposal& proposal : proposals) {
+			CHECK(!used.contains(proposal.stand));
+			used[proposal.stand] = 1;
+		}
+		if (cycle == 1) CHECK(proposals.size() == placed);
+		placed = proposals.size();
+		run.previous.clear();
+		for (const StandAllocator::Proposal& proposal : proposals) run.previous[proposal.callsign] = proposal.stand;
+	}
+	CHECK(placed > 200);
+	CHECK(worst < 10.0);
+
+	std::printf("StandAllocatorTest: 300 flights, %zu placed, worst cycle %.3f ms\n", placed, worst);
+	std::puts("StandAllocatorTest: ok");
+	return 0;
+}
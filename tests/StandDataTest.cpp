@@ -0,0 +1,111 @@
+// Catalogues built from a StandData.h generated by cmake/StandData.cmake out of tests/data/stands.csv,
+// the name lookups through the perfect hash, and their cost against interning.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "StandData.h"
+#include "core/StandCatalogue.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	static_assert(BuiltinStandTable::size() == 400 && BuiltinStandTable::airportCount() == 3);
+	static_assert(BUILTIN_STANDS.find(packIcao("ZZAB"), "C8") != BuiltinStandTable::NOT_FOUND);
+	static_assert(BUILTIN_STANDS[BUILTIN_STANDS.find(packIcao("ZZAB"), "C8")].name == "C8");
+	static_assert(BUILTIN_STANDS.find(packIcao("ZZAC"), "C8") == BuiltinStandTable::NOT_FOUND);
+
+	std::vector<std::string> split(const std::string& row) {
+		std::vector<std::string> fields;
+		std::stringstream in(row);
+		for (std::string field; std::getline(in, field, ',');) fields.push_back(field);
+		if (!row.empty() && row.back() == ',') fields.emplace_back();
+		return fields;
+	}
+
+	template <typename Fn>
+	double nsPerCall(std::size_t calls, Fn&& fn) {
+		const auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < calls; ++i) fn(i);
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(calls);
+	}
+
+}
+
+int main() {
+	StringTable standNames;
+	StringTable airports{ true };
+	const StaticStandIds<BuiltinStandTable> ids(BUILTIN_STANDS, standNames);
+
+	// Every compiled stand is found at its own index and resolves to the id interned up front
+	for (std::uint32_t i = 0; i < BUILTIN_STANDS.size(); ++i) {
+		const StaticStand& stand = BUILTIN_STANDS[i];
+		CHECK(BUILTIN_STANDS.find(stand.airport, stand.name) == i);
+		CHECK(BUILTIN_STANDS.indexOf(stand) == i);
+		CHECK(ids.resolve(stand.airport, stand.name) == standNames.find(stand.name));
+		CHECK(ids.id(stand) == standNames.find(stand.name));
+	}
+	const std::size_t interned = standNames.size();
+
+	// Names outside the table, or of another airport, still get their id from the string table
+	CHECK(BUILTIN_STANDS.find(packIcao("ZZAA"), "Z99") == BuiltinStandTable::NOT_FOUND);
+	CHECK(BUILTIN_STANDS.find(packIcao("ZZAA"), "a1l") == BuiltinStandTable::NOT_FOUND);
+	const StandId unknown = ids.resolve(packIcao("ZZAA"), "Z99");
+	CHECK(unknown == standNames.find("Z99") && standNames.size() == interned + 1);
+	CHECK(ids.resolve(packIcao("ZZAC"), "K10") == standNames.find("K10"));
+	CHECK(ids.resolve(packIcao("LFPG"), "A2") == standNames.find("A2"));
+
+	// Catalogues from the tables, and back to rows of the CSV
+	std::size_t stands = 0;
+	for (const char* icao : { "ZZAA", "ZZAB", "ZZAC" }) {
+		const auto entries = BUILTIN_STANDS.airport(packIcao(icao));
+		CHECK(!entries.empty());
+		const auto catalogue = StandCatalogue::fromStatic(airports.intern(icao), entries, ids, standNames);
+		CHECK(catalogue->stands.size() == entries.size());
+		for (const StaticStand& entry : entries) CHECK(catalogue->find(ids.id(entry)) != nullptr);
+		stands += entries.size();
+
+		std::ostringstream csv;
+		catalogue->writeCsv(csv, icao, standNames);
+		std::istringstream rows(csv.str());
+		std::size_t count = 0;
+		for (std::string row; std::getline(rows, row); ++count) {
+			const auto fields = split(row);
+			CHECK(fields.size() == 8 && fields[0] == icao);
+			const std::uint32_t index = BUILTIN_STANDS.find(packIcao(icao), fields[1]);
+			CHECK(index != BuiltinStandTable::NOT_FOUND);
+			const StaticStand& entry = BUILTIN_STANDS[index];
+			CHECK(entry.hasPosition == !fields[2].empty());
+			if (entry.hasPosition) {
+				CHECK(std::abs(std::strtod(fields[2].c_str(), nullptr) - entry.latitude) < 1e-6);
+				CHECK(std::abs(std::strtod(fields[3].c_str(), nullptr) - entry.longitude) < 1e-6);
+			}
+			CHECK((entry.radius > 0.0) == !fields[4].empty());
+			CHECK(fields[5] == entry.code && fields[6] == entry.use && (fields[7] == "1") == entry.schengen);
+		}
+		CHECK(count == entries.size());
+	}
+	CHECK(stands == BUILTIN_STANDS.size());
+
+	// Menu clicks and fetched catalogues: perfect hash against the string table
+	constexpr std::size_t CALLS = 2'000'000;
+	std::uint64_t sink = 0;
+	const double hashed = nsPerCall(CALLS, [&](std::size_t i) {
+		const StaticStand& stand = BUILTIN_STANDS[static_cast<std::uint32_t>(i % BUILTIN_STANDS.size())];
+		sink += ids.resolve(stand.airport, stand.name);
+	});
+	const double table = nsPerCall(CALLS, [&](std::size_t i) {
+		sink += standNames.intern(BUILTIN_STANDS[static_cast<std::uint32_t>(i % BUILTIN_STANDS.size())].name);
+	});
+	CHECK(sink != 0);
+	std::printf("StandDataTest: %zu stands, resolve %.1f ns, intern %.1f ns\n", BUILTIN_STANDS.size(), hashed, table);
+
+	std::puts("StandDataTest: ok");
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Check.h"
+#include "core/StandCatalogue.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	// k nearest accepted stands by exhaustive search
+	template <typename Filter>
+	std::vector<std::uint32_t> bruteForce(const StandSpatialIndex& index, const std::vector<StandInfo>& stands, double latitude, double longitude, std::size_t k, Filter accept) {
+		std::vector<std::pair<double, std::uint32_t>> all;
+		for (std::uint32_t i = 0; i < stands.size(); ++i) {
+			if (stands[i].hasPosition && accept(i)) all.push_back({ index.distanceSquared(i, latitude, longitude), i });
+		}
+		std::sort(all.begin(), all.end());
+		std::vector<std::uint32_t> result;
+		for (std::size_t n = 0; n < (std::min)(k, all.size()); ++n) result.push_back(all[n].second);
+		return result;
+	}
+
+	template <typename Filter>
+	void expectNearest(const StandSpatialIndex& index, const std::vector<StandInfo>& stands, double latitude, double longitude, std::size_t k, Filter accept) {
+		const auto start = std::chrono::steady_clock::now();
+		const std::vector<std::uint32_t> found = index.nearest(latitude, longitude, k, accept);
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		CHECK(found == bruteForce(index, stands, latitude, longitude, k, accept));
+		// Bounded by the grid size, however far the query is
+		CHECK(elapsed < std::chrono::milliseconds(20));
+	}
+
+}
+
+int main() {
+	// ~600 stands over 4 x 2.5 km around 49N 2.5E, one unlocated
+	std::vector<StandInfo> stands;
+	for (int row = 0; row < 20; ++row) {
+		for (int col = 0; col < 30; ++col) {
+			StandInfo stand;
+			stand.latitude = 49.0 + row * 0.00112 + (col % 3) * 0.0001;
+			stand.longitude = 2.5 + col * 0.00183;
+			stand.hasPosition = true;
+			stands.push_back(stand);
+		}
+	}
+	stands.push_back(StandInfo{});
+
+	StandSpatialIndex index;
+	index.build(stands);
+	CHECK(!index.empty());
+
+	const auto any = [](std::uint32_t) { return true; };
+	const auto even = [](std::uint32_t i) { return i % 2 == 0; };
+	const auto none = [](std::uint32_t) { return false; };
+
+	// On the grid
+	expectNearest(index, stands, 49.011, 2.53, 5, any);
+	expectNearest(index, stands, 49.0001, 2.5001, 5, even);
+	expectNearest(index, stands, 49.011, 2.53, 1000, any);
+
+	// Off the grid: beside the airport, a few km out, another continent
+	CHECK(!index.withinBounds(48.95, 2.45, 2000.0));
+	expectNearest(index, stands, 49.01, 2.45, 5, any);
+	expectNearest(index, stands, 48.95, 2.60, 5, even);
+	expectNearest(index, stands, 49.05, 2.40, 3, any);
+	expectNearest(index, stands, 40.64, -73.78, 5, any);
+	expectNearest(index, stands, -33.94, 151.18, 5, even);
+
+	// Nothing accepted: every cell visited once, still bounded
+	expectNearest(index, stands, 40.64, -73.78, 5, none);
+	CHECK(index.nearest(40.64, -73.78, 5, none).empty());
+
+	std::puts("StandSpatialIndexTest: ok");
+	return 0;
+}
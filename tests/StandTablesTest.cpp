@@ -0,0 +1,46 @@
+#include <array>
+#include <cstdio>
+
+#include "Check.h"
+#include "core/StandTables.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	constexpr std::array<StaticStand, 6> STANDS = { {
+		{ packIcao("LFMN"), "1", true, 43.66, 7.21, 30.0, "C", "", true },
+		{ packIcao("LFMN"), "2", true, 43.66, 7.22, 30.0, "CD", "AFR", true },
+		{ packIcao("LFPG"), "A1", true, 49.00, 2.55, 40.0, "E", "", true },
+		{ packIcao("LFPG"), "A2", false, 0.0, 0.0, 0.0, "", "", false },
+		{ packIcao("LFPG"), "K10", true, 49.01, 2.56, 0.0, "ABC", "", true },
+		{ packIcao("LFRS"), "3", true, 47.15, -1.61, 25.0, "C", "", true },
+	} };
+
+	constexpr StaticStandTable<6, 3> TABLE{ STANDS };
+	constexpr StaticStandTable<0, 0> EMPTY{ std::array<StaticStand, 0>{} };
+
+	// Resolved by the compiler
+	static_assert(packIcao("LFPG") == 0x4C465047u && packIcao("lfpg") == packIcao("LFPG"));
+	static_assert(packIcao("LFP") == 0 && packIcao("LF-G") == 0);
+	static_assert(isFrenchAirport(packIcao("LFMN")) && !isFrenchAirport(packIcao("EGLL")) && !isFrenchAirport(0));
+	static_assert(TABLE.airport(packIcao("LFPG")).size() == 3 && TABLE.airport(packIcao("LFPG"))[2].name == "K10");
+	static_assert(TABLE.airport(packIcao("EGLL")).empty() && EMPTY.airport(packIcao("LFPG")).empty());
+
+}
+
+int main() {
+	std::size_t total = 0;
+	for (const char* icao : { "LFMN", "LFPG", "LFRS" }) {
+		const auto stands = TABLE.airport(packIcao(icao));
+		CHECK(!stands.empty());
+		for (const StaticStand& stand : stands) CHECK(stand.airport == packIcao(icao));
+		total += stands.size();
+	}
+	CHECK(total == TABLE.size() && TABLE.airportCount() == 3);
+	CHECK(TABLE.airport(packIcao("LFMD")).empty());
+	CHECK(TABLE.airport(0).empty());
+
+	std::puts("StandTablesTest: ok");
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "Check.h"
+#include "core/TagCache.h"
+
+using namespace rampAgent;
+
+namespace {
+
+	// Callsigns whose index positions collide in a cache of this capacity
+	std::vector<CallsignId> sameHome(std::uint32_t capacity, std::uint32_t home, std::size_t count) {
+		std::uint32_t indexSize = 2;
+		while (indexSize < capacity * 2) indexSize <<= 1;
+		std::vector<CallsignId> callsigns;
+		for (CallsignId callsign = 1; callsigns.size() < count; ++callsign) {
+			if (((callsign * 0x9E3779B1u) & (indexSize - 1)) == home) callsigns.push_back(callsign);
+		}
+		return callsigns;
+	}
+
+	// Backward-shift deletion keeps every probe sequence reachable, also across the index end
+	void removal() {
+		const auto none = [](CallsignId) { CHECK(false); };
+		for (std::uint32_t home : { 3u, 15u }) { // capacity 8: 16 positions, 15 wraps around
+			TagCache<int> cache(8);
+			const std::vector<CallsignId> cluster = sameHome(8, home, 4);
+			const std::vector<CallsignId> next = sameHome(8, (home + 1) & 15, 2);
+			for (CallsignId callsign : cluster) cache.put(callsign, static_cast<int>(callsign), none);
+			for (CallsignId callsign : next) cache.put(callsign, static_cast<int>(callsign), none);
+			CHECK(cache.size() == 6);
+
+			for (CallsignId erased : { cluster[0], cluster[2], next[0] }) {
+				CHECK(cache.erase(erased) && !cache.erase(erased) && cache.find(erased) == nullptr);
+			}
+			for (CallsignId callsign : { cluster[1], cluster[3], next[1] }) CHECK(cache.find(callsign) != nullptr && *cache.find(callsign) == static_cast<int>(callsign));
+			CHECK(cache.size() == 3);
+
+			// Refilled from the freed slots
+			for (CallsignId callsign : { cluster[0], cluster[2], next[0] }) cache.put(callsign, -1, none);
+			for (CallsignId callsign : cluster) CHECK(cache.find(callsign) != nullptr);
+			CHECK(cache.size() == 6);
+		}
+	}
+
+	// Random puts, touches, erases and sweeps against a reference map, with capacity evictions
+	void randomOperations() {
+		constexpr std::uint32_t CAPACITY = 64;
+		constexpr int OPERATIONS = 2'000'000;
+		struct Reference {
+			int value;
+			std::uint32_t lastUsed;
+		};
+		TagCache<int> cache(CAPACITY);
+		std::unordered_map<CallsignId, Reference> reference;
+		std::mt19937 random(42);
+		std::uniform_int_distribution<CallsignId> callsigns(1, 200);
+		std::uniform_int_distribution<int> kind(0, 99);
+		std::uint64_t evictions = 0;
+
+		for (int op = 0; op < OPERATIONS; ++op) {
+			const CallsignId callsign = callsigns(random);
+			const int k = kind(random);
+			if (k < 40) {
+				const bool present = reference.count(callsign) != 0;
+				cache.put(callsign, op, [&](CallsignId evicted) {
+					CHECK(!present && reference.size() == CAPACITY);
+					// Least recently used: no entry idle for longer
+					const std::uint32_t age = cache.generation() - reference.at(evicted).lastUsed;
+					for (const auto& [other, entry] : reference) CHECK(cache.generation() - entry.lastUsed <= age);
+					reference.erase(evicted);
+					++evictions;
+				});
+				reference[callsign] = { op, cache.generation() };
+			}
+			else if (k < 70) {
+				const auto it = reference.find(callsign);
+				CHECK(cache.touch(callsign) == (it != reference.end()));
+				if (it != reference.end()) it->second.lastUsed = cache.generation();
+			}
+			else if (k < 85) {
+				CHECK(cache.erase(callsign) == (reference.erase(callsign) == 1));
+			}
+			else if (k < 99) {
+				const int* value = cache.find(callsign);
+				const auto it = reference.find(callsign);
+				CHECK((value != nullptr) == (it != reference.end()));
+				if (value != nullptr) CHECK(*value == it->second.value);
+			}
+			else {
+				cache.sweep([&](CallsignId evicted) {
+					CHECK(cache.generation() - reference.at(evicted).lastUsed >= TagCache<int>::IDLE_SWEEPS);
+					reference.erase(evicted);
+				});
+				for (const auto& [other, entry] : reference) CHECK(cache.generation() - entry.lastUsed < TagCache<int>::IDLE_SWEEPS);
+			}
+			CHECK(cache.size() == reference.size());
+		}
+		std::size_t seen = 0;
+		cache.forEach([&](CallsignId callsign, int value) {
+			CHECK(reference.at(callsign).value == value);
+			++seen;
+		});
+		CHECK(seen == reference.size() && evictions == cache.capacityEvictions() && evictions > 0);
+	}
+
+	// 12 hours of traffic: a new callsign every 2 s, each visible for 15 to 90 minutes, 30% lost
+	// from radar without a disconnect. Radar updates every 5 s, a sweep every 30 s.
+	void sessionReplay() {
+		constexpr std::uint32_t CAPACITY = 4096; // RampAgent.h TAG_CACHE_CAPACITY
+		TagCache<int> cache(CAPACITY);
+		const std::size_t bytes = cache.memoryBytes();
+		struct Aircraft {
+			CallsignId callsign;
+			int leaves; // s
+			bool disconnects;
+		};
+		std::vector<Aircraft> live;
+		std::mt19937 random(7);
+		std::uniform_int_distribution<int> visible(15 * 60, 90 * 60);
+		std::uniform_int_distribution<int> percent(0, 99);
+		const auto none = [](CallsignId) { CHECK(false); };
+		CallsignId next = 1;
+		std::size_t largest = 0, largestLive = 0;
+		std::uint64_t forgotten = 0;
+
+		for (int second = 0; second < 12 * 3600; ++second) {
+			if (second % 2 == 0) {
+				live.push_back({ next, second + visible(random), percent(random) >= 30 });
+				cache.put(next++, second, none);
+			}
+			if (second % 5 == 0) {
+				for (const Aircraft& aircraft : live) CHECK(cache.touch(aircraft.callsign));
+			}
+			std::erase_if(live, [&](const Aircraft& aircraft) {
+				if (aircraft.leaves > second) return false;
+				if (aircraft.disconnects) CHECK(cache.erase(aircraft.callsign));
+				return true;
+			});
+			if (second % 30 == 0) forgotten += cache.sweep([](CallsignId) {});
+			largest = (std::max)(largest, cache.size());
+			largestLive = (std::max)(largestLive, live.size());
+			CHECK(cache.memoryBytes() == bytes);
+		}
+		CHECK(cache.capacityEvictions() == 0 && forgotten > 0);
+		CHECK(largest < CAPACITY && largest <= largestLive + 30 / 2 * TagCache<int>::IDLE_SWEEPS + 30);
+		std::printf("TagCacheTest: 12 h, %u callsigns, at most %zu live and %zu cached, %zu bytes throughout\n", next - 1, largestLive, largest, bytes);
+	}
+
+}
+
+int main() {
+	removal();
+	randomOperations();
+	sessionReplay();
+	std::puts("TagCacheTest: ok");
+	return 0;
+}
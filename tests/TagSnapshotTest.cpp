@@ -0,0 +1,191 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "core/TagSnapshot.h"
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	constexpr std::chrono::minutes MAX_AGE{ 10 };
+	constexpr std::size_t SAVED_UNIX_OFFSET = 32; // FileHeader::savedUnix
+
+	struct Tables {
+		CallsignTable callsigns;
+		StringTable standNames;
+		StringTable remarks;
+	};
+
+	std::vector<char> readBytes(const std::string& path) {
+		std::ifstream in(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	void writeBytes(const std::string& path, const std::vector<char>& bytes) {
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	// A busy hub: every aircraft has a tag, 1 in 4 a remark, server data for all of them plus blocked stands
+	void fill(std::size_t count, Tables& tables, std::vector<TagSnapshot::Entry>& entries, OccupancyState& occupancy) {
+		occupancy.received = true;
+		for (std::size_t i = 0; i < count; ++i) {
+			const CallsignId callsign = tables.callsigns.intern("AFR" + std::to_string(1000 + i));
+			const StandId stand = tables.standNames.intern("S" + std::to_string(i));
+			const StringId remark = i % 4 == 0 ? tables.remarks.intern("REMOTE " + std::to_string(i % 7)) : EMPTY_ID;
+			entries.push_back({ callsign, stand, remark, static_cast<std::uint32_t>(0x00FF00 + i % 3) });
+			occupancy.assignments.push_back({ callsign, i % 50 == 0 ? EMPTY_ID : stand, remark, i % 50 == 0 });
+			occupancy.unavailable.push_back({ stand, i % 9 == 0 ? NO_ID : callsign, i % 2 == 0 });
+		}
+		for (std::size_t i = 0; i < count / 10; ++i) occupancy.unavailable.push_back({ tables.standNames.intern("B" + std::to_string(i)), NO_ID, false });
+	}
+
+	bool load(const std::string& path, Tables& tables, std::vector<TagSnapshot::Entry>& entries, OccupancyState& occupancy) {
+		std::chrono::system_clock::time_point saved;
+		return TagSnapshot::read(path, MAX_AGE, tables.callsigns, tables.standNames, tables.remarks, entries, occupancy, saved);
+	}
+
+	// Written into other tables: compared by text, ids may differ
+	void checkSame(const Tables& a, const std::vector<TagSnapshot::Entry>& entriesA, const OccupancyState& occupancyA,
+		const Tables& b, const std::vector<TagSnapshot::Entry>& entriesB, const OccupancyState& occupancyB) {
+		CHECK(entriesA.size() == entriesB.size());
+		for (std::size_t i = 0; i < entriesA.size(); ++i) {
+			CHECK(a.callsigns.view(entriesA[i].callsign) == b.callsigns.view(entriesB[i].callsign));
+			CHECK(a.standNames.view(entriesA[i].stand) == b.standNames.view(entriesB[i].stand));
+			CHECK(a.remarks.view(entriesA[i].remark) == b.remarks.view(entriesB[i].remark));
+			CHECK(entriesA[i].color == entriesB[i].color);
+		}
+		CHECK(occupancyA.received == occupancyB.received);
+		CHECK(occupancyA.assignments.size() == occupancyB.assignments.size() && occupancyA.unavailable.size() == occupancyB.unavailable.size());
+		for (std::size_t i = 0; i < occupancyA.assignments.size(); ++i) {
+			const OccupancyState::Assignment& x = occupancyA.assignments[i];
+			const OccupancyState::Assignment& y = occupancyB.assignments[i];
+			CHECK(a.callsigns.view(x.callsign) == b.callsigns.view(y.callsign) && a.standNames.view(x.stand) == b.standNames.view(y.stand));
+			CHECK(a.remarks.view(x.remark) == b.remarks.view(y.remark) && x.manual == y.manual);
+			CHECK((x.stand == EMPTY_ID) == (y.stand == EMPTY_ID));
+		}
+		for (std::size_t i = 0; i < occupancyA.unavailable.size(); ++i) {
+			const OccupancyState::Unavailable& x = occupancyA.unavailable[i];
+			const OccupancyState::Unavailable& y = occupancyB.unavailable[i];
+			CHECK(a.standNames.view(x.stand) == b.standNames.view(y.stand) && x.occupied == y.occupied);
+			CHECK((x.callsign == NO_ID) == (y.callsign == NO_ID));
+			if (x.callsign != NO_ID) CHECK(a.callsigns.view(x.callsign) == b.callsigns.view(y.callsign));
+		}
+	}
+
+}
+
+int main() {
+	const std::string path = (std::filesystem::temp_directory_path() / "RampAgentTagSnapshotTest.bin").string();
+	const std::string damaged = path + ".damaged";
+
+	Tables tables;
+	std::vector<TagSnapshot::Entry> entries;
+	OccupancyState occupancy;
+	fill(1000, tables, entries, occupancy);
+	CHECK(TagSnapshot::write(path, entries, occupancy, tables.callsigns, tables.standNames, tables.remarks));
+	CHECK(!std::filesystem::exists(path + ".tmp"));
+
+	// Round trip into empty tables, as at plugin load
+	Tables readTables;
+	std::vector<TagSnapshot::Entry> readEntries;
+	OccupancyState readOccupancy;
+	const auto start = Clock::now();
+	CHECK(load(path, readTables, readEntries, readOccupancy));
+	const double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	checkSame(tables, entries, occupancy, readTables, readEntries, readOccupancy);
+	// Fetched when saved, so local vacations are reconciled against the right time
+	CHECK(readOccupancy.fetched <= Clock::now() && Clock::now() - readOccupancy.fetched < std::chrono::minutes(1));
+
+	// Tags alone, as before the occupancy lists were saved
+	const OccupancyState none;
+	CHECK(TagSnapshot::write(path, entries, none, tables.callsigns, tables.standNames, tables.remarks));
+	Tables tagTables;
+	std::vector<TagSnapshot::Entry> tagEntries;
+	OccupancyState tagOccupancy;
+	const auto tagStart = Clock::now();
+	CHECK(load(path, tagTables, tagEntries, tagOccupancy) && tagEntries.size() == entries.size() && !tagOccupancy.received);
+	const double tagLoadMs = std::chrono::duration<double, std::milli>(Clock::now() - tagStart).count();
+
+	// Server data matches whatever the version and fetch time
+	OccupancyState copy = occupancy;
+	copy.version = 42;
+	copy.fetched = Clock::now();
+	CHECK(copy.sameStands(occupancy));
+	copy.unavailable.back().occupied = !copy.unavailable.back().occupied;
+	CHECK(!copy.sameStands(occupancy));
+
+	// Saved before any server data: tags only, the caller's occupancy is left as it is
+	Tables noDataTables;
+	std::vector<TagSnapshot::Entry> noDataEntries;
+	OccupancyState noData;
+	noDataEntries.push_back({ noDataTables.callsigns.intern("EZY12"), noDataTables.standNames.intern("A1"), EMPTY_ID, 0x0000FF });
+	noData.assignments.push_back({ noDataEntries[0].callsign, noDataEntries[0].stand, EMPTY_ID, false }); // not received: not saved
+	CHECK(TagSnapshot::write(path, noDataEntries, noData, noDataTables.callsigns, noDataTables.standNames, noDataTables.remarks));
+	{
+		Tables t;
+		std::vector<TagSnapshot::Entry> e;
+		OccupancyState o;
+		CHECK(load(path, t, e, o) && e.size() == 1 && t.callsigns.view(e[0].callsign) == "EZY12");
+		CHECK(!o.received && o.assignments.empty() && o.unavailable.empty());
+	}
+
+	// Max age: the header time is not covered by the payload hash, so it can be moved back
+	CHECK(TagSnapshot::write(path, entries, occupancy, tables.callsigns, tables.standNames, tables.remarks));
+	const std::vector<char> bytes = readBytes(path);
+	const auto withAge = [&](std::chrono::seconds age) {
+		std::vector<char> copy = bytes;
+		const std::int64_t savedUnix = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() - age).time_since_epoch()).count();
+		std::memcpy(copy.data() + SAVED_UNIX_OFFSET, &savedUnix, sizeof(savedUnix));
+		writeBytes(damaged, copy);
+		Tables t;
+		std::vector<TagSnapshot::Entry> e;
+		OccupancyState o;
+		const bool loaded = load(damaged, t, e, o);
+		CHECK(loaded == !e.empty() && loaded == o.received); // nothing half-loaded
+		if (loaded) CHECK(Clock::now() - o.fetched >= age - std::chrono::seconds(2));
+		return loaded;
+	};
+	CHECK(withAge(std::chrono::seconds(60)));
+	CHECK(withAge(MAX_AGE - std::chrono::seconds(5)));
+	CHECK(!withAge(MAX_AGE + std::chrono::seconds(5)));
+
+	// Damaged files are rejected as a whole
+	const auto rejected = [&](std::vector<char> copy) {
+		writeBytes(damaged, copy);
+		Tables t;
+		std::vector<TagSnapshot::Entry> e;
+		OccupancyState o;
+		return !load(damaged, t, e, o) && e.empty() && !o.received;
+	};
+	{
+		std::vector<char> flipped = bytes;
+		flipped[flipped.size() - 3] ^= 0x20;
+		CHECK(rejected(flipped));
+		CHECK(rejected(std::vector<char>(bytes.begin(), bytes.end() - 10)));
+		std::vector<char> version = bytes;
+		version[8] = static_cast<char>(TagSnapshot::VERSION + 1);
+		CHECK(rejected(version));
+		CHECK(rejected({}));
+	}
+	std::filesystem::remove(damaged);
+	std::filesystem::remove(path);
+	Tables t;
+	std::vector<TagSnapshot::Entry> e;
+	OccupancyState o;
+	CHECK(!load(path, t, e, o));
+
+	std::printf("TagSnapshotTest: 1000 tags, %zu assignments, %zu unavailable stands in %zu bytes, loaded in %.2f ms (tags alone %.2f ms)\n",
+		occupancy.assignments.size(), occupancy.unavailable.size(), bytes.size(), loadMs, tagLoadMs);
+	std::puts("TagSnapshotTest: ok");
+	return 0;
+}
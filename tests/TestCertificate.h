@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "Check.h"
+
+// Self-signed certificate, by default for 127.0.0.1 and localhost, made at run time for local TLS
+// servers (httplib::SSLServer(cert(), key()), or keyFile() and caFile() for external ones).
+// caFile() is the PEM to trust, e.g. HttplibClient(caFile).
+class TestCertificate {
+public:
+	explicit TestCertificate(const std::string& name, const char* altNames = "IP:127.0.0.1,DNS:localhost") {
+		key_ = EVP_EC_gen("P-256");
+		cert_ = X509_new();
+		CHECK(key_ != nullptr && cert_ != nullptr);
+		X509_set_version(cert_, 2);
+		ASN1_INTEGER_set(X509_get_serialNumber(cert_), 1);
+		X509_gmtime_adj(X509_getm_notBefore(cert_), -60);
+		X509_gmtime_adj(X509_getm_notAfter(cert_), 24 * 3600);
+		X509_set_pubkey(cert_, key_);
+		X509_NAME* subject = X509_get_subject_name(cert_);
+		X509_NAME_add_entry_by_txt(subject, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+		X509_set_issuer_name(cert_, subject);
+		X509V3_CTX context;
+		X509V3_set_ctx_nodb(&context);
+		X509V3_set_ctx(&context, cert_, cert_, nullptr, nullptr, 0);
+		addExtension(context, NID_subject_alt_name, altNames);
+		addExtension(context, NID_basic_constraints, "critical,CA:TRUE");
+		CHECK(X509_sign(cert_, key_, EVP_sha256()) > 0);
+
+		caFile_ = (std::filesystem::temp_directory_path() / (name + ".pem")).string();
+		std::FILE* file = std::fopen(caFile_.c_str(), "w");
+		CHECK(file != nullptr && PEM_write_X509(file, cert_) == 1);
+		std::fclose(file);
+		keyFile_ = (std::filesystem::temp_directory_path() / (name + ".key")).string();
+		file = std::fopen(keyFile_.c_str(), "w");
+		CHECK(file != nullptr && PEM_write_PrivateKey(file, key_, nullptr, nullptr, 0, nullptr, nullptr) == 1);
+		std::fclose(file);
+	}
+
+	~TestCertificate() {
+		std::error_code ignored;
+		std::filesystem::remove(caFile_, ignored);
+		std::filesystem::remove(keyFile_, ignored);
+		X509_free(cert_);
+		EVP_PKEY_free(key_);
+	}
+
+	TestCertificate(const TestCertificate&) = delete;
+	TestCertificate& operator=(const TestCertificate&) = delete;
+
+	X509* cert() const { return cert_; }
+	EVP_PKEY* key() const { return key_; }
+	const std::string& caFile() const { return caFile_; }
+	const std::string& keyFile() const { return keyFile_; }
+
+private:
+	void addExtension(X509V3_CTX& context, int nid, const char* value) {
+		X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &context, nid, value);
+		CHECK(extension != nullptr && X509_add_ext(cert_, extension, -1) == 1);
+		X509_EXTENSION_free(extension);
+	}
+
+	EVP_PKEY* key_ = nullptr;
+	X509* cert_ = nullptr;
+	std::string caFile_;
+	std::string keyFile_;
+};
@@ -0,0 +1,94 @@
+// Without it Nagle holds back the test server's response for the client's delayed ACK, ~40 ms
+// per call that hide the handshake
+#define CPPHTTPLIB_TCP_NODELAY true
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+#include "TestCertificate.h"
+#include "core/ApiClient.h"
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	// Closes the connection after every answer, so each call opens a new one
+	class ClosingServer {
+	public:
+		explicit ClosingServer(const TestCertificate& certificate) : server_(certificate.cert(), certificate.key()) {
+			server_.set_keep_alive_max_count(1);
+			server_.Get("/ok", [](const httplib::Request&, httplib::Response& response) { response.set_content("ok", "text/plain"); });
+			server_.Get("/slow", [](const httplib::Request&, httplib::Response& response) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10)); // concurrent calls overlap
+				response.set_content("ok", "text/plain");
+			});
+			port_ = server_.bind_to_any_port("127.0.0.1");
+			CHECK(port_ > 0);
+			thread_ = std::thread([this] { server_.listen_after_bind(); });
+			server_.wait_until_ready();
+		}
+
+		~ClosingServer() {
+			server_.stop();
+			thread_.join();
+		}
+
+		std::string host() const { return "127.0.0.1:" + std::to_string(port_); }
+
+	private:
+		httplib::SSLServer server_;
+		std::thread thread_;
+		int port_ = 0;
+	};
+
+	double ms(Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+}
+
+int main() {
+	const TestCertificate certificate("RampAgentTlsSessionTest");
+	ClosingServer server(certificate);
+
+	// The first connection does a full handshake, every reconnect resumes its session
+	HttplibClient client(certificate.caFile());
+	constexpr int CALLS = 20;
+	CHECK(client.get(server.host(), "/ok").body == "ok" && client.resumedSessions() == 0);
+	auto start = Clock::now();
+	for (int i = 1; i < CALLS; ++i) CHECK(client.get(server.host(), "/ok").body == "ok");
+	const double resumedMs = ms(Clock::now() - start) / (CALLS - 1);
+	CHECK(client.connections() == CALLS && client.resumedSessions() == CALLS - 1);
+
+	// Clients the pool adds for concurrent calls resume too. Handshakes in flight together may
+	// share the last ticket, now and then one of them ends in a full handshake (1 run in 20 here).
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&] {
+			for (int i = 0; i < 3; ++i) CHECK(client.get(server.host(), "/slow").body == "ok");
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+	CHECK(client.connections() == CALLS + 12 && client.resumedSessions() >= client.connections() - 2);
+	const std::uint64_t missed = client.connections() - 1 - client.resumedSessions();
+
+	// Another host (here the same server by name) has its own session
+	const std::string byName = "localhost:" + server.host().substr(server.host().find(':') + 1);
+	CHECK(client.get(byName, "/ok").body == "ok" && client.resumedSessions() == client.connections() - 2 - missed);
+	CHECK(client.get(byName, "/ok").body == "ok" && client.resumedSessions() == client.connections() - 2 - missed);
+
+	// Without resumption: a new client, so a full handshake, for every connection
+	start = Clock::now();
+	for (int i = 0; i < CALLS; ++i) {
+		HttplibClient fresh(certificate.caFile());
+		CHECK(fresh.get(server.host(), "/ok").body == "ok" && fresh.resumedSessions() == 0);
+	}
+	const double fullMs = ms(Clock::now() - start) / CALLS;
+
+	std::printf("TlsSessionTest: call on a new connection: %.2f ms from a new client, %.2f ms resumed\n", fullMs, resumedMs);
+	std::puts("TlsSessionTest: ok");
+	return 0;
+}
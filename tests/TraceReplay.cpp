@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <latch>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "Check.h"
+#include "core/OccupancyState.h"
+#include "core/Trace.h"
+
+// Replays synthetic occupancy polls on several named threads with tracing off, then on, checks the
+// exported Chrome trace and reports the cost of tracing. Usage: TraceReplay [cycles] [trace.json]
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	constexpr const char* THREADS[] = { "EuroScope UI", "Occupancy poll", "Stand catalogue refresh", "DNS cache" };
+	constexpr std::size_t STANDS = 300;
+
+	// An /api/occupancy response with STANDS stands, most of them assigned
+	nlohmann::ordered_json occupancyResponse(CallsignTable& callsigns) {
+		nlohmann::ordered_json assigned = nlohmann::ordered_json::array(), occupied = nlohmann::ordered_json::array(), blocked = nlohmann::ordered_json::array();
+		for (std::size_t i = 0; i < STANDS; ++i) {
+			const std::string callsign = "AFR" + std::to_string(100 + i);
+			callsigns.intern(callsign);
+			nlohmann::ordered_json stand = { { "name", std::to_string(i) }, { "callsign", callsign } };
+			if (i % 10 == 0) blocked.push_back({ { "name", std::to_string(i) } });
+			else if (i % 3 == 0) occupied.push_back(stand);
+			else assigned.push_back({ { "name", std::to_string(i) }, { "callsign", callsign }, { "remark", "SCHENGEN" } });
+		}
+		return { { "assignedStands", assigned }, { "occupiedStands", occupied }, { "blockedStands", blocked } };
+	}
+
+	// One poll cycle as the plugin runs it, spans named like the plugin's
+	std::size_t replayCycle(const nlohmann::ordered_json& response, const CallsignTable& callsigns, StringTable& standNames, StringTable& remarks, OccupancyStore& store) {
+		TRACE_SPAN("runUpdate");
+		std::shared_ptr<OccupancyState> state;
+		{
+			TRACE_SPAN("parse");
+			state = OccupancyState::fromJson(response, callsigns, standNames, remarks);
+		}
+		{
+			TRACE_SPAN("publish");
+			store.publish(std::move(state));
+		}
+		TRACE_SPAN("diff");
+		std::size_t manual = 0;
+		for (const OccupancyState::Assignment& assignment : store.pin()->assignments) manual += assignment.manual;
+		return manual;
+	}
+
+	// Runs cycles on each named thread, names set before any span; mean us per cycle
+	double replay(std::size_t cycles) {
+		CallsignTable callsigns;
+		StringTable standNames, remarks;
+		const nlohmann::ordered_json response = occupancyResponse(callsigns);
+		std::vector<std::thread> threads;
+		std::vector<double> meanUs(std::size(THREADS));
+		std::latch done(std::size(THREADS)); // no thread exits, freeing its ring for the next, before all recorded
+		for (std::size_t t = 0; t < std::size(THREADS); ++t) {
+			threads.emplace_back([&, t] {
+				trace::Tracer::instance().setThreadName(THREADS[t]);
+				StringTable names, threadRemarks;
+				OccupancyStore store;
+				const auto start = Clock::now();
+				for (std::size_t i = 0; i < cycles; ++i) replayCycle(response, callsigns, names, threadRemarks, store);
+				meanUs[t] = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / static_cast<double>(cycles);
+				done.arrive_and_wait();
+			});
+		}
+		for (std::thread& thread : threads) thread.join();
+		double sum = 0.0;
+		for (double us : meanUs) sum += us;
+		return sum / static_cast<double>(meanUs.size());
+	}
+
+	// ns per empty span
+	double spanCost(std::size_t spans) {
+		const auto start = Clock::now();
+		for (std::size_t i = 0; i < spans; ++i) TRACE_SPAN("bench");
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(spans);
+	}
+
+	nlohmann::json readTrace(const std::string& path) {
+		std::ifstream in(path);
+		CHECK(in.good());
+		return nlohmann::json::parse(in); // throws on malformed output
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t cycles = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+	const std::string path = argc > 2 ? argv[2] : (std::filesystem::temp_directory_path() / "RampAgent_trace_replay.json").string();
+	trace::Tracer& tracer = trace::Tracer::instance();
+	CHECK(cycles > 0);
+
+	// Disabled: named threads and spans leave nothing behind, no ring is created
+	tracer.setThreadName("EuroScope UI");
+	const double disabledSpanNs = spanCost(1000000);
+	const double disabledCycleUs = replay(cycles);
+	CHECK(tracer.dump(path) == 0);
+	CHECK(readTrace(path)["traceEvents"].empty());
+
+	// Enabled: rings are created on the first span, carrying the names set before
+	tracer.setEnabled(true);
+	const double enabledCycleUs = replay(cycles);
+	tracer.setEnabled(false);
+	const std::size_t written = tracer.dump(path);
+	const nlohmann::json trace = readTrace(path);
+	CHECK(trace["traceEvents"].size() == written);
+
+	std::map<int, std::string> labels;
+	std::map<int, std::size_t> spans;
+	const std::set<std::string> names = { "runUpdate", "parse", "publish", "diff" };
+	const std::uint64_t end = tracer.nowUs();
+	for (const nlohmann::json& event : trace["traceEvents"]) {
+		if (event["ph"] == "M") {
+			labels[event["tid"].get<int>()] = event["args"]["name"].get<std::string>();
+			continue;
+		}
+		CHECK(event["ph"] == "X" && names.count(event["name"].get<std::string>()) == 1);
+		CHECK(event["ts"].get<std::uint64_t>() + event["dur"].get<std::uint64_t>() <= end);
+		++spans[event["tid"].get<int>()];
+	}
+	std::set<std::string> seen;
+	for (const auto& [tid, count] : spans) {
+		CHECK(labels.count(tid) == 1);
+		seen.insert(labels[tid]);
+		CHECK(count == (std::min)(cycles * names.size(), trace::ThreadBuffer::CAPACITY));
+	}
+	for (std::size_t t = 0; t < std::size(THREADS); ++t) CHECK(seen.count(THREADS[t]) == 1);
+	CHECK(spans.size() == std::size(THREADS)); // one ring per replay thread, none for main
+
+	const double enabledSpanNs = [&] {
+		tracer.setEnabled(true);
+		const double ns = spanCost(100000);
+		tracer.setEnabled(false);
+		return ns;
+	}();
+
+	std::printf("TraceReplay: %zu cycles x %zu threads, %zu stands, %zu events in %s\n", cycles, std::size(THREADS), STANDS, written, path.c_str());
+	std::printf("TraceReplay: span %.1f ns disabled, %.1f ns enabled; cycle %.1f us disabled, %.1f us enabled\n", disabledSpanNs, enabledSpanNs, disabledCycleUs, enabledCycleUs);
+	std::puts("TraceReplay: ok");
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "Check.h"
+#include "core/UpdateScheduler.h"
+
+using namespace rampAgent;
+using namespace std::chrono_literals;
+
+namespace {
+
+	struct Update {
+		CallsignId callsign;
+		int value;
+	};
+
+	constexpr std::chrono::microseconds BUDGET{ 2000 }; // RampAgent.h UPDATE_SLICE_BUDGET
+	constexpr std::chrono::microseconds UPDATE_COST{ 20 };   // a tag update with its EuroScope calls
+
+	void spin(std::chrono::microseconds cost) {
+		const auto until = std::chrono::steady_clock::now() + cost;
+		while (std::chrono::steady_clock::now() < until) {}
+	}
+
+	// Priorities, and a newer update replacing one still queued
+	void ordering() {
+		UpdateScheduler<Update> scheduler;
+		scheduler.push({ 1, 10 }, UpdatePriority::Low);
+		scheduler.push({ 2, 20 }, UpdatePriority::High);
+		scheduler.push({ 3, 30 }, UpdatePriority::Low);
+		scheduler.push({ 1, 11 }, UpdatePriority::High); // supersedes { 1, 10 }
+		CHECK(scheduler.backlog() == 3 && scheduler.queued(1) && !scheduler.queued(4));
+
+		std::vector<int> applied;
+		CHECK(scheduler.run(BUDGET, [&](const Update& update) { applied.push_back(update.value); }) == 3);
+		CHECK((applied == std::vector<int>{ 20, 11, 30 }));
+		CHECK(scheduler.backlog() == 0 && scheduler.run(BUDGET, [](const Update&) { CHECK(false); }) == 0);
+	}
+
+	// 500 aircraft changing at once, e.g. the first poll after connecting: spread over OnTimer ticks,
+	// each within the budget plus the items between two clock checks
+	void burst() {
+		UpdateScheduler<Update> scheduler;
+		for (CallsignId callsign = 1; callsign <= 500; ++callsign) {
+			scheduler.push({ callsign, 0 }, callsign % 3 == 0 ? UpdatePriority::High : UpdatePriority::Low);
+		}
+		for (CallsignId callsign = 1; callsign <= 500; callsign += 10) scheduler.push({ callsign, 1 }, UpdatePriority::Low); // polled again meanwhile
+
+		std::size_t total = 0, ticks = 0, highAfterLow = 0;
+		bool lowSeen = false;
+		std::chrono::microseconds worst{ 0 };
+		while (scheduler.backlog() != 0) {
+			const auto start = std::chrono::steady_clock::now();
+			total += scheduler.run(BUDGET, [&](const Update& update) {
+				const bool high = update.callsign % 3 == 0 && update.value == 0;
+				if (high && lowSeen) ++highAfterLow;
+				lowSeen = lowSeen || !high;
+				spin(UPDATE_COST);
+			});
+			worst = (std::max)(worst, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+			++ticks;
+		}
+		CHECK(total == 500 && highAfterLow == 0);
+		CHECK(ticks >= 5 && scheduler.slices() == ticks);
+		CHECK(scheduler.worstSliceUs() <= static_cast<std::uint64_t>(worst.count()));
+		CHECK(worst < BUDGET + 8 * UPDATE_COST + 2ms); // scheduling noise on a loaded machine
+		std::printf("UpdateSchedulerTest: 500 updates of %lld us over %zu ticks, worst OnTimer slice %lld us (budget %lld us)\n",
+			static_cast<long long>(UPDATE_COST.count()), ticks, static_cast<long long>(worst.count()), static_cast<long long>(BUDGET.count()));
+	}
+
+}
+
+int main() {
+	ordering();
+	burst();
+	std::puts("UpdateSchedulerTest: ok");
+	return 0;
+}
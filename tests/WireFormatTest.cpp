@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+#include "TestCertificate.h"
+#include "core/ApiClient.h"
+#include "core/WireFormat.h"
+
+using namespace rampAgent;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+	// An occupancy answer of a busy hub
+	nlohmann::ordered_json occupancy() {
+		nlohmann::ordered_json json;
+		json["assignedStands"] = nlohmann::ordered_json::array();
+		json["occupiedStands"] = nlohmann::ordered_json::array();
+		json["blockedStands"] = nlohmann::ordered_json::array();
+		for (int i = 0; i < 300; ++i) {
+			json["assignedStands"].push_back({ { "name", "A" + std::to_string(i) }, { "callsign", "AFR" + std::to_string(1000 + i) }, { "remark", i % 7 == 0 ? "Schengen" : "" } });
+			json["occupiedStands"].push_back({ { "name", "K" + std::to_string(i) }, { "callsign", "EZY" + std::to_string(2000 + i) } });
+			if (i % 10 == 0) json["blockedStands"].push_back({ { "name", "M" + std::to_string(i) } });
+		}
+		json["version"] = 3;
+		json["ratio"] = 0.75;
+		return json;
+	}
+
+	struct Encoding {
+		WireFormat format;
+		const char* contentType;
+	};
+
+	// The highest-q type of the Accept header the server speaks, JSON when none
+	Encoding negotiate(const std::string& accept, const std::vector<Encoding>& spoken) {
+		Encoding best{ WireFormat::Json, "application/json; charset=utf-8" };
+		double bestQ = -1.0;
+		std::size_t start = 0;
+		while (start < accept.size()) {
+			std::size_t end = accept.find(',', start);
+			if (end == std::string::npos) end = accept.size();
+			std::string item = accept.substr(start, end - start);
+			start = end + 1;
+			double q = 1.0;
+			const std::size_t parameter = item.find(";q=");
+			if (parameter != std::string::npos) q = std::stod(item.substr(parameter + 3));
+			item = item.substr(0, item.find(';'));
+			item.erase(0, item.find_first_not_of(' '));
+			for (const Encoding& encoding : spoken) {
+				if (item == encoding.contentType && q > bestQ) {
+					best = encoding;
+					bestQ = q;
+				}
+			}
+		}
+		return best;
+	}
+
+	// Serves the occupancy answer in the best encoding it speaks for the client's Accept header
+	class FormatServer {
+	public:
+		FormatServer(const TestCertificate& certificate, const nlohmann::ordered_json& payload) : server_(certificate.cert(), certificate.key()) {
+			server_.Get("/api/occupancy/", [this, &payload](const httplib::Request& request, httplib::Response& response) {
+				Encoding encoding;
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					encoding = negotiate(request.get_header_value("Accept"), spoken_);
+				}
+				switch (encoding.format) {
+				case WireFormat::Cbor: {
+					const std::vector<std::uint8_t> body = nlohmann::ordered_json::to_cbor(payload);
+					response.set_content(std::string(body.begin(), body.end()), encoding.contentType);
+					break;
+				}
+				case WireFormat::MessagePack: {
+					const std::vector<std::uint8_t> body = nlohmann::ordered_json::to_msgpack(payload);
+					response.set_content(std::string(body.begin(), body.end()), encoding.contentType);
+					break;
+				}
+				default:
+					response.set_content(payload.dump(), encoding.contentType);
+				}
+			});
+			port_ = server_.bind_to_any_port("127.0.0.1");
+			CHECK(port_ > 0);
+			thread_ = std::thread([this] { server_.listen_after_bind(); });
+			server_.wait_until_ready();
+		}
+
+		~FormatServer() {
+			server_.stop();
+			thread_.join();
+		}
+
+		void speak(std::vector<Encoding> spoken) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			spoken_ = std::move(spoken);
+		}
+		std::string host() const { return "127.0.0.1:" + std::to_string(port_); }
+
+	private:
+		httplib::SSLServer server_;
+		std::thread thread_;
+		int port_ = 0;
+		std::mutex mutex_;
+		std::vector<Encoding> spoken_;
+	};
+
+}
+
+int main() {
+	const TestCertificate certificate("RampAgentWireFormatTest");
+	const nlohmann::ordered_json payload = occupancy();
+	FormatServer server(certificate, payload);
+	HttplibClient client(certificate.caFile());
+
+	const Encoding cbor{ WireFormat::Cbor, "application/cbor" };
+	const Encoding msgpack{ WireFormat::MessagePack, "application/msgpack" };
+	const Encoding json{ WireFormat::Json, "application/json" };
+	struct Case {
+		const char* name;
+		std::vector<Encoding> spoken;
+		WireFormat expected;
+	};
+	// Each server answers in the best format both sides know; a JSON-only one is unchanged
+	const Case cases[] = {
+		{ "CBOR", { json, msgpack, cbor }, WireFormat::Cbor },
+		{ "MessagePack", { json, msgpack }, WireFormat::MessagePack },
+		{ "JSON", { json }, WireFormat::Json },
+		{ "JSON (no Accept match)", {}, WireFormat::Json },
+	};
+
+	for (const Case& c : cases) {
+		server.speak(c.spoken);
+		const ApiResponse response = client.get(server.host(), "/api/occupancy/?callsign=LFPG_APP");
+		CHECK(response.ok() && wireFormatOf(response.contentType) == c.expected);
+
+		constexpr int DECODES = 200;
+		nlohmann::ordered_json decoded;
+		const auto start = Clock::now();
+		for (int i = 0; i < DECODES; ++i) decoded = decodePayload(response.contentType, response.body);
+		const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / DECODES;
+		CHECK(decoded == payload && decoded.dump() == payload.dump()); // same values, same key order
+		std::printf("WireFormatTest: %-22s %6zu bytes, decoded in %7.1f us\n", c.name, response.body.size(), us);
+	}
+
+	// A malformed body throws like parse() does
+	bool threw = false;
+	try {
+		decodePayload("application/cbor", std::string("\xff\x00", 2));
+	}
+	catch (const nlohmann::json::exception&) {
+		threw = true;
+	}
+	CHECK(threw);
+
+	std::puts("WireFormatTest: ok");
+	return 0;
+}